@@ -278,105 +278,34 @@ void *_gltfFormatInfo (FbxWriter::EInfoRequest pRequest, int pId) {
 		return (("image/gif")) ;
 	if ( ext == "jpg" || ext == "jpeg" )
 		return (("image/jpeg")) ;
+	if ( ext == "glsl" )
+		return (("text/plain")) ;
 	return (("application/octet-stream")) ;
 }
 	
-/*
-base64.cpp and base64.h
-
-Copyright (C) 2004-2008 René Nyffenegger
-
-This source code is provided 'as-is', without any express or implied
-warranty. In no event will the author be held liable for any damages
-arising from the use of this software.
-
-Permission is granted to anyone to use this software for any purpose,
-including commercial applications, and to alter it and redistribute it
-freely, subject to the following restrictions:
-
-1. The origin of this source code must not be misrepresented; you must not
-claim that you wrote the original source code. If you use this source code
-in a product, an acknowledgment in the product documentation would be
-appreciated but is not required.
-
-2. Altered source versions must be plainly marked as such, and must not be
-misrepresented as being the original source code.
-
-3. This notice may not be removed or altered from any source distribution.
-
-René Nyffenegger rene.nyffenegger@adp-gmbh.ch
-
-*/
-	
-static const std::string base64_chars =
-	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-	"abcdefghijklmnopqrstuvwxyz"
-	"0123456789+/";
-	
-std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
-  std::string ret;
-  int i = 0;
-  int j = 0;
-  unsigned char char_array_3[3];
-  unsigned char char_array_4[4];
-		
-  while (in_len--) {
-	  char_array_3[i++] = *(bytes_to_encode++);
-	  if (i == 3) {
-		  char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-		  char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-		  char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-		  char_array_4[3] = char_array_3[2] & 0x3f;
-		  
-		  for(i = 0; (i <4) ; i++)
-			  ret += base64_chars[char_array_4[i]];
-		  i = 0;
-	  }
-  }
-		
-  if (i)
-  {
-	  for(j = i; j < 3; j++)
-		  char_array_3[j] = '\0';
-	  
-	  char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-	  char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-	  char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-	  char_array_4[3] = char_array_3[2] & 0x3f;
-	  
-	  for (j = 0; (j < i + 1); j++)
-		  ret += base64_chars[char_array_4[j]];
-	  
-	  while((i++ < 3))
-		  ret += '=';
-	  
-  }
-		
-  return ret;
-		
-}
-
 /*static*/ const std::string IOglTF::dataURI (const std::string fileName) {
 	// data:[<mime type>][;charset=<charset>][;base64],<encoded data>
-	std::string st (("data:")) ;
-	std::fstream fileStream( fileName );
-	
+	std::vector<uint8_t> v8 ;
 	try {
+		std::ifstream fileStream (fileName, std::ios::in | std::ios::binary) ;
 		fileStream.seekg (0, std::ios::end) ;
 		auto length =static_cast<size_t> (fileStream.tellg ()) ;
 		fileStream.seekg (0, std::ios_base::beg) ;
-
-		std::vector<uint8_t> v8 ;
 		v8.resize (length) ;
-		fileStream.get (reinterpret_cast<char*>(v8.data()), length) ;
-
-		st +=IOglTF::mimeType (fileName.c_str ()) ;
-		//st +="[;charset=<charset>]" ;
-		st +=(";base64") ;
-		st +=(",") +  base64_encode( v8.data(), static_cast<uint32_t>(length) ) ;
+		fileStream.read (reinterpret_cast<char*>(v8.data()), length) ;
 	} catch ( ... ) {
 		//std::cout << ("Error: ") << e.what () << std::endl ;
 	}
+	return (dataURI (fileName, v8)) ;
+}
+
+/*static*/ const std::string IOglTF::dataURI (const std::string fileName, const std::vector<uint8_t> &data) {
+	// data:[<mime type>][;charset=<charset>][;base64],<encoded data>
+	std::string st (("data:")) ;
+	st +=IOglTF::mimeType (fileName.c_str ()) ;
+	//st +="[;charset=<charset>]" ;
+	st +=(";base64") ;
+	st +=(",") + base64Encode (data.data (), data.size ()) ;
 	return (st) ;
 }
 
@@ -387,7 +316,7 @@ std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_
 	//st +="[;charset=<charset>]" ;
 	st +=(";base64") ;
 	auto &vec = stream.vec();
-	st +=(",") + base64_encode( vec.data(), static_cast<uint32_t>(vec.size()) ) ;
+	st +=(",") + base64Encode (vec.data (), vec.size ()) ;
 	return (st) ;
 }
 
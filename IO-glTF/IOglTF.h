@@ -144,6 +144,7 @@ public:
 	// Online uri generator: http://bran.name/dump/data-uri-generator/
 	static const std::string dataURI (const std::string fileName) ;
 	static const std::string dataURI (memoryStream<uint8_t> &stream) ;
+	static const std::string dataURI (const std::string fileName, const std::vector<uint8_t> &data) ;
 
 } ;
 
@@ -71,5 +71,16 @@ typedef std::match_results<std::string::const_iterator> umatch ;
 #include "string_t_utils.h"
 #include "memoryStream.h"
 #include "IOglTF.h"
+#include "gltfMemory.h"
+#include "gltfStats.h"
+#include "memoryMappedFile.h"
+#include "gltfAccessor.h"
 #include "gltfReader.h"
+#include "gltfTransformCache.h"
+#include "gltfBase64.h"
+#include "gltfTextureManager.h"
+#include "gltfMeshCache.h"
+#include "gltfTriangulator.h"
+#include "gltfNodeFilter.h"
+#include "gltfWeld.h"
 #include "gltfWriter.h"
@@ -31,3 +31,15 @@
 #define GLTF_COPYMEDIA						"copyMedia"
 #define IOSN_FBX_GLTF_COPYMEDIA				IOSN_FBX_GLTF_EXTENTIONS "|" GLTF_COPYMEDIA 
 #define IOSN_FBX_GLTF_EMBEDMEDIA			EXP_FBX_EMBEDDED
+#define GLTF_STATSFILE						"statsFile"
+#define IOSN_FBX_GLTF_STATSFILE			IOSN_FBX_GLTF_EXTENTIONS "|" GLTF_STATSFILE
+#define GLTF_TRACEFILE						"traceFile"
+#define IOSN_FBX_GLTF_TRACEFILE			IOSN_FBX_GLTF_EXTENTIONS "|" GLTF_TRACEFILE
+#define GLTF_MESHCACHE						"meshCache"
+#define IOSN_FBX_GLTF_MESHCACHE			IOSN_FBX_GLTF_EXTENTIONS "|" GLTF_MESHCACHE
+#define GLTF_NODEFILTER						"nodeFilter"
+#define IOSN_FBX_GLTF_NODEFILTER			IOSN_FBX_GLTF_EXTENTIONS "|" GLTF_NODEFILTER
+#define GLTF_ROOTCONVERSION					"rootConversion"
+#define IOSN_FBX_GLTF_ROOTCONVERSION		IOSN_FBX_GLTF_EXTENTIONS "|" GLTF_ROOTCONVERSION
+#define GLTF_WELD							"weld"
+#define IOSN_FBX_GLTF_WELD					IOSN_FBX_GLTF_EXTENTIONS "|" GLTF_WELD
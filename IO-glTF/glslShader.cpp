@@ -20,9 +20,50 @@
 //
 #include "StdAfx.h"
 #include "glslShader.h"
+#include <stdarg.h>
 
 namespace _IOglTF_NS_ {
 
+// vsnprintf into a std::string - grows to whatever size the format needs
+static std::string vformat (const char *format, va_list args) {
+	char buffer [256] ;
+	va_list copy ;
+	va_copy (copy, args) ;
+	int nb =vsnprintf (buffer, sizeof (buffer), format, copy) ;
+	va_end (copy) ;
+	if ( nb < 0 )
+		return (("")) ;
+	if ( (size_t)nb < sizeof (buffer) )
+		return (std::string (buffer, (size_t)nb)) ;
+	std::vector<char> st ((size_t)nb + 1) ;
+	vsnprintf (st.data (), st.size (), format, args) ;
+	return (std::string (st.data (), (size_t)nb)) ;
+}
+
+static bool equalsNoCase (char a, char b) {
+	return (::tolower ((unsigned char)a) == ::tolower ((unsigned char)b)) ;
+}
+
+// Case insensitive match of <prefix>[digits]<suffix>, i.e. the old "^prefix([0-9]+)suffix$" regular expressions
+// which were compiled again for every parameter of every material.
+static bool matchSemantic (const char *name, const char *prefix, bool bIndexed =false, const char *suffix ="") {
+	for ( ; *prefix ; prefix++, name++ ) {
+		if ( *name == 0 || !equalsNoCase (*name, *prefix) )
+			return (false) ;
+	}
+	if ( bIndexed ) {
+		if ( *name < '0' || *name > '9' )
+			return (false) ;
+		while ( *name >= '0' && *name <= '9' )
+			name++ ;
+	}
+	for ( ; *suffix ; suffix++, name++ ) {
+		if ( *name == 0 || !equalsNoCase (*name, *suffix) )
+			return (false) ;
+	}
+	return (*name == 0) ;
+}
+
 //std::string vs [8] ={
 //	("position"), ("normal"), ("joint"), ("jointMat"), ("weight"),
 //	("normalMatrix"), ("modelViewMatrix"), ("projectionMatrix")
@@ -81,15 +122,9 @@ bool glslShader::hasSymbol (const std::string &symbol) {
 }
 
 void glslShader::appendCode (const char *format, ...) {
-	char buffer [1000] ;
 	va_list args ;
 	va_start (args, format) ;
-#if defined(_WIN32) || defined(_WIN64)
-	vsprintf_s (buffer, format, args) ;
-#else
-	vsprintf (buffer, format, args) ;
-#endif
-	_body +=buffer ;
+	_body +=vformat (format, args) ;
 	va_end (args) ;
 }
 
@@ -106,7 +141,7 @@ std::string glslShader::body () {
 }
 
 //-----------------------------------------------------------------------------
-glslTech::glslTech (Json::Value technique, Json::Value values, Json::Value gltf, const char *glslVersion)
+glslTech::glslTech (const Json::Value &technique, const Json::Value &gltf, const char *glslVersion)
 	: _vertexShader (glslVersion), _fragmentShader (glslVersion),
 	_bHasNormals (false), _bHasJoint (false), _bHasWeight (false), _bHasSkin (false), _bHasTexTangent (false), _bHasTexBinormal (false),
 	_bModelContainsLights (false), _bLightingIsEnabled (false), _bHasAmbientLight (false), _bHasSpecularLight (false), _bHasNormalMap (false)
@@ -123,89 +158,49 @@ glslTech::~glslTech () {
 }
 
 /*static*/ std::string glslTech::format (const char *format, ...) {
-	char buffer [1000] ;
 	va_list args ;
 	va_start (args, format) ;
-#if defined(_WIN32) || defined(_WIN64)
-	_vstprintf_s (buffer, format, args) ;
-#else
-	vsprintf (buffer, format, args) ;
-#endif
+	std::string st =vformat (format, args) ;
 	va_end (args) ;
-	return (buffer) ;
+	return (st) ;
 }
 
 const std::string glslTech::needsVarying (const char *semantic) {
-	static std::string varyings [] ={
-		("^position$"), ("^normal$"),
-		("^texcoord([0-9]+)$")
-		//("^light([0-9]+)Transform$")
-	} ;
-
-	//static std::string varyingsMapping [] ={
-	//	("texcoord([0-9]+)"), ("texcoord%s"),
-	//	("light([0-9]+)Transform"), ("light%sDirection")
-	//} ;
-
-	int nb =sizeof (varyings) / sizeof (std::string) ;
-	//int nb2 =sizeof (varyingsMapping) / sizeof (std::string) / 2 ;
-	for ( int i =0 ; i < nb ; i++ ) {
-		uregex regex (varyings [i], std::regex_constants::ECMAScript | std::regex_constants::icase) ;
-		if ( std::regex_search (semantic, regex) ) {
-			/*for ( int j =0 ; j < nb2 ; j++ ) {
-				if ( varyings [i] == varyingsMapping [j * 2] ) {
-					uregex regex2 (varyings [i]) ;
-					std::string st (semantic) ;
-
-					//umatch matches ;
-					//if ( std::regex_match (st.cbegin (), st.cend (), matches, regex2) )
-					//	std::cout << L"The matching text is:" << matches.str () << std::endl ;
-
-					umatch mr ;
-					//bool results =std::regex_search (st.cbegin (), st.cend (), regex2, std::regex_constants::match_default) ;
-					bool results =std::regex_search (st, mr, regex2) ;
-					//for ( size_t k =0 ; k < mr.size () ; ++k )
-					//	std::cout << k << (" ") << mr [k].str () << std::endl ;
-					std::string st2 =format (varyingsMapping [j * 2 + 1].c_str (), mr [1].str ().c_str ()) ;
-					return (st2) ;
-				}
-			}*/
-			return (varyings [i]) ;
-		}
-	}
+	if ( matchSemantic (semantic, "position") )
+		return (("position")) ;
+	if ( matchSemantic (semantic, "normal") )
+		return (("normal")) ;
+	if ( matchSemantic (semantic, "texcoord", true) )
+		return (("texcoord")) ;
+	//if ( matchSemantic (semantic, "light", true, "Transform") )
+	//	return (("lightTransform")) ;
 	return (("")) ;
 }
 
 /*static*/ bool glslTech::isVertexShaderSemantic (const char *semantic) {
-	static std::string vs_semantics [] ={
-		("^position$"), ("^normal$"), ("^normalMatrix$"), ("^modelViewMatrix$"), ("^projectionMatrix$"),
-		("^texcoord([0-9]+)$"), ("^light([0-9]+)Transform$")
+	static const char *vs_semantics [] ={
+		("position"), ("normal"), ("normalMatrix"), ("modelViewMatrix"), ("projectionMatrix")
 	} ;
-	int nb =sizeof (vs_semantics) / sizeof (std::string) ;
-	for ( int i =0 ; i < nb ; i++ ) {
-		uregex regex (vs_semantics [i], std::regex_constants::ECMAScript | std::regex_constants::icase) ;
-		if ( std::regex_search (semantic, regex) ) 
+	for ( size_t i =0 ; i < sizeof (vs_semantics) / sizeof (const char *) ; i++ ) {
+		if ( matchSemantic (semantic, vs_semantics [i]) )
 			return (true) ;
 	}
-	return (false) ;
+	return (matchSemantic (semantic, "texcoord", true) || matchSemantic (semantic, "light", true, "Transform")) ;
 }
 
 /*static*/ bool glslTech::isFragmentShaderSemantic (const char *semantic) {
-	static std::string fs_semantics [] ={
-		("^ambient$"), ("^diffuse$"), ("^emission$"),  ("^specular$"),  ("^shininess$"),
-		("^reflective$"), ("^reflectivity$"), ("^transparent$"), ("^transparency$"),
-		("^light([0-9]+)Color$")
+	static const char *fs_semantics [] ={
+		("ambient"), ("diffuse"), ("emission"),  ("specular"),  ("shininess"),
+		("reflective"), ("reflectivity"), ("transparent"), ("transparency")
 	} ;
-	int nb =sizeof (fs_semantics) / sizeof (std::string) ;
-	for ( int i =0 ; i < nb ; i++ ) {
-		uregex regex (fs_semantics [i], std::regex_constants::ECMAScript | std::regex_constants::icase) ;
-		if ( std::regex_search (semantic, regex) ) 
+	for ( size_t i =0 ; i < sizeof (fs_semantics) / sizeof (const char *) ; i++ ) {
+		if ( matchSemantic (semantic, fs_semantics [i]) )
 			return (true) ;
 	}
-	return (false) ;
+	return (matchSemantic (semantic, "light", true, "Color")) ;
 }
 
-void glslTech::prepareParameters (Json::Value technique) {
+void glslTech::prepareParameters (const Json::Value &technique) {
 	// Parameters / attribute - uniforms - varying
 	auto &parameters =technique [("parameters")] ;
 	auto memberNames = parameters.getMemberNames();
@@ -260,7 +255,7 @@ void glslTech::hwSkinning () {
 	}
 }
 
-bool glslTech::lighting1 (Json::Value technique, Json::Value gltf) {
+bool glslTech::lighting1 (const Json::Value &technique, const Json::Value &gltf) {
 	// Lighting
 	auto &lights =gltf [("lights")] ;
 	auto memberNames = lights.getMemberNames();
@@ -285,7 +280,7 @@ bool glslTech::lighting1 (Json::Value technique, Json::Value gltf) {
 	_fragmentShader.appendCode (("vec4 diffuse =vec4(0., 0., 0., 1.) ;\n")) ;
 	if ( _bModelContainsLights )
 		_fragmentShader.appendCode (("vec3 diffuseLight =vec3(0., 0., 0.) ;\n")) ;
-	Json::Value parameters =technique [("parameters")] ;
+	const Json::Value &parameters =technique [("parameters")] ;
 	if ( parameters.isMember (("emission")) )
 		_fragmentShader.appendCode (("vec4 emission ;\n")) ;
 	if ( parameters.isMember (("reflective")) )
@@ -297,8 +292,8 @@ bool glslTech::lighting1 (Json::Value technique, Json::Value gltf) {
 	return (_bLightingIsEnabled) ;
 }
 
-void glslTech::texcoords (Json::Value technique) {
-	Json::Value parameters =technique [("parameters")] ;
+void glslTech::texcoords (const Json::Value &technique) {
+	const Json::Value &parameters =technique [("parameters")] ;
 	std::string texcoordAttributeSymbol =("a_texcoord") ;
 	std::string texcoordVaryingSymbol =("v_texcoord") ;
 	std::map<std::string, std::string> declaredTexcoordAttributes ;
@@ -365,7 +360,7 @@ void glslTech::texcoords (Json::Value technique) {
 			}
 
 			std::string textureSymbol =("u_") + slot ;
-			Json::Value textureParameter =parameters [slot] ; // get the texture
+			const Json::Value &textureParameter =parameters [slot] ; // get the texture
 			//_vertexShader.addUniform (texVSymbol, textureParameter [("type")].asInt ()) ;
 			//_fragmentShader.addUniform (texVSymbol, textureParameter [("type")].asInt ()) ;
 			if ( _bHasNormalMap == false && slot == ("bump") )
@@ -381,7 +376,7 @@ void glslTech::texcoords (Json::Value technique) {
 	}
 }
 
-Json::Value glslTech::lightNodes (Json::Value gltf) {
+Json::Value glslTech::lightNodes (const Json::Value &gltf) {
 	Json::Value ret( Json::arrayValue ) ;
 	auto &nodes = gltf["nodes"];
 	auto memberNames = nodes.getMemberNames();
@@ -392,8 +387,8 @@ Json::Value glslTech::lightNodes (Json::Value gltf) {
 	return (ret) ;
 }
 
-void glslTech::lighting2 (Json::Value technique, Json::Value gltf) {
-	Json::Value parameters =technique [("parameters")] ;
+void glslTech::lighting2 (const Json::Value &technique, const Json::Value &gltf) {
+	const Json::Value &parameters =technique [("parameters")] ;
 
 	std::string lightingModel =technique [("extras")] [("lightingModel")].asString () ;
 	bool bHasSpecular =
@@ -540,8 +535,8 @@ void glslTech::lighting2 (Json::Value technique, Json::Value gltf) {
 	}
 }
 
-void glslTech::finalizingShaders (Json::Value technique, Json::Value gltf) {
-	Json::Value parameters =technique [("parameters")] ;
+void glslTech::finalizingShaders (const Json::Value &technique, const Json::Value &gltf) {
+	const Json::Value &parameters =technique [("parameters")] ;
 
 	if ( parameters.isMember (("reflective")) )
 		_fragmentShader.appendCode (("diffuse.xyz +=reflective.xyz ;\n")) ;
@@ -572,6 +567,102 @@ void glslTech::finalizingShaders (Json::Value technique, Json::Value gltf) {
 	_vertexShader.appendCode (("gl_Position =u_projectionMatrix * pos ;\n")) ;
 }
 
+//-----------------------------------------------------------------------------
+// The generated sources only depend on a small feature set, so materials sharing that set share
+// the shaders: bits for the vertex semantics, material slots, lighting model and sidedness, plus
+// the declaration list, the texcoord bindings of sampled slots and the scene lights.
+/*static*/ uint32_t glslTech::features (const Json::Value &technique) {
+	static const char *slots [] ={ ("ambient"), ("diffuse"), ("emission"), ("reflective"), ("specular"), ("bump") } ;
+	const Json::Value &parameters =technique [("parameters")] ;
+	uint32_t mask =0 ;
+	auto memberNames =parameters.getMemberNames () ;
+	for ( auto &name : memberNames ) {
+		if ( !parameters [name].isMember (("semantic")) )
+			continue ;
+		std::string semantic =parameters [name] [("semantic")].asString () ;
+		mask |=semantic == ("NORMAL") ? eNormals : 0 ;
+		mask |=semantic == ("JOINT") ? eJoint : 0 ;
+		mask |=semantic == ("WEIGHT") ? eWeight : 0 ;
+		mask |=semantic == ("TEXTANGENT") ? eTexTangent : 0 ;
+		mask |=semantic == ("TEXBINORMAL") ? eTexBinormal : 0 ;
+	}
+	mask |=technique [("extras")] [("doubleSided")].asBool () ? eDoubleSided : 0 ;
+	std::string lightingModel =technique [("extras")] [("lightingModel")].asString () ;
+	if ( lightingModel == ("Phong") )
+		mask |=ePhong ;
+	else if ( lightingModel == ("Blinn") )
+		mask |=eBlinn ;
+	for ( size_t i =0 ; i < sizeof (slots) / sizeof (const char *) ; i++ ) {
+		uint32_t kind =eSlotNone ;
+		if ( parameters.isMember (slots [i]) ) {
+			unsigned int slotType =parameters [slots [i]] [("type")].asUInt () ;
+			kind =slotType == IOglTF::FLOAT_VEC4 ? eSlotColor : (slotType == IOglTF::SAMPLER_2D ? eSlotTexture : eSlotOther) ;
+		}
+		mask |=kind << (eSlotShift + 2 * i) ;
+	}
+	return (mask) ;
+}
+
+/*static*/ std::string glslTech::lightsKey (const Json::Value &gltf) {
+	// Light types in declaration order, times the number of nodes holding a light
+	std::string key ;
+	const Json::Value &lights =gltf [("lights")] ;
+	auto memberNames =lights.getMemberNames () ;
+	for ( auto &name : memberNames )
+		key +=lights [name] [("type")].asString () + (",") ;
+	key +=("x") + utility::conversions::to_string_t ((int)lightNodes (gltf).size ()) ;
+	return (key) ;
+}
+
+/*static*/ std::string glslTech::featureKey (const Json::Value &technique, const std::string &lightsKey, const char *glslVersion /*=nullptr*/) {
+	uint32_t mask =features (technique) ;
+	std::string key =format (("%08x|"), mask) ;
+	if ( glslVersion )
+		key +=glslVersion ;
+	key +=("|") + lightsKey + ("|") ;
+	// Declarations: parameter names, types and attribute/uniform qualifiers
+	const Json::Value &parameters =technique [("parameters")] ;
+	auto memberNames =parameters.getMemberNames () ;
+	for ( auto &name : memberNames ) {
+		if ( !isVertexShaderSemantic (name.c_str ()) && !isFragmentShaderSemantic (name.c_str ()) )
+			continue ;
+		key +=name + (":") + utility::conversions::to_string_t (parameters [name] [("type")].asInt ()) ;
+		key +=technique [("attributes")].isMember (("a_") + name) ? ("a,") : ("u,") ;
+	}
+	// Texcoord sets used by the sampled slots
+	const Json::Value &bindings =technique [("extras")] [("texcoordBindings")] ;
+	for ( uint32_t i =0 ; i < 6 ; i++ ) {
+		if ( ((mask >> (eSlotShift + 2 * i)) & 3) == eSlotTexture ) {
+			static const char *slots [] ={ ("ambient"), ("diffuse"), ("emission"), ("reflective"), ("specular"), ("bump") } ;
+			key +=("|") + bindings [slots [i]].asString () ;
+		}
+	}
+	return (key) ;
+}
+
+//-----------------------------------------------------------------------------
+std::shared_ptr<const glslTech::sources> glslTechLibrary::get (const Json::Value &technique, const Json::Value &gltf, const std::string &lightsKey, const char *glslVersion /*=nullptr*/) {
+	std::string key =glslTech::featureKey (technique, lightsKey, glslVersion) ;
+	auto iter =_sources.find (key) ;
+	if ( iter != _sources.end () ) {
+#ifdef _DEBUG
+		// Debug builds check the key is complete, i.e. a hit gives the sources the technique generates
+		glslTech tech (technique, gltf, glslVersion) ;
+		if ( tech.vertexShader ().source () != iter->second->_vertexShader || tech.fragmentShader ().source () != iter->second->_fragmentShader )
+			std::cout << "Warning: techniques with different shaders share the feature key " << key << std::endl ;
+#endif
+		return (_hits++, iter->second) ;
+	}
+	_misses++ ;
+	glslTech tech (technique, gltf, glslVersion) ;
+	std::shared_ptr<glslTech::sources> ret (new glslTech::sources) ;
+	ret->_key =key ;
+	ret->_vertexShader =tech.vertexShader ().source () ;
+	ret->_fragmentShader =tech.fragmentShader ().source () ;
+	_sources [key] =ret ;
+	return (ret) ;
+}
+
 // NVidia hardware indices are reserved for built-in attributes:
 // gl_Vertex			0
 // gl_Normal			2
@@ -20,6 +20,8 @@
 //
 #pragma once
 
+#include <unordered_map>
+
 // http://stackoverflow.com/questions/13624124/online-webgl-glsl-shader-editor
 // http://glslsandbox.com/
 
@@ -74,24 +76,71 @@ protected:
 	glslShader _fragmentShader ;
 
 public:
-	glslTech (Json::Value technique, Json::Value values, Json::Value gltf, const char *glslVersion =nullptr) ;
+	enum EFeatures {
+		eNormals =0x0001,
+		eJoint =0x0002,
+		eWeight =0x0004,
+		eTexTangent =0x0008,
+		eTexBinormal =0x0010,
+		eDoubleSided =0x0020,
+		ePhong =0x0040,
+		eBlinn =0x0080,
+		eSlotShift =8, // 2 bits per slot: ambient, diffuse, emission, reflective, specular, bump
+		eSlotNone =0,
+		eSlotColor =1,
+		eSlotTexture =2,
+		eSlotOther =3
+	} ;
+	struct sources {
+		std::string _key ;
+		std::string _vertexShader ;
+		std::string _fragmentShader ;
+	} ;
+
+public:
+	glslTech (const Json::Value &technique, const Json::Value &gltf, const char *glslVersion =nullptr) ;
 	virtual ~glslTech () ;
 
 	glslShader &vertexShader () { return (_vertexShader) ; }
 	glslShader &fragmentShader () { return (_fragmentShader) ; }
 
+	static uint32_t features (const Json::Value &technique) ;
+	// Computed once per document, see glslTechLibrary
+	static std::string lightsKey (const Json::Value &gltf) ;
+	static std::string featureKey (const Json::Value &technique, const std::string &lightsKey, const char *glslVersion =nullptr) ;
+
 protected:
 	static std::string format (const char *format, ...) ;
 	const std::string needsVarying (const char *semantic) ;
 	static bool isVertexShaderSemantic (const char *semantic) ;
 	static bool isFragmentShaderSemantic (const char *semantic) ;
-	void prepareParameters (Json::Value technique) ;
+	void prepareParameters (const Json::Value &technique) ;
 	void hwSkinning () ;
-	bool lighting1 (Json::Value technique, Json::Value gltf) ;
-	void texcoords (Json::Value technique) ;
-	Json::Value lightNodes (Json::Value gltf) ;
-	void lighting2 (Json::Value technique, Json::Value gltf) ;
-	void finalizingShaders (Json::Value technique, Json::Value gltf) ;
+	bool lighting1 (const Json::Value &technique, const Json::Value &gltf) ;
+	void texcoords (const Json::Value &technique) ;
+	static Json::Value lightNodes (const Json::Value &gltf) ;
+	void lighting2 (const Json::Value &technique, const Json::Value &gltf) ;
+	void finalizingShaders (const Json::Value &technique, const Json::Value &gltf) ;
+
+} ;
+
+// Class       : glslTechLibrary
+// Abstraction : Shader sources memoized per glslTech::featureKey (), shared by all the materials with the
+//               same key. Each writer owns one and clears it for every document, so it never holds more
+//               than the feature sets of the document being exported.
+class glslTechLibrary {
+	std::unordered_map<std::string, std::shared_ptr<const glslTech::sources> > _sources ;
+	size_t _hits, _misses ;
+
+public:
+	glslTechLibrary () : _hits (0), _misses (0) {}
+
+	void clear () { _sources.clear () ; _hits =_misses =0 ; }
+	size_t size () const { return (_sources.size ()) ; }
+	size_t hits () const { return (_hits) ; }
+	size_t misses () const { return (_misses) ; }
+
+	std::shared_ptr<const glslTech::sources> get (const Json::Value &technique, const Json::Value &gltf, const std::string &lightsKey, const char *glslVersion =nullptr) ;
 
 } ;
 
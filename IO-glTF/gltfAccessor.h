@@ -0,0 +1,124 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <string.h> // for memcpy
+#include <string>
+#include <algorithm>
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfAccessor
+// Abstraction : Typed view on the elements of an accessor. It points straight into the buffer memory
+//               (memory mapped file, GLB body or decoded data URI) and converts one element at a time,
+//               normalized integers being dequantized as per the glTF specification.
+//               glTF buffers are little endian, like every platform the plug-in runs on.
+class gltfAccessor {
+	const uint8_t *_data ;
+	size_t _count ;
+	size_t _stride ;
+	unsigned int _componentType ;
+	int _components ;
+	bool _bNormalized ;
+
+public:
+	gltfAccessor () : _data (nullptr), _count (0), _stride (0), _componentType (0), _components (0), _bNormalized (false) {}
+	gltfAccessor (const uint8_t *data, size_t count, size_t stride, unsigned int componentType, int components, bool bNormalized)
+		: _data (data), _count (count), _stride (stride), _componentType (componentType), _components (components), _bNormalized (bNormalized) {}
+
+	bool isValid () const { return (_components != 0) ; }
+	size_t count () const { return (_count) ; }
+	int components () const { return (_components) ; }
+	unsigned int componentType () const { return (_componentType) ; }
+	bool normalized () const { return (_bNormalized) ; }
+
+	// Component c of element i
+	double get (size_t i, int c) const {
+		double v ;
+		convert (_data + i * _stride + c * componentSize (_componentType), &v, 1) ;
+		return (v) ;
+	}
+	// All components of element i, out must have room for components () values
+	void get (size_t i, double *out) const {
+		convert (_data + i * _stride, out, _components) ;
+	}
+	// Indices are never normalized
+	unsigned int index (size_t i) const {
+		const uint8_t *p =_data + i * _stride ;
+		switch ( _componentType ) {
+			case IOglTF::UNSIGNED_BYTE: return (*p) ;
+			case IOglTF::UNSIGNED_SHORT: return (load<uint16_t> (p)) ;
+			case IOglTF::UNSIGNED_INT: return (load<uint32_t> (p)) ;
+			default: return ((unsigned int)get (i, 0)) ;
+		}
+	}
+
+	static size_t componentSize (unsigned int componentType) {
+		switch ( componentType ) {
+			case IOglTF::BYTE: case IOglTF::UNSIGNED_BYTE: return (1) ;
+			case IOglTF::SHORT: case IOglTF::UNSIGNED_SHORT: return (2) ;
+			case IOglTF::INT: case IOglTF::UNSIGNED_INT: case IOglTF::FLOAT: return (4) ;
+			default: return (0) ;
+		}
+	}
+	static int componentCount (const std::string &type) {
+		if ( type == IOglTF::szSCALAR ) return (1) ;
+		if ( type == IOglTF::szVEC2 ) return (2) ;
+		if ( type == IOglTF::szVEC3 ) return (3) ;
+		if ( type == IOglTF::szVEC4 || type == IOglTF::szMAT2 ) return (4) ;
+		if ( type == IOglTF::szMAT3 ) return (9) ;
+		if ( type == IOglTF::szMAT4 ) return (16) ;
+		return (0) ;
+	}
+
+protected:
+	// Buffer views do not guarantee any alignment when they are interleaved, hence the memcpy
+	template<class T>
+	static T load (const uint8_t *p) {
+		T v ;
+		memcpy (&v, p, sizeof (T)) ;
+		return (v) ;
+	}
+
+	template<class T>
+	static void convert (const uint8_t *p, double *out, int nb, double scale) {
+		for ( int c =0 ; c < nb ; c++ ) {
+			double v =(double)load<T> (p + c * sizeof (T)) ;
+			out [c] =scale != 0. ? std::max (v * scale, -1.0) : v ;
+		}
+	}
+
+	void convert (const uint8_t *p, double *out, int nb) const {
+		switch ( _componentType ) {
+			case IOglTF::FLOAT: convert<float> (p, out, nb, 0.) ; break ;
+			case IOglTF::BYTE: convert<int8_t> (p, out, nb, _bNormalized ? 1.0 / 127.0 : 0.) ; break ;
+			case IOglTF::UNSIGNED_BYTE: convert<uint8_t> (p, out, nb, _bNormalized ? 1.0 / 255.0 : 0.) ; break ;
+			case IOglTF::SHORT: convert<int16_t> (p, out, nb, _bNormalized ? 1.0 / 32767.0 : 0.) ; break ;
+			case IOglTF::UNSIGNED_SHORT: convert<uint16_t> (p, out, nb, _bNormalized ? 1.0 / 65535.0 : 0.) ; break ;
+			case IOglTF::INT: convert<int32_t> (p, out, nb, 0.) ; break ;
+			case IOglTF::UNSIGNED_INT: convert<uint32_t> (p, out, nb, 0.) ; break ;
+			default: std::fill (out, out + nb, 0.) ; break ;
+		}
+	}
+
+} ;
+
+}
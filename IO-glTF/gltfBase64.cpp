@@ -0,0 +1,301 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfBase64.h"
+#include <string.h> // for memcpy
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GLTF_BASE64_SSSE3
+#include <tmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace _IOglTF_NS_ {
+
+static const char sBase64Chars [] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	"abcdefghijklmnopqrstuvwxyz"
+	"0123456789+/" ;
+
+//-----------------------------------------------------------------------------
+static size_t base64EncodeScalar (const uint8_t *src, size_t len, char *dst) {
+	char *p =dst ;
+	size_t i =0 ;
+	for ( ; i + 3 <= len ; i +=3 ) {
+		uint32_t v =(uint32_t (src [i]) << 16) | (uint32_t (src [i + 1]) << 8) | uint32_t (src [i + 2]) ;
+		p [0] =sBase64Chars [(v >> 18) & 0x3f] ;
+		p [1] =sBase64Chars [(v >> 12) & 0x3f] ;
+		p [2] =sBase64Chars [(v >> 6) & 0x3f] ;
+		p [3] =sBase64Chars [v & 0x3f] ;
+		p +=4 ;
+	}
+	if ( i < len ) {
+		uint32_t v =uint32_t (src [i]) << 16 ;
+		if ( i + 1 < len )
+			v |=uint32_t (src [i + 1]) << 8 ;
+		p [0] =sBase64Chars [(v >> 18) & 0x3f] ;
+		p [1] =sBase64Chars [(v >> 12) & 0x3f] ;
+		p [2] =i + 1 < len ? sBase64Chars [(v >> 6) & 0x3f] : '=' ;
+		p [3] ='=' ;
+		p +=4 ;
+	}
+	return (p - dst) ;
+}
+
+#ifdef GLTF_BASE64_SSSE3
+// 12 input bytes -> 16 characters per round (W. Mula and D. Lemire, "Faster Base64 Encoding and
+// Decoding using AVX2 Instructions", the SSE variant). Reads 16 bytes, so the last round(s) are
+// left to the scalar code.
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("ssse3")))
+#endif
+static size_t base64EncodeSSSE3 (const uint8_t *src, size_t len, char *dst) {
+	const __m128i shuffle =_mm_set_epi8 (10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1) ;
+	const __m128i shiftLUT =_mm_setr_epi8 (
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+		'/' - 63, 'A', 0, 0
+	) ;
+	size_t i =0 ;
+	char *p =dst ;
+	for ( ; i + 16 <= len ; i +=12, p +=16 ) {
+		__m128i in =_mm_loadu_si128 (reinterpret_cast<const __m128i *> (src + i)) ;
+		in =_mm_shuffle_epi8 (in, shuffle) ;
+		// Split the 4 x 24 bits into 16 x 6 bits indices
+		const __m128i t0 =_mm_and_si128 (in, _mm_set1_epi32 (0x0fc0fc00)) ;
+		const __m128i t1 =_mm_mulhi_epu16 (t0, _mm_set1_epi32 (0x04000040)) ;
+		const __m128i t2 =_mm_and_si128 (in, _mm_set1_epi32 (0x003f03f0)) ;
+		const __m128i t3 =_mm_mullo_epi16 (t2, _mm_set1_epi32 (0x01000010)) ;
+		const __m128i indices =_mm_or_si128 (t1, t3) ;
+		// Map every index to its ASCII code by adding a per-range offset
+		__m128i offsets =_mm_subs_epu8 (indices, _mm_set1_epi8 (51)) ;
+		const __m128i less =_mm_cmpgt_epi8 (_mm_set1_epi8 (26), indices) ;
+		offsets =_mm_or_si128 (offsets, _mm_and_si128 (less, _mm_set1_epi8 (13))) ;
+		offsets =_mm_shuffle_epi8 (shiftLUT, offsets) ;
+		_mm_storeu_si128 (reinterpret_cast<__m128i *> (p), _mm_add_epi8 (offsets, indices)) ;
+	}
+	return ((p - dst) + base64EncodeScalar (src + i, len - i, p)) ;
+}
+
+static bool hasSSSE3 () {
+#if defined(_MSC_VER)
+	int info [4] ;
+	__cpuid (info, 1) ;
+	return ((info [2] & (1 << 9)) != 0) ;
+#else
+	return (__builtin_cpu_supports ("ssse3") != 0) ;
+#endif
+}
+#endif
+
+size_t base64EncodedSize (size_t len) {
+	return (((len + 2) / 3) * 4) ;
+}
+
+size_t base64Encode (const uint8_t *src, size_t len, char *dst) {
+#ifdef GLTF_BASE64_SSSE3
+	static const bool bSSSE3 =hasSSSE3 () ;
+	if ( bSSSE3 )
+		return (base64EncodeSSSE3 (src, len, dst)) ;
+#endif
+	return (base64EncodeScalar (src, len, dst)) ;
+}
+
+std::string base64Encode (const uint8_t *src, size_t len) {
+	std::string st (base64EncodedSize (len), '\0') ;
+	if ( len )
+		base64Encode (src, len, &st [0]) ;
+	return (st) ;
+}
+
+//-----------------------------------------------------------------------------
+static int base64Value (char c) {
+	if ( c >= 'A' && c <= 'Z' ) return (c - 'A') ;
+	if ( c >= 'a' && c <= 'z' ) return (c - 'a' + 26) ;
+	if ( c >= '0' && c <= '9' ) return (c - '0' + 52) ;
+	if ( c == '+' || c == '-' ) return (62) ;
+	if ( c == '/' || c == '_' ) return (63) ;
+	return (-1) ;
+}
+
+bool base64Decode (const char *src, size_t len, std::vector<uint8_t> &out) {
+	out.clear () ;
+	out.reserve ((len / 4) * 3) ;
+	uint32_t v =0 ;
+	int nb =0 ;
+	for ( size_t i =0 ; i < len ; i++ ) {
+		char c =src [i] ;
+		if ( c == '=' )
+			break ;
+		if ( c == ' ' || c == '\n' || c == '\r' || c == '\t' )
+			continue ;
+		int d =base64Value (c) ;
+		if ( d < 0 )
+			return (false) ;
+		v =(v << 6) | (uint32_t)d ;
+		if ( ++nb == 4 ) {
+			out.push_back ((uint8_t)(v >> 16)) ;
+			out.push_back ((uint8_t)(v >> 8)) ;
+			out.push_back ((uint8_t)v) ;
+			v =0 ;
+			nb =0 ;
+		}
+	}
+	if ( nb == 1 )
+		return (false) ;
+	if ( nb >= 2 )
+		out.push_back ((uint8_t)(v >> (nb == 2 ? 4 : 10))) ;
+	if ( nb == 3 )
+		out.push_back ((uint8_t)(v >> 2)) ;
+	return (true) ;
+}
+
+//-----------------------------------------------------------------------------
+// 48Kb of input, 64Kb of output per chunk
+static const size_t sChunkSize =48 * 1024 ;
+
+base64Writer::base64Writer (std::ostream &out) : _out (out), _buffer (base64EncodedSize (sChunkSize)), _nbTail (0) {
+}
+
+void base64Writer::write (const uint8_t *p, size_t len) {
+	if ( _nbTail ) {
+		while ( _nbTail < 3 && len ) {
+			_tail [_nbTail++] =*p++ ;
+			len-- ;
+		}
+		if ( _nbTail < 3 )
+			return ;
+		_out.write (_buffer.data (), base64Encode (_tail, 3, _buffer.data ())) ;
+		_nbTail =0 ;
+	}
+	while ( len >= 3 ) {
+		size_t nb =std::min (len - len % 3, sChunkSize) ;
+		_out.write (_buffer.data (), base64Encode (p, nb, _buffer.data ())) ;
+		p +=nb ;
+		len -=nb ;
+	}
+	memcpy (_tail, p, len) ;
+	_nbTail =len ;
+}
+
+void base64Writer::close () {
+	if ( _nbTail )
+		_out.write (_buffer.data (), base64Encode (_tail, _nbTail, _buffer.data ())) ;
+	_nbTail =0 ;
+}
+
+//-----------------------------------------------------------------------------
+gltfDataURIs::gltfDataURIs () {
+	std::random_device device ;
+	uint64_t key =((uint64_t)device () << 32) ^ device () ^ (uint64_t)std::chrono::steady_clock::now ().time_since_epoch ().count () ;
+	char buffer [32] ;
+	snprintf (buffer, sizeof (buffer), "%016llx", (unsigned long long)key) ;
+	_prefix =std::string ("gltf-deferred-uri-") + buffer + ":" ;
+}
+
+std::string gltfDataURIs::defer (const std::string &mimeType, const std::vector<uint8_t> &data) {
+	source src ;
+	src._mimeType =mimeType ;
+	src._pData =&data ;
+	_sources.push_back (src) ;
+	return (_prefix + utility::conversions::to_string_t ((int)_sources.size () - 1)) ;
+}
+
+std::string gltfDataURIs::defer (const std::string &fileName, const std::string &uri) {
+	source src ;
+	src._mimeType =IOglTF::mimeType (fileName.c_str ()) ;
+	src._pData =nullptr ;
+	src._fileName =fileName ;
+	src._uri =uri ;
+	_sources.push_back (src) ;
+	return (_prefix + utility::conversions::to_string_t ((int)_sources.size () - 1)) ;
+}
+
+bool gltfDataURIs::write (std::ostream &out, const std::string &json) {
+	if ( _sources.empty () ) {
+		out.write (json.c_str (), json.length ()) ;
+		return (out.good ()) ;
+	}
+	// Placeholders are always a complete json string: "gltf-deferred-uri-<key>:<index>", each one is
+	// only in the document once
+	const std::string marker =std::string ("\"") + _prefix ;
+	std::vector<bool> written (_sources.size (), false) ;
+	bool bOk =true ;
+	size_t pos =0 ;
+	for ( ;; ) {
+		size_t next =json.find (marker, pos) ;
+		if ( next == std::string::npos )
+			break ;
+		size_t start =next + marker.length (), end =start ;
+		while ( end < json.length () && json [end] >= '0' && json [end] <= '9' )
+			end++ ;
+		size_t index =end > start ? (size_t)atol (json.substr (start, end - start).c_str ()) : _sources.size () ;
+		if ( index >= _sources.size () || written [index] || end >= json.length () || json [end] != '"' ) {
+			// Not one of ours, leave it as is
+			out.write (json.c_str () + pos, start - pos) ;
+			pos =start ;
+			continue ;
+		}
+		written [index] =true ;
+		out.write (json.c_str () + pos, next + 1 - pos) ;
+		bOk =writeSource (out, _sources [index]) && bOk ;
+		pos =end ;
+	}
+	out.write (json.c_str () + pos, json.length () - pos) ;
+	return (bOk && out.good ()) ;
+}
+
+bool gltfDataURIs::writeSource (std::ostream &out, const source &src) {
+	// data:[<mime type>][;charset=<charset>][;base64],<encoded data>
+	if ( src._pData ) {
+		out << "data:" << src._mimeType << ";base64," ;
+		base64Writer encoder (out) ;
+		if ( !src._pData->empty () )
+			encoder.write (src._pData->data (), src._pData->size ()) ;
+		encoder.close () ;
+		return (true) ;
+	}
+	std::ifstream file (src._fileName, std::ios::in | std::ios::binary) ;
+	if ( !file.is_open () ) {
+		std::cout << ("Warning: cannot embed image file ") << src._fileName << (", keeping its uri") << std::endl ;
+		std::string quoted =Json::valueToQuotedString (src._uri.c_str ()) ;
+		out.write (quoted.c_str () + 1, quoted.length () - 2) ;
+		return (false) ;
+	}
+	out << "data:" << src._mimeType << ";base64," ;
+	base64Writer encoder (out) ;
+	std::vector<char> buffer (sChunkSize) ;
+	while ( file ) {
+		file.read (buffer.data (), buffer.size ()) ;
+		if ( file.gcount () > 0 )
+			encoder.write (reinterpret_cast<const uint8_t *> (buffer.data ()), (size_t)file.gcount ()) ;
+	}
+	encoder.close () ;
+	return (true) ;
+}
+
+}
@@ -0,0 +1,90 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace _IOglTF_NS_ {
+
+// Base64 encoding (RFC 4648, with padding). The SSSE3 path is selected at runtime on x86 CPUs which
+// support it, the scalar path is used otherwise.
+size_t base64EncodedSize (size_t len) ;
+// Writes base64EncodedSize (len) characters to dst, and returns that count
+size_t base64Encode (const uint8_t *src, size_t len, char *dst) ;
+std::string base64Encode (const uint8_t *src, size_t len) ;
+// Also accepts the URL safe alphabet and skips whitespaces, returns false on malformed input
+bool base64Decode (const char *src, size_t len, std::vector<uint8_t> &out) ;
+
+// Class       : base64Writer
+// Abstraction : Encodes a byte stream of unknown length into an std::ostream in fixed size chunks,
+//               carrying the last 1 or 2 bytes of every write () over to the next one.
+class base64Writer {
+	std::ostream &_out ;
+	std::vector<char> _buffer ;
+	uint8_t _tail [3] ;
+	size_t _nbTail ;
+
+public:
+	base64Writer (std::ostream &out) ;
+	~base64Writer () { close () ; }
+
+	void write (const uint8_t *p, size_t len) ;
+	// Flushes the pending bytes with padding, can be called more than once
+	void close () ;
+
+} ;
+
+// Class       : gltfDataURIs
+// Abstraction : Data URIs which are only produced at serialization time. The document stores a short
+//               placeholder string instead, and write () streams the encoded payload straight into
+//               the output file, so no base64 copy of the data ever lives in memory. Placeholders
+//               carry a random key, so a user string can never be mistaken for one.
+class gltfDataURIs {
+	struct source {
+		std::string _mimeType ;
+		const std::vector<uint8_t> *_pData ; // or
+		std::string _fileName ;
+		std::string _uri ; // written instead if the file cannot be read
+	} ;
+	std::vector<source> _sources ;
+	std::string _prefix ;
+
+public:
+	gltfDataURIs () ;
+
+	void clear () { _sources.clear () ; }
+	size_t size () const { return (_sources.size ()) ; }
+
+	// The data must stay alive and unchanged until write () returns
+	std::string defer (const std::string &mimeType, const std::vector<uint8_t> &data) ;
+	std::string defer (const std::string &fileName, const std::string &uri) ;
+
+	// Writes json to out, replacing the placeholders by their data URI
+	bool write (std::ostream &out, const std::string &json) ;
+
+protected:
+	bool writeSource (std::ostream &out, const source &src) ;
+
+} ;
+
+}
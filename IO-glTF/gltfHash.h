@@ -0,0 +1,68 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <stdint.h>
+#include <string.h> // for memcpy
+
+namespace _IOglTF_NS_ {
+
+// Function    : gltfHash64
+// Abstraction : 64 bits non-cryptographic hash (MurmurHash64A by Austin Appleby, public domain).
+//               Consumes 8 bytes per round, which is fast enough to fingerprint image files and
+//               vertex streams without showing in a profile.
+inline uint64_t gltfHash64 (const void *data, size_t len, uint64_t seed =0) {
+	const uint64_t m =0xc6a4a7935bd1e995ULL ;
+	const int r =47 ;
+	uint64_t h =seed ^ (len * m) ;
+
+	const uint8_t *p =reinterpret_cast<const uint8_t *> (data) ;
+	const uint8_t *end =p + (len & ~(size_t)7) ;
+	for ( ; p != end ; p +=8 ) {
+		uint64_t k ;
+		memcpy (&k, p, sizeof (k)) ;
+		k *=m ;
+		k ^=k >> r ;
+		k *=m ;
+		h ^=k ;
+		h *=m ;
+	}
+	switch ( len & 7 ) {
+		case 7: h ^=uint64_t (p [6]) << 48 ;
+		case 6: h ^=uint64_t (p [5]) << 40 ;
+		case 5: h ^=uint64_t (p [4]) << 32 ;
+		case 4: h ^=uint64_t (p [3]) << 24 ;
+		case 3: h ^=uint64_t (p [2]) << 16 ;
+		case 2: h ^=uint64_t (p [1]) << 8 ;
+		case 1: h ^=uint64_t (p [0]) ;
+			h *=m ;
+	}
+	h ^=h >> r ;
+	h *=m ;
+	h ^=h >> r ;
+	return (h) ;
+}
+
+inline uint64_t gltfHashCombine (uint64_t seed, uint64_t value) {
+	return (seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2))) ;
+}
+
+}
@@ -0,0 +1,150 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfLayerElementReader
+// Abstraction : Reads a layer element value for every triangle corner, in place. The direct and index arrays
+//               are read through their raw (read locked) buffers, and the corner loop is instantiated per
+//               mapping mode x reference mode, so the modes are switched on once per element instead of once
+//               per corner. eByEdge elements are read through the mesh edge lookup, instead of being remapped
+//               to eByPolygonVertex, so the FbxMesh and its layers are never modified. Indices out of the
+//               arrays (malformed files) read T (), like a corner without an edge.
+template<class T>
+class gltfLayerElementReader {
+	FbxMesh *_pMesh ;
+	FbxLayerElementTemplate<T> *_pElement ;
+	T *_pDirect ;
+	int *_pIndices ;
+	unsigned int _nbDirect, _nbIndices ;
+
+public:
+	gltfLayerElementReader (FbxMesh *pMesh, FbxLayerElementTemplate<T> *pElement)
+		: _pMesh (pMesh), _pElement (pElement), _pDirect (nullptr), _pIndices (nullptr), _nbDirect (0), _nbIndices (0)
+	{
+		if ( _pElement == nullptr )
+			return ;
+		_pDirect =_pElement->GetDirectArray ().GetLocked (FbxLayerElementArray::eReadLock) ;
+		_nbDirect =(unsigned int)std::max (0, _pElement->GetDirectArray ().GetCount ()) ;
+		if ( _pElement->GetReferenceMode () != FbxLayerElement::eDirect ) {
+			_pIndices =_pElement->GetIndexArray ().GetLocked (FbxLayerElementArray::eReadLock) ;
+			_nbIndices =(unsigned int)std::max (0, _pElement->GetIndexArray ().GetCount ()) ;
+		}
+	}
+	virtual ~gltfLayerElementReader () {
+		if ( _pDirect )
+			_pElement->GetDirectArray ().Release (&_pDirect) ;
+		if ( _pIndices )
+			_pElement->GetIndexArray ().Release (&_pIndices) ;
+	}
+
+	bool valid () const { return (_pDirect != nullptr && (_pIndices != nullptr || _pElement->GetReferenceMode () == FbxLayerElement::eDirect)) ; }
+	// A missing element does not tell the corners of a control point apart either
+	bool perControlPoint () const {
+		return (   !valid ()
+			|| _pElement->GetMappingMode () == FbxLayerElement::eByControlPoint
+			|| _pElement->GetMappingMode () == FbxLayerElement::eAllSame) ;
+	}
+
+	// Appends convert (value) to out, for every corner of the triangles. Nothing is appended for a missing element.
+	template<class O, class F>
+	void gather (const gltfTriangulator::triangles &tris, std::vector<O> &out, F convert) const {
+		if ( !valid () )
+			return ;
+		out.reserve (out.size () + tris._corners.size ()) ;
+		bool bDirect =_pElement->GetReferenceMode () == FbxLayerElement::eDirect ;
+		switch ( _pElement->GetMappingMode () ) {
+			case FbxLayerElement::eByControlPoint:
+				bDirect ? gatherT<FbxLayerElement::eByControlPoint, true> (tris, out, convert) : gatherT<FbxLayerElement::eByControlPoint, false> (tris, out, convert) ;
+				break ;
+			case FbxLayerElement::eByPolygon:
+				bDirect ? gatherT<FbxLayerElement::eByPolygon, true> (tris, out, convert) : gatherT<FbxLayerElement::eByPolygon, false> (tris, out, convert) ;
+				break ;
+			case FbxLayerElement::eAllSame:
+				bDirect ? gatherT<FbxLayerElement::eAllSame, true> (tris, out, convert) : gatherT<FbxLayerElement::eAllSame, false> (tris, out, convert) ;
+				break ;
+			case FbxLayerElement::eByEdge:
+				bDirect ? gatherEdges<true> (tris, out, convert) : gatherEdges<false> (tris, out, convert) ;
+				break ;
+			default: // eByPolygonVertex
+				bDirect ? gatherT<FbxLayerElement::eByPolygonVertex, true> (tris, out, convert) : gatherT<FbxLayerElement::eByPolygonVertex, false> (tris, out, convert) ;
+				break ;
+		}
+	}
+
+	// Appends convert (value) to out, for every control point of a perControlPoint () element
+	template<class O, class F>
+	void gatherControlPoints (int nb, std::vector<O> &out, F convert) const {
+		if ( !valid () )
+			return ;
+		out.reserve (out.size () + nb) ;
+		bool bAllSame =_pElement->GetMappingMode () == FbxLayerElement::eAllSame ;
+		bool bDirect =_pElement->GetReferenceMode () == FbxLayerElement::eDirect ;
+		for ( int i =0 ; i < nb ; i++ ) {
+			int index =bAllSame ? 0 : i ;
+			out.push_back (convert (bDirect ? at<true> (index) : at<false> (index))) ;
+		}
+	}
+
+protected:
+	// Negative indices wrap to large unsigned ones, a single compare per array rejects both ends
+	template<bool bDirect>
+	T at (int index) const {
+		if ( !bDirect )
+			index =(unsigned int)index < _nbIndices ? _pIndices [index] : -1 ;
+		return ((unsigned int)index < _nbDirect ? _pDirect [index] : T ()) ;
+	}
+
+	// The mapping mode is a template constant, the compiler folds the selection below
+	template<FbxLayerElement::EMappingMode M, bool bDirect, class O, class F>
+	void gatherT (const gltfTriangulator::triangles &tris, std::vector<O> &out, F convert) const {
+		const int *pPolygonVertices =_pMesh->GetPolygonVertices () ;
+		const int *pCorners =tris._corners.data () ;
+		const int *pPolygons =tris._polygons.data () ;
+		size_t nb =tris._corners.size () ;
+		for ( size_t i =0 ; i < nb ; i++ ) {
+			int index =M == FbxLayerElement::eByControlPoint ? pPolygonVertices [pCorners [i]]
+				: M == FbxLayerElement::eByPolygon ? pPolygons [i / 3]
+				: M == FbxLayerElement::eAllSame ? 0
+				: pCorners [i] ;
+			out.push_back (convert (at<bDirect> (index))) ;
+		}
+	}
+
+	template<bool bDirect, class O, class F>
+	void gatherEdges (const gltfTriangulator::triangles &tris, std::vector<O> &out, F convert) const {
+		size_t nb =tris._corners.size () ;
+		_pMesh->BeginGetMeshEdgeIndexForPolygon () ;
+		for ( size_t i =0 ; i < nb ; i++ ) {
+			int polygon =tris._polygons [i / 3] ;
+			int index =_pMesh->GetMeshEdgeIndexForPolygon (polygon, tris._corners [i] - _pMesh->GetPolygonVertexIndex (polygon)) ;
+			out.push_back (convert (at<bDirect> (index))) ;
+		}
+		_pMesh->EndGetMeshEdgeIndexForPolygon () ;
+	}
+
+} ;
+
+}
@@ -0,0 +1,98 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <stdint.h>
+#include "jsoncpp/json.h"
+
+// Process wide heap counters. They are maintained by the application replacing the global operator
+// new / delete (see glTF/gltfMemoryHook.cpp) and defining GLTF_MEMORY_HOOK. The plug-in finds them
+// at run time through a weak symbol, so it runs unchanged in applications without the hook (and on
+// Windows, where a DLL cannot see the executable symbols, it only gets the explicit accounting).
+struct gltfMemoryCounters {
+	std::atomic<int64_t> _live ;
+	std::atomic<int64_t> _peak ;
+	std::atomic<uint64_t> _allocations ;
+	std::atomic<uint64_t> _allocated ;
+} ;
+
+#if defined(GLTF_MEMORY_HOOK)
+extern "C" gltfMemoryCounters *gltfMemoryCountersHook () ;
+#elif !defined(_WIN32) && !defined(_WIN64)
+extern "C" gltfMemoryCounters *gltfMemoryCountersHook () __attribute__((weak)) ;
+#endif
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfMemory
+// Abstraction : Access to the heap counters, and an estimate of the memory held by a JSON document.
+class gltfMemory {
+public:
+	static gltfMemoryCounters *counters () {
+#if defined(GLTF_MEMORY_HOOK)
+		return (gltfMemoryCountersHook ()) ;
+#elif !defined(_WIN32) && !defined(_WIN64)
+		return (gltfMemoryCountersHook ? gltfMemoryCountersHook () : nullptr) ;
+#else
+		return (nullptr) ;
+#endif
+	}
+
+	// Starts a new peak measure and returns the enclosing one, to be given back to endPeak () once done
+	static int64_t beginPeak (gltfMemoryCounters *pCounters) {
+		return (pCounters->_peak.exchange (pCounters->_live.load ())) ;
+	}
+	static int64_t endPeak (gltfMemoryCounters *pCounters, int64_t outerPeak) {
+		int64_t peak =pCounters->_peak.load () ;
+		int64_t value =peak ;
+		while ( value < outerPeak && !pCounters->_peak.compare_exchange_weak (value, outerPeak) )
+			;
+		return (peak) ;
+	}
+
+	// Approximation of the heap used by a jsoncpp document: one node and one map entry per value,
+	// plus the keys and string contents.
+	static size_t footprint (const Json::Value &value) {
+		const size_t mapNode =4 * sizeof (void *) + sizeof (Json::Value) ;
+		size_t bytes =sizeof (Json::Value) ;
+		switch ( value.type () ) {
+			case Json::stringValue:
+				bytes +=value.asString ().length () + 1 ;
+				break ;
+			case Json::arrayValue:
+			case Json::objectValue:
+				for ( Json::Value::const_iterator iter =value.begin () ; iter != value.end () ; iter++ ) {
+					bytes +=mapNode + footprint (*iter) ;
+					if ( value.type () == Json::objectValue )
+						bytes +=strlen (iter.memberName ()) + 1 ;
+				}
+				break ;
+			default:
+				break ;
+		}
+		return (bytes) ;
+	}
+
+} ;
+
+}
@@ -0,0 +1,220 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfMeshCache.h"
+#include "gltfHash.h"
+#include <chrono>
+
+namespace _IOglTF_NS_ {
+
+// Entry layout: magic, version, key, meta (json text) size, meta, then the mesh buffer bytes
+static const char gltfMeshCacheMagic [4] ={ 'G', 'L', 'M', 'C' } ;
+
+//-----------------------------------------------------------------------------
+bool gltfMeshCache::reset (const std::string &folder, uint64_t seed) {
+	_folder =folder ;
+	_seed =gltfHashCombine (seed, version) ;
+	_hits =_misses =_stores =0 ;
+	if ( _folder.empty () )
+		return (true) ;
+	if ( !FbxPathUtils::Create (_folder.c_str ()) ) {
+		_folder.clear () ;
+		return (false) ;
+	}
+	return (true) ;
+}
+
+std::string gltfMeshCache::entryFile (uint64_t key) const {
+	char name [32] ;
+	snprintf (name, sizeof (name), "%016llx.mesh", (unsigned long long)key) ;
+#if defined(_WIN32) || defined(_WIN64)
+	return (_folder + "\\" + name) ;
+#else
+	return (_folder + "/" + name) ;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Function    : hashLayerElement
+// Abstraction : Fingerprints the modes, direct and index arrays of a layer element, read in place
+template<class T>
+static uint64_t hashLayerElement (uint64_t h, FbxLayerElementTemplate<T> *pElement) {
+	if ( pElement == nullptr )
+		return (gltfHashCombine (h, 0)) ;
+	h =gltfHashCombine (h, (uint64_t)pElement->GetMappingMode () + 1) ;
+	h =gltfHashCombine (h, (uint64_t)pElement->GetReferenceMode ()) ;
+	FbxLayerElementArrayTemplate<T> &direct =pElement->GetDirectArray () ;
+	T *pDirect =direct.GetLocked (FbxLayerElementArray::eReadLock) ;
+	h =gltfHashCombine (h, gltfHash64 (pDirect, (size_t)direct.GetCount () * sizeof (T))) ;
+	if ( pDirect )
+		direct.Release (&pDirect) ;
+	if ( pElement->GetReferenceMode () != FbxLayerElement::eDirect ) {
+		FbxLayerElementArrayTemplate<int> &indices =pElement->GetIndexArray () ;
+		int *pIndices =indices.GetLocked (FbxLayerElementArray::eReadLock) ;
+		h =gltfHashCombine (h, gltfHash64 (pIndices, (size_t)indices.GetCount () * sizeof (int))) ;
+		if ( pIndices )
+			indices.Release (&pIndices) ;
+	}
+	return (h) ;
+}
+
+uint64_t gltfMeshCache::key (FbxMesh *pMesh) const {
+	uint64_t h =_seed ;
+	h =gltfHashCombine (h, gltfHash64 (pMesh->GetControlPoints (), (size_t)pMesh->GetControlPointsCount () * sizeof (FbxVector4))) ;
+	h =gltfHashCombine (h, (uint64_t)pMesh->GetPolygonCount ()) ;
+	h =gltfHashCombine (h, gltfHash64 (pMesh->GetPolygonVertices (), (size_t)pMesh->GetPolygonVertexCount () * sizeof (int))) ;
+	int nbLayers =pMesh->GetLayerCount () ;
+	h =gltfHashCombine (h, (uint64_t)nbLayers) ;
+	for ( int iLayer =0 ; iLayer < nbLayers ; iLayer++ ) {
+		FbxLayer *pLayer =pMesh->GetLayer (iLayer) ;
+		h =hashLayerElement (h, pLayer->GetNormals ()) ;
+		h =hashLayerElement (h, pLayer->GetTangents ()) ;
+		h =hashLayerElement (h, pLayer->GetBinormals ()) ;
+		h =hashLayerElement (h, pLayer->GetVertexColors ()) ;
+		for ( int channel =FbxLayerElement::sTypeTextureStartIndex ; channel <= FbxLayerElement::sTypeTextureEndIndex ; channel++ )
+			h =hashLayerElement (h, pLayer->GetUVs ((FbxLayerElement::EType)channel)) ;
+	}
+	return (h) ;
+}
+
+//-----------------------------------------------------------------------------
+bool gltfMeshCache::contains (uint64_t key) const {
+	if ( !enabled () )
+		return (false) ;
+	std::ifstream file (entryFile (key), std::ios::in | std::ios::binary) ;
+	return (file.is_open ()) ;
+}
+
+bool gltfMeshCache::lookup (uint64_t key, Json::Value &meta, memoryStream<uint8_t> &bin) {
+	if ( !enabled () )
+		return (false) ;
+	memoryMappedFile file ;
+	const size_t headerSize =sizeof (gltfMeshCacheMagic) + sizeof (uint32_t) + sizeof (uint64_t) + sizeof (uint32_t) ;
+	if ( !file.open (entryFile (key)) || file.size () < headerSize || memcmp (file.data (), gltfMeshCacheMagic, sizeof (gltfMeshCacheMagic)) != 0 )
+		return (_misses++, false) ;
+	const uint8_t *p =file.data () + sizeof (gltfMeshCacheMagic) ;
+	uint32_t entryVersion, metaSize ;
+	uint64_t entryKey ;
+	memcpy (&entryVersion, p, sizeof (entryVersion)) ; p +=sizeof (entryVersion) ;
+	memcpy (&entryKey, p, sizeof (entryKey)) ; p +=sizeof (entryKey) ;
+	memcpy (&metaSize, p, sizeof (metaSize)) ; p +=sizeof (metaSize) ;
+	if ( entryVersion != version || entryKey != key || headerSize + metaSize > file.size () )
+		return (_misses++, false) ;
+
+	Json::Reader reader ;
+	if ( !reader.parse ((const char *)p, (const char *)p + metaSize, meta, false) || !meta.isObject () )
+		return (_misses++, false) ;
+	p +=metaSize ;
+	size_t size =file.size () - headerSize - metaSize ;
+	if ( size != meta [("byteLength")].asUInt64 () )
+		return (_misses++, false) ;
+	bin.write (const_cast<uint8_t *> (p), size) ;
+	_hits++ ;
+	return (true) ;
+}
+
+bool gltfMeshCache::store (uint64_t key, const Json::Value &meta, const uint8_t *data, size_t size) {
+	if ( !enabled () )
+		return (false) ;
+	Json::Value entry (meta) ;
+	entry [("byteLength")] =(Json::UInt64)size ;
+	Json::FastWriter writer ;
+	std::string text =writer.write (entry) ;
+
+	// Write a private file, then rename it, so concurrent exports never read a partial entry
+	std::string fileName =entryFile (key) ;
+	std::string temp =fileName + "." + std::to_string (std::chrono::steady_clock::now ().time_since_epoch ().count ()) + ".tmp" ;
+	{
+		std::ofstream output (temp, std::ios::out | std::ofstream::binary) ;
+		uint32_t metaSize =(uint32_t)text.size () ;
+		output.write (gltfMeshCacheMagic, sizeof (gltfMeshCacheMagic)) ;
+		output.write ((const char *)&version, sizeof (version)) ;
+		output.write ((const char *)&key, sizeof (key)) ;
+		output.write ((const char *)&metaSize, sizeof (metaSize)) ;
+		output.write (text.c_str (), text.size ()) ;
+		output.write ((const char *)data, size) ;
+		if ( !output.good () ) {
+			output.close () ;
+			remove (temp.c_str ()) ;
+			return (false) ;
+		}
+	}
+	if ( rename (temp.c_str (), fileName.c_str ()) != 0 ) {
+		// Windows does not replace an existing file, another export stored the same entry already
+		remove (temp.c_str ()) ;
+		return (false) ;
+	}
+	_stores++ ;
+	return (true) ;
+}
+
+//-----------------------------------------------------------------------------
+static std::string stripPrefix (const std::string &id, const std::string &prefix) {
+	if ( id.compare (0, prefix.size (), prefix) == 0 )
+		return (id.substr (prefix.size ())) ;
+	return (id) ;
+}
+
+/*static*/ Json::Value gltfMeshCache::relative (const Json::Value &accessorsAndBufferViews, const std::string &prefix, size_t binStart) {
+	Json::Value ret ;
+	ret [("accessors")] =Json::Value (Json::objectValue) ;
+	ret [("bufferViews")] =Json::Value (Json::objectValue) ;
+	const Json::Value &accessors =accessorsAndBufferViews [("accessors")] ;
+	for ( Json::Value::const_iterator iter =accessors.begin () ; iter != accessors.end () ; iter++ ) {
+		Json::Value accDef (*iter) ;
+		accDef [("bufferView")] =stripPrefix (accDef [("bufferView")].asString (), prefix) ;
+		accDef [("name")] =stripPrefix (accDef [("name")].asString (), prefix) ;
+		ret [("accessors")] [stripPrefix (iter.memberName (), prefix)] =accDef ;
+	}
+	const Json::Value &views =accessorsAndBufferViews [("bufferViews")] ;
+	for ( Json::Value::const_iterator iter =views.begin () ; iter != views.end () ; iter++ ) {
+		Json::Value viewDef (*iter) ;
+		viewDef.removeMember (("buffer")) ;
+		viewDef [("byteOffset")] =(Json::UInt64)(viewDef [("byteOffset")].asUInt64 () - binStart) ;
+		viewDef [("name")] =stripPrefix (viewDef [("name")].asString (), prefix) ;
+		ret [("bufferViews")] [stripPrefix (iter.memberName (), prefix)] =viewDef ;
+	}
+	return (ret) ;
+}
+
+/*static*/ Json::Value gltfMeshCache::absolute (const Json::Value &accessorsAndBufferViews, const std::string &prefix, const std::string &buffer, size_t binStart) {
+	Json::Value ret ;
+	ret [("accessors")] =Json::Value (Json::objectValue) ;
+	ret [("bufferViews")] =Json::Value (Json::objectValue) ;
+	const Json::Value &accessors =accessorsAndBufferViews [("accessors")] ;
+	for ( Json::Value::const_iterator iter =accessors.begin () ; iter != accessors.end () ; iter++ ) {
+		Json::Value accDef (*iter) ;
+		accDef [("bufferView")] =prefix + accDef [("bufferView")].asString () ;
+		accDef [("name")] =prefix + accDef [("name")].asString () ;
+		ret [("accessors")] [prefix + iter.memberName ()] =accDef ;
+	}
+	const Json::Value &views =accessorsAndBufferViews [("bufferViews")] ;
+	for ( Json::Value::const_iterator iter =views.begin () ; iter != views.end () ; iter++ ) {
+		Json::Value viewDef (*iter) ;
+		viewDef [("buffer")] =buffer ;
+		viewDef [("byteOffset")] =(Json::UInt64)(viewDef [("byteOffset")].asUInt64 () + binStart) ;
+		viewDef [("name")] =prefix + viewDef [("name")].asString () ;
+		ret [("bufferViews")] [prefix + iter.memberName ()] =viewDef ;
+	}
+	return (ret) ;
+}
+
+}
@@ -0,0 +1,71 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <string>
+#include <stdint.h>
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfMeshCache
+// Abstraction : On-disk cache of the mesh buffers written by a previous export. The key hashes the
+//               control points, the polygon vertices, every layer element array and the export
+//               options which change the geometry, so an unchanged mesh is copied back from its
+//               entry (welded, encoded and with its accessor metadata) instead of going through the
+//               VBO indexing again. Ids are stored relative to the mesh node id, and bufferView
+//               offsets relative to the mesh first byte, so an entry can be replayed in any scene.
+class gltfMeshCache {
+	std::string _folder ;
+	uint64_t _seed ;
+	size_t _hits, _misses, _stores ;
+
+public:
+	static const uint32_t version =2 ;
+
+	gltfMeshCache () : _seed (0), _hits (0), _misses (0), _stores (0) {}
+
+	// An empty folder disables the cache. The seed is combined in every key, and should hash the
+	// writer version and options.
+	bool reset (const std::string &folder, uint64_t seed) ;
+	bool enabled () const { return (!_folder.empty ()) ; }
+
+	uint64_t key (FbxMesh *pMesh) const ;
+	// On a hit, the cached bytes are appended to bin, and meta receives the entry description
+	bool lookup (uint64_t key, Json::Value &meta, memoryStream<uint8_t> &bin) ;
+	// Whether an entry exists, without reading it (lookup () still validates it)
+	bool contains (uint64_t key) const ;
+	bool store (uint64_t key, const Json::Value &meta, const uint8_t *data, size_t size) ;
+
+	size_t hits () const { return (_hits) ; }
+	size_t misses () const { return (_misses) ; }
+	size_t stores () const { return (_stores) ; }
+
+	// Rewrites an { accessors, bufferViews } object for/from the cache, i.e. removes/prepends the
+	// mesh node id from/to every id and shifts the bufferView byteOffset by -binStart/+binStart
+	static Json::Value relative (const Json::Value &accessorsAndBufferViews, const std::string &prefix, size_t binStart) ;
+	static Json::Value absolute (const Json::Value &accessorsAndBufferViews, const std::string &prefix, const std::string &buffer, size_t binStart) ;
+
+protected:
+	std::string entryFile (uint64_t key) const ;
+
+} ;
+
+}
@@ -0,0 +1,226 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <unordered_set>
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfNodeFilter
+// Abstraction : Selects the part of the scene to export. Only the subtrees whose root name matches a 'root'
+//               glob are walked (the whole scene if none), an 'exclude' match prunes the node and its
+//               subtree, and a node attribute (mesh, camera, ...) is only exported if the node or one of
+//               its ancestors matches an 'include' glob (all if none) and its type is listed (all if none).
+//               Nodes which are not exported themselves, but have exported descendants, are kept as
+//               transform nodes. Selecting walks node names only, nothing is evaluated outside the
+//               selected subtrees. Filters travel in the IOSettings as 'kind glob' lines.
+class gltfNodeFilter {
+	std::vector<std::string> _roots ;
+	std::vector<std::string> _includes ;
+	std::vector<std::string> _excludes ;
+	std::vector<FbxNodeAttribute::EType> _types ;
+	// Result of the last select ()
+	std::vector<FbxNode *> _rootNodes ;
+	std::unordered_set<FbxNode *> _exported ;
+	std::unordered_set<FbxNode *> _kept ;
+
+public:
+	gltfNodeFilter () {}
+
+	bool active () const { return (_roots.size () || _includes.size () || _excludes.size () || _types.size ()) ; }
+	void clear () {
+		_roots.clear () ; _includes.clear () ; _excludes.clear () ; _types.clear () ;
+		_rootNodes.clear () ; _exported.clear () ; _kept.clear () ;
+	}
+
+	void root (const std::string &glob) { _roots.push_back (glob) ; }
+	void include (const std::string &glob) { _includes.push_back (glob) ; }
+	void exclude (const std::string &glob) { _excludes.push_back (glob) ; }
+	// mesh, camera, light, null, skeleton, line or marker
+	bool type (const std::string &name) {
+		FbxNodeAttribute::EType nodeType ;
+		if ( !typeFromName (name, nodeType) )
+			return (false) ;
+		_types.push_back (nodeType) ;
+		return (true) ;
+	}
+	// Comma separated type names
+	bool types (const std::string &names) {
+		std::istringstream input (names) ;
+		std::string name ;
+		bool bRet =true ;
+		while ( std::getline (input, name, ',') )
+			bRet =type (name) && bRet ;
+		return (bRet) ;
+	}
+
+	std::string spec () const {
+		std::string ret ;
+		for ( const std::string &glob : _roots )
+			ret +="root " + glob + "\n" ;
+		for ( const std::string &glob : _includes )
+			ret +="include " + glob + "\n" ;
+		for ( const std::string &glob : _excludes )
+			ret +="exclude " + glob + "\n" ;
+		for ( FbxNodeAttribute::EType nodeType : _types )
+			ret +=std::string ("type ") + typeName (nodeType) + "\n" ;
+		return (ret) ;
+	}
+	bool parse (const std::string &spec) {
+		clear () ;
+		std::istringstream input (spec) ;
+		std::string line ;
+		bool bRet =true ;
+		while ( std::getline (input, line) ) {
+			size_t pos =line.find (' ') ;
+			std::string kind =line.substr (0, pos), value =pos == std::string::npos ? "" : line.substr (pos + 1) ;
+			if ( kind == "root" )
+				root (value) ;
+			else if ( kind == "include" )
+				include (value) ;
+			else if ( kind == "exclude" )
+				exclude (value) ;
+			else if ( kind != "type" || !type (value) )
+				bRet =false ;
+		}
+		return (bRet) ;
+	}
+
+	// Walks the scene from pRoot, and records the nodes to write
+	void select (FbxNode *pRoot) {
+		_rootNodes.clear () ;
+		_exported.clear () ;
+		_kept.clear () ;
+		findRoots (pRoot) ;
+		for ( FbxNode *pNode : _rootNodes )
+			selectRecursive (pNode, false) ;
+	}
+	// Top nodes to write, the scene root node if no 'root' glob was given
+	const std::vector<FbxNode *> &roots () const { return (_rootNodes) ; }
+	bool isRoot (FbxNode *pNode) const { return (_roots.size () && std::find (_rootNodes.begin (), _rootNodes.end (), pNode) != _rootNodes.end ()) ; }
+	// The node attribute is exported
+	bool exported (FbxNode *pNode) const { return (_exported.find (pNode) != _exported.end ()) ; }
+	// The node is written, possibly as a transform node only
+	bool kept (FbxNode *pNode) const { return (_kept.find (pNode) != _kept.end ()) ; }
+	size_t exportedCount () const { return (_exported.size ()) ; }
+	size_t keptCount () const { return (_kept.size ()) ; }
+
+	// '*' matches any sequence, '?' any single character
+	static bool match (const char *pattern, const char *name) {
+		const char *pStar =nullptr, *pResume =nullptr ;
+		while ( *name ) {
+			if ( *pattern == '*' ) {
+				pStar =pattern++ ;
+				pResume =name ;
+			} else if ( *pattern == '?' || *pattern == *name ) {
+				pattern++ ;
+				name++ ;
+			} else if ( pStar ) {
+				pattern =pStar + 1 ;
+				name =++pResume ;
+			} else {
+				return (false) ;
+			}
+		}
+		while ( *pattern == '*' )
+			pattern++ ;
+		return (*pattern == 0) ;
+	}
+
+	static bool typeFromName (const std::string &name, FbxNodeAttribute::EType &nodeType) {
+		static const struct { const char *_name ; FbxNodeAttribute::EType _type ; } types [] ={
+			{ "mesh", FbxNodeAttribute::eMesh }, { "camera", FbxNodeAttribute::eCamera }, { "light", FbxNodeAttribute::eLight },
+			{ "null", FbxNodeAttribute::eNull }, { "skeleton", FbxNodeAttribute::eSkeleton }, { "line", FbxNodeAttribute::eLine },
+			{ "marker", FbxNodeAttribute::eMarker }
+		} ;
+		for ( const auto &entry : types ) {
+			if ( name == entry._name )
+				return (nodeType =entry._type, true) ;
+		}
+		return (false) ;
+	}
+	static const char *typeName (FbxNodeAttribute::EType nodeType) {
+		switch ( nodeType ) {
+			case FbxNodeAttribute::eMesh: return ("mesh") ;
+			case FbxNodeAttribute::eCamera: return ("camera") ;
+			case FbxNodeAttribute::eLight: return ("light") ;
+			case FbxNodeAttribute::eNull: return ("null") ;
+			case FbxNodeAttribute::eSkeleton: return ("skeleton") ;
+			case FbxNodeAttribute::eLine: return ("line") ;
+			case FbxNodeAttribute::eMarker: return ("marker") ;
+			default: return ("unknown") ;
+		}
+	}
+
+protected:
+	static bool matchAny (const std::vector<std::string> &globs, const char *name) {
+		for ( const std::string &glob : globs ) {
+			if ( match (glob.c_str (), name) )
+				return (true) ;
+		}
+		return (false) ;
+	}
+
+	bool typeAllowed (FbxNode *pNode) const {
+		if ( _types.empty () )
+			return (true) ;
+		FbxNodeAttribute *pNodeAttribute =pNode->GetNodeAttribute () ;
+		FbxNodeAttribute::EType nodeType =pNodeAttribute ? pNodeAttribute->GetAttributeType () : FbxNodeAttribute::eUnknown ;
+		if ( pNodeAttribute == nullptr && std::string (pNode->GetTypeName ()) == "Null" )
+			nodeType =FbxNodeAttribute::eNull ;
+		// NURBS and patches are converted to meshes before the export
+		if ( nodeType == FbxNodeAttribute::eNurbs || nodeType == FbxNodeAttribute::eNurbsSurface || nodeType == FbxNodeAttribute::ePatch )
+			nodeType =FbxNodeAttribute::eMesh ;
+		return (std::find (_types.begin (), _types.end (), nodeType) != _types.end ()) ;
+	}
+
+	void findRoots (FbxNode *pNode) {
+		if ( _roots.empty () || matchAny (_roots, pNode->GetName ()) ) {
+			_rootNodes.push_back (pNode) ;
+			return ;
+		}
+		for ( int i =0 ; i < pNode->GetChildCount () ; i++ )
+			findRoots (pNode->GetChild (i)) ;
+	}
+
+	bool selectRecursive (FbxNode *pNode, bool bIncluded) {
+		const char *pszName =pNode->GetName () ;
+		if ( matchAny (_excludes, pszName) )
+			return (false) ;
+		bIncluded =bIncluded || _includes.empty () || matchAny (_includes, pszName) ;
+		bool bExported =bIncluded && typeAllowed (pNode) ;
+		bool bKept =bExported ;
+		for ( int i =0 ; i < pNode->GetChildCount () ; i++ )
+			bKept =selectRecursive (pNode->GetChild (i), bIncluded) || bKept ;
+		if ( bExported )
+			_exported.insert (pNode) ;
+		if ( bKept )
+			_kept.insert (pNode) ;
+		return (bKept) ;
+	}
+
+} ;
+
+}
@@ -0,0 +1,144 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfReader.h"
+
+namespace _IOglTF_NS_ {
+
+//-----------------------------------------------------------------------------
+// glTF 1.0 materials are read from their values (our own techniques, see gltfWriter::WriteMaterial, or
+// KHR_materials_common), glTF 2.0 materials from pbrMetallicRoughness. Both end up as Lambert or Phong.
+FbxSurfaceMaterial *gltfReader::ReadMaterial (const std::string &id) {
+	auto iter =_materials.find (id) ;
+	if ( iter != _materials.end () )
+		return (iter->second) ;
+
+	if ( id.empty () ) {
+		FbxSurfaceLambert *pDefault =FbxSurfaceLambert::Create (_pScene, "DefaultMaterial") ;
+		pDefault->Diffuse.Set (FbxDouble3 (0.8, 0.8, 0.8)) ;
+		pDefault->DiffuseFactor.Set (1.) ;
+		return (_materials [id] =pDefault) ;
+	}
+
+	const Json::Value &materialDef =object ("materials", id) ;
+	if ( materialDef.isNull () )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Material '%s' not found", id.c_str ()), nullptr) ;
+	std::string name =materialDef.get ("name", id).asString () ;
+
+	const Json::Value &common =materialDef ["extensions"] ["KHR_materials_common"] ;
+	const Json::Value &values =common.isObject () ? common ["values"] : materialDef ["values"] ;
+	const Json::Value &extras =object ("techniques", idOf (materialDef ["technique"])) ["extras"] ;
+	std::string model =common.isObject () ? common.get ("technique", "").asString () : extras.get ("lightingModel", "").asString () ;
+	std::transform (model.begin (), model.end (), model.begin (), ::tolower) ;
+	bool bPhong =model == "phong" || model == "blinn"
+		|| (model.empty () && (values.isMember ("specular") || values.isMember ("shininess"))) ;
+
+	auto uvSet =[&extras] (const char *pszChannel, const Json::Value &value) -> std::string {
+		if ( value.isObject () ) // glTF 2.0 textureInfo
+			return ("TEXCOORD_" + std::to_string (value.get ("texCoord", 0).asInt ())) ;
+		return (extras ["texcoordBindings"].get (pszChannel, "TEXCOORD_0").asString ()) ;
+	} ;
+
+	FbxSurfacePhong *pPhong =bPhong ? FbxSurfacePhong::Create (_pScene, name.c_str ()) : nullptr ;
+	FbxSurfaceLambert *pLambert =bPhong ? pPhong : FbxSurfaceLambert::Create (_pScene, name.c_str ()) ;
+	double opacity =1. ;
+
+	ReadColor (pLambert->Ambient, pLambert->AmbientFactor, values ["ambient"], uvSet ("ambient", values ["ambient"])) ;
+	ReadColor (pLambert->Diffuse, pLambert->DiffuseFactor, values ["diffuse"], uvSet ("diffuse", values ["diffuse"])) ;
+	ReadColor (pLambert->Emissive, pLambert->EmissiveFactor, values ["emission"], uvSet ("emission", values ["emission"])) ;
+	if ( values ["diffuse"].isArray () && values ["diffuse"].size () == 4 )
+		opacity =values ["diffuse"] [3].asDouble () ;
+	if ( values ["transparency"].isNumeric () ) // glTF - opaque is 1. / transparency is 0.
+		opacity *=values ["transparency"].asDouble () ;
+	if ( pPhong ) {
+		ReadColor (pPhong->Specular, pPhong->SpecularFactor, values ["specular"], uvSet ("specular", values ["specular"])) ;
+		if ( values ["shininess"].isNumeric () )
+			pPhong->Shininess.Set (values ["shininess"].asDouble ()) ;
+	}
+
+	const Json::Value &pbr =materialDef ["pbrMetallicRoughness"] ;
+	if ( pbr.isObject () ) {
+		const Json::Value &baseColor =pbr ["baseColorFactor"] ;
+		ReadColor (pLambert->Diffuse, pLambert->DiffuseFactor, baseColor, "") ;
+		ReadColor (pLambert->Diffuse, pLambert->DiffuseFactor, pbr ["baseColorTexture"], uvSet ("diffuse", pbr ["baseColorTexture"])) ;
+		if ( baseColor.isArray () && baseColor.size () == 4 )
+			opacity =baseColor [3].asDouble () ;
+	}
+	ReadColor (pLambert->Emissive, pLambert->EmissiveFactor, materialDef ["emissiveFactor"], "") ;
+	ReadColor (pLambert->Emissive, pLambert->EmissiveFactor, materialDef ["emissiveTexture"], uvSet ("emission", materialDef ["emissiveTexture"])) ;
+
+	if ( opacity < 1. )
+		pLambert->TransparencyFactor.Set (1. - opacity) ; // FBX - 0 is opaque, 1 is transparent
+	return (_materials [id] =pLambert) ;
+}
+
+// A value is either a color, or a texture (glTF 1.0 texture id, or glTF 2.0 textureInfo)
+void gltfReader::ReadColor (FbxPropertyT<FbxDouble3> &prop, FbxPropertyT<FbxDouble> &factor, const Json::Value &value, const std::string &uvSet) {
+	if ( value.isArray () && value.size () >= 3 ) {
+		prop.Set (FbxDouble3 (value [0].asDouble (), value [1].asDouble (), value [2].asDouble ())) ;
+		factor.Set (1.) ;
+	} else if ( value.isString () || (value.isObject () && value.isMember ("index")) ) {
+		FbxFileTexture *pTexture =ReadTexture (idOf (value.isObject () ? value ["index"] : value), uvSet.c_str ()) ;
+		if ( pTexture ) {
+			prop.ConnectSrcObject (pTexture) ;
+			factor.Set (1.) ;
+		}
+	}
+}
+
+FbxFileTexture *gltfReader::ReadTexture (const std::string &id, const char *pszUVSet) {
+	auto iter =_textures.find (id) ;
+	if ( iter != _textures.end () )
+		return (iter->second) ;
+
+	const Json::Value &textureDef =object ("textures", id) ;
+	const Json::Value &imageDef =object ("images", idOf (textureDef ["source"])) ;
+	std::string uri =imageDef.get ("uri", "").asString () ;
+	if ( textureDef.isNull () || imageDef.isNull () ) {
+		std::cout << "Warning: texture '" << id << "' or its image not found" << std::endl ;
+		return (_textures [id] =nullptr) ;
+	}
+	if ( uri.empty () || uri.compare (0, 5, "data:") == 0 ) {
+		// FBX file textures need a file on disk
+		std::cout << "Warning: texture '" << id << "' uses an embedded image, skipped" << std::endl ;
+		return (_textures [id] =nullptr) ;
+	}
+
+	FbxFileTexture *pTexture =FbxFileTexture::Create (_pScene, textureDef.get ("name", id).asString ().c_str ()) ;
+	pTexture->SetFileName (ResolveUri (uri).c_str ()) ;
+	pTexture->SetTextureUse (FbxTexture::eStandard) ;
+	pTexture->SetMappingType (FbxTexture::eUV) ;
+	pTexture->SetMaterialUse (FbxFileTexture::eModelMaterial) ;
+	pTexture->UVSet.Set (FbxString (pszUVSet)) ;
+
+	const Json::Value &samplerDef =object ("samplers", idOf (textureDef ["sampler"])) ;
+	unsigned int wrapS =samplerDef.get ("wrapS", IOglTF::REPEAT).asUInt () ;
+	unsigned int wrapT =samplerDef.get ("wrapT", IOglTF::REPEAT).asUInt () ;
+	pTexture->SetWrapMode (
+		wrapS == IOglTF::CLAMP_TO_EDGE ? FbxTexture::eClamp : FbxTexture::eRepeat,
+		wrapT == IOglTF::CLAMP_TO_EDGE ? FbxTexture::eClamp : FbxTexture::eRepeat
+	) ;
+	return (_textures [id] =pTexture) ;
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,331 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfReader.h"
+#include <atomic>
+
+namespace _IOglTF_NS_ {
+
+// Accessor views of one primitive, and where its vertices and triangles land in the FBX mesh
+struct gltfPrimitiveViews {
+	unsigned int _mode ;
+	gltfAccessor _positions ;
+	gltfAccessor _normals ;
+	gltfAccessor _colors ;
+	std::vector<gltfAccessor> _uvs ;
+	gltfAccessor _indices ;
+	size_t _nbTriangles ;
+	std::string _material ;
+	int _materialIndex ;
+	size_t _base ;
+	size_t _triangleBase ;
+} ;
+
+struct gltfReader::meshJob {
+	std::string _id ;
+	FbxMesh *_pMesh ;
+	std::vector<gltfPrimitiveViews> _views ;
+	size_t _nbTriangles ;
+	FbxVector4 *_pControlPoints ;
+	FbxGeometryElementNormal *_pElementNormals ;
+	FbxVector4 *_pNormals ;
+	FbxGeometryElementVertexColor *_pElementColors ;
+	FbxColor *_pColors ;
+	std::vector<FbxGeometryElementUV *> _elementUVs ;
+	std::vector<FbxVector2 *> _uvs ;
+	std::vector<int> _polygonVertices ;
+	std::atomic<bool> _bFailed ;
+
+	meshJob () : _pMesh (nullptr), _nbTriangles (0), _pControlPoints (nullptr), _pElementNormals (nullptr), _pNormals (nullptr),
+		_pElementColors (nullptr), _pColors (nullptr), _bFailed (false) {}
+} ;
+
+// Vertices and triangles are decoded in chunks, so a single large primitive still spreads over the workers
+static const size_t sChunkSize =64 * 1024 ;
+
+// Vertex k of triangle t, for the 3 triangle modes
+static unsigned int triangleVertex (const gltfPrimitiveViews &views, size_t t, int k) {
+	size_t j ;
+	switch ( views._mode ) {
+		case IOglTF::TRIANGLE_STRIP: j =(t & 1) && k < 2 ? t + 1 - k : t + k ; break ; // Odd triangles are flipped to keep the winding
+		case IOglTF::TRIANGLE_FAN: j =k == 0 ? 0 : t + k ; break ;
+		default: j =t * 3 + k ; break ;
+	}
+	return (views._indices.isValid () ? views._indices.index (j) : (unsigned int)j) ;
+}
+
+// Every chunk writes its own range of the locked FBX arrays, so jobs never share memory
+static void decodeVertices (gltfReader::meshJob &job, const gltfPrimitiveViews &pv, size_t begin, size_t end) {
+	double v [4] ;
+	for ( size_t i =begin ; i < end ; i++ ) {
+		pv._positions.get (i, v) ;
+		job._pControlPoints [pv._base + i] =FbxVector4 (v [0], v [1], v [2]) ;
+	}
+	if ( job._pNormals ) {
+		for ( size_t i =begin ; i < end ; i++ ) {
+			if ( pv._normals.isValid () )
+				pv._normals.get (i, v) ;
+			else
+				v [0] =v [1] =v [2] =0. ;
+			job._pNormals [pv._base + i] =FbxVector4 (v [0], v [1], v [2], 0.) ;
+		}
+	}
+	if ( job._pColors ) {
+		for ( size_t i =begin ; i < end ; i++ ) {
+			v [3] =1. ;
+			if ( pv._colors.isValid () )
+				pv._colors.get (i, v) ;
+			else
+				v [0] =v [1] =v [2] =1. ;
+			job._pColors [pv._base + i] =FbxColor (v [0], v [1], v [2], v [3]) ;
+		}
+	}
+	for ( size_t uv =0 ; uv < job._uvs.size () ; uv++ ) {
+		for ( size_t i =begin ; i < end ; i++ ) {
+			if ( uv < pv._uvs.size () )
+				pv._uvs [uv].get (i, v) ;
+			else
+				v [0] =v [1] =0. ;
+			job._uvs [uv] [pv._base + i] =FbxVector2 (v [0], 1.0 - v [1]) ; // glTF V goes down (see gltfwriterVBO)
+		}
+	}
+}
+
+static void decodeTriangles (gltfReader::meshJob &job, const gltfPrimitiveViews &pv, size_t begin, size_t end) {
+	size_t nbVertices =pv._positions.count () ;
+	int *pVertices =job._polygonVertices.data () + (pv._triangleBase + begin) * 3 ;
+	for ( size_t t =begin ; t < end ; t++ ) {
+		for ( int k =0 ; k < 3 ; k++ ) {
+			unsigned int index =triangleVertex (pv, t, k) ;
+			if ( index >= nbVertices ) {
+				job._bFailed =true ;
+				return ;
+			}
+			*pVertices++ =(int)(pv._base + index) ;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Validates the primitives, creates the FBX mesh and allocates its arrays. The accessors are decoded
+// later by BuildMeshes ().
+FbxMesh *gltfReader::ReadMesh (const std::string &id) {
+	auto iter =_meshes.find (id) ;
+	if ( iter != _meshes.end () )
+		return (iter->second) ;
+
+	const Json::Value &meshDef =object ("meshes", id) ;
+	if ( meshDef.isNull () )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Mesh '%s' not found", id.c_str ()), nullptr) ;
+
+	// Collect and validate the accessor views of every primitive. All primitives are merged into one FBX mesh,
+	// the primitive material becoming the polygon material.
+	std::shared_ptr<meshJob> job =std::make_shared<meshJob> () ;
+	job->_id =id ;
+	std::vector<gltfPrimitiveViews> &views =job->_views ;
+	const Json::Value &primitives =meshDef ["primitives"] ;
+	size_t nbControlPoints =0, nbTriangles =0, nbUVSets =0 ;
+	bool bNormals =false, bColors =false, bMaterials =false ;
+	for ( Json::ArrayIndex i =0 ; i < primitives.size () ; i++ ) {
+		const Json::Value &primitive =primitives [i] ;
+		const Json::Value &attributes =primitive ["attributes"] ;
+		gltfPrimitiveViews pv ;
+		pv._mode =primitive.get ("mode", IOglTF::TRIANGLES).asUInt () ;
+		if ( pv._mode != IOglTF::TRIANGLES && pv._mode != IOglTF::TRIANGLE_STRIP && pv._mode != IOglTF::TRIANGLE_FAN ) {
+			std::cout << "Warning: mesh '" << id << "' primitive " << i << " is not made of triangles (mode " << pv._mode << "), skipped" << std::endl ;
+			continue ;
+		}
+		if ( !attributes.isMember ("POSITION") ) {
+			std::cout << "Warning: mesh '" << id << "' primitive " << i << " has no POSITION, skipped" << std::endl ;
+			continue ;
+		}
+		pv._positions =ReadAccessor (idOf (attributes ["POSITION"])) ;
+		if ( !pv._positions.isValid () )
+			return (nullptr) ;
+		if ( pv._positions.components () != 3 )
+			return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Mesh '%s' POSITION is not a VEC3", id.c_str ()), nullptr) ;
+		size_t nbVertices =pv._positions.count () ;
+		if ( attributes.isMember ("NORMAL") ) {
+			pv._normals =ReadAccessor (idOf (attributes ["NORMAL"])) ;
+			if ( !pv._normals.isValid () )
+				return (nullptr) ;
+			if ( pv._normals.count () != nbVertices || pv._normals.components () != 3 )
+				return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Mesh '%s' NORMAL does not match POSITION", id.c_str ()), nullptr) ;
+			bNormals =true ;
+		}
+		if ( attributes.isMember ("COLOR_0") ) {
+			pv._colors =ReadAccessor (idOf (attributes ["COLOR_0"])) ;
+			if ( !pv._colors.isValid () )
+				return (nullptr) ;
+			if ( pv._colors.count () != nbVertices || pv._colors.components () < 3 )
+				return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Mesh '%s' COLOR_0 does not match POSITION", id.c_str ()), nullptr) ;
+			bColors =true ;
+		}
+		for ( int uv =0 ; attributes.isMember ("TEXCOORD_" + std::to_string (uv)) ; uv++ ) {
+			gltfAccessor uvs =ReadAccessor (idOf (attributes ["TEXCOORD_" + std::to_string (uv)])) ;
+			if ( !uvs.isValid () )
+				return (nullptr) ;
+			if ( uvs.count () != nbVertices || uvs.components () != 2 )
+				return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Mesh '%s' TEXCOORD_%d does not match POSITION", id.c_str (), uv), nullptr) ;
+			pv._uvs.push_back (uvs) ;
+		}
+		nbUVSets =std::max (nbUVSets, pv._uvs.size ()) ;
+		if ( primitive.isMember ("indices") ) {
+			pv._indices =ReadAccessor (idOf (primitive ["indices"])) ;
+			if ( !pv._indices.isValid () )
+				return (nullptr) ;
+			if ( pv._indices.components () != 1 )
+				return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Mesh '%s' indices are not SCALAR", id.c_str ()), nullptr) ;
+		}
+		size_t nbIndices =pv._indices.isValid () ? pv._indices.count () : nbVertices ;
+		pv._nbTriangles =pv._mode == IOglTF::TRIANGLES ? nbIndices / 3 : (nbIndices > 2 ? nbIndices - 2 : 0) ;
+		pv._materialIndex =-1 ;
+		if ( primitive.isMember ("material") ) {
+			pv._material =idOf (primitive ["material"]) ;
+			bMaterials =true ;
+		}
+		pv._base =nbControlPoints ;
+		pv._triangleBase =nbTriangles ;
+		nbControlPoints +=nbVertices ;
+		nbTriangles +=pv._nbTriangles ;
+		views.push_back (pv) ;
+	}
+	if ( nbControlPoints > (size_t)std::numeric_limits<int>::max () || nbTriangles * 3 > (size_t)std::numeric_limits<int>::max () )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Mesh '%s' is too large for FBX", id.c_str ()), nullptr) ;
+
+	// Materials, primitives without one get the default material if the others have one
+	std::vector<FbxSurfaceMaterial *> &materials =_meshMaterials [id] ;
+	if ( bMaterials ) {
+		for ( gltfPrimitiveViews &pv : views ) {
+			FbxSurfaceMaterial *pMaterial =ReadMaterial (pv._material) ;
+			if ( pMaterial == nullptr )
+				return (nullptr) ;
+			auto it =std::find (materials.begin (), materials.end (), pMaterial) ;
+			pv._materialIndex =(int)(it - materials.begin ()) ;
+			if ( it == materials.end () )
+				materials.push_back (pMaterial) ;
+		}
+	}
+
+	FbxMesh *pMesh =FbxMesh::Create (_pScene, meshDef.get ("name", id).asString ().c_str ()) ;
+	job->_pMesh =pMesh ;
+	job->_nbTriangles =nbTriangles ;
+	pMesh->InitControlPoints ((int)nbControlPoints) ;
+	job->_pControlPoints =pMesh->GetControlPoints () ;
+
+	// Layer elements are by control point and direct, so the glTF vertices map 1 to 1 and the arrays are
+	// written in place. They stay locked until BuildMeshes () is done with them.
+	if ( bNormals ) {
+		job->_pElementNormals =pMesh->CreateElementNormal () ;
+		job->_pElementNormals->SetMappingMode (FbxGeometryElement::eByControlPoint) ;
+		job->_pElementNormals->SetReferenceMode (FbxGeometryElement::eDirect) ;
+		job->_pElementNormals->GetDirectArray ().SetCount ((int)nbControlPoints) ;
+		job->_pNormals =job->_pElementNormals->GetDirectArray ().GetLocked (FbxLayerElementArray::eWriteLock) ;
+	}
+	if ( bColors ) {
+		job->_pElementColors =pMesh->CreateElementVertexColor () ;
+		job->_pElementColors->SetMappingMode (FbxGeometryElement::eByControlPoint) ;
+		job->_pElementColors->SetReferenceMode (FbxGeometryElement::eDirect) ;
+		job->_pElementColors->GetDirectArray ().SetCount ((int)nbControlPoints) ;
+		job->_pColors =job->_pElementColors->GetDirectArray ().GetLocked (FbxLayerElementArray::eWriteLock) ;
+	}
+	for ( size_t uv =0 ; uv < nbUVSets ; uv++ ) {
+		FbxGeometryElementUV *pElementUV =pMesh->CreateElementUV (("TEXCOORD_" + std::to_string (uv)).c_str ()) ;
+		pElementUV->SetMappingMode (FbxGeometryElement::eByControlPoint) ;
+		pElementUV->SetReferenceMode (FbxGeometryElement::eDirect) ;
+		pElementUV->GetDirectArray ().SetCount ((int)nbControlPoints) ;
+		job->_elementUVs.push_back (pElementUV) ;
+		job->_uvs.push_back (pElementUV->GetDirectArray ().GetLocked (FbxLayerElementArray::eWriteLock)) ;
+	}
+	if ( bMaterials ) {
+		FbxGeometryElementMaterial *pElementMaterials =pMesh->CreateElementMaterial () ;
+		pElementMaterials->SetMappingMode (FbxGeometryElement::eByPolygon) ;
+		pElementMaterials->SetReferenceMode (FbxGeometryElement::eIndexToDirect) ;
+	}
+	job->_polygonVertices.resize (nbTriangles * 3) ;
+
+	_meshJobs.push_back (job) ;
+	return (_meshes [id] =pMesh) ;
+}
+
+// Decodes the accessors of every mesh on the thread pool, then adds the polygons serially. The decoded
+// values do not depend on the job order, so the result is the same as a single threaded import.
+bool gltfReader::BuildMeshes (bool bDecode) {
+	if ( bDecode ) {
+		gltfStats::scope phase (_stats, "DecodeMeshes") ;
+		for ( const std::shared_ptr<meshJob> &job : _meshJobs ) {
+			for ( const gltfPrimitiveViews &pv : job->_views ) {
+				meshJob *pJob =job.get () ;
+				const gltfPrimitiveViews *pViews =&pv ;
+				for ( size_t begin =0 ; begin < pv._positions.count () ; begin +=sChunkSize ) {
+					size_t end =std::min (begin + sChunkSize, pv._positions.count ()) ;
+					_pool.submit ([pJob, pViews, begin, end] () { decodeVertices (*pJob, *pViews, begin, end) ; }) ;
+				}
+				for ( size_t begin =0 ; begin < pv._nbTriangles ; begin +=sChunkSize ) {
+					size_t end =std::min (begin + sChunkSize, pv._nbTriangles) ;
+					_pool.submit ([pJob, pViews, begin, end] () { decodeTriangles (*pJob, *pViews, begin, end) ; }) ;
+				}
+			}
+		}
+		_pool.wait () ;
+	}
+
+	gltfStats::scope phase (_stats, "BuildPolygons") ;
+	bool bRet =bDecode ;
+	for ( const std::shared_ptr<meshJob> &job : _meshJobs ) {
+		if ( job->_pNormals )
+			job->_pElementNormals->GetDirectArray ().Release (&job->_pNormals) ;
+		if ( job->_pColors )
+			job->_pElementColors->GetDirectArray ().Release (&job->_pColors) ;
+		for ( size_t uv =0 ; uv < job->_uvs.size () ; uv++ )
+			job->_elementUVs [uv]->GetDirectArray ().Release (&job->_uvs [uv]) ;
+		if ( !bRet )
+			continue ;
+		if ( job->_bFailed ) {
+			GetStatus ().SetCode (FbxStatus::eInvalidFile, "Mesh '%s' has an index out of range", job->_id.c_str ()) ;
+			bRet =false ;
+			continue ;
+		}
+
+		FbxMesh *pMesh =job->_pMesh ;
+		_stats.count ("vertices", pMesh->GetControlPointsCount ()) ;
+		_stats.count ("triangles", job->_nbTriangles) ;
+		pMesh->ReservePolygonCount ((int)job->_nbTriangles) ;
+		pMesh->ReservePolygonVertexCount ((int)job->_nbTriangles * 3) ;
+		const int *pVertices =job->_polygonVertices.data () ;
+		for ( const gltfPrimitiveViews &pv : job->_views ) {
+			for ( size_t t =0 ; t < pv._nbTriangles ; t++ ) {
+				pMesh->BeginPolygon (pv._materialIndex) ;
+				pMesh->AddPolygon (*pVertices++) ;
+				pMesh->AddPolygon (*pVertices++) ;
+				pMesh->AddPolygon (*pVertices++) ;
+				pMesh->EndPolygon () ;
+			}
+		}
+		std::vector<int> ().swap (job->_polygonVertices) ;
+	}
+	_meshJobs.clear () ;
+	return (bRet) ;
+}
+
+//-----------------------------------------------------------------------------
+
+}
@@ -23,11 +23,20 @@
 
 namespace _IOglTF_NS_ {
 
+static const Json::Value sNullValue ;
+
+static uint32_t readUInt32 (const uint8_t *p) {
+	uint32_t v ;
+	memcpy (&v, p, sizeof (v)) ;
+	return (v) ;
+}
+
 //-----------------------------------------------------------------------------
-gltfReader::gltfReader (FbxManager &pManager, int pID) : FbxReader(pManager, pID, FbxStatusGlobal::GetRef ()) {
+gltfReader::gltfReader (FbxManager &pManager, int pID) : FbxReader(pManager, pID, FbxStatusGlobal::GetRef ()), _glbBody (nullptr), _glbBodySize (0), _pScene (nullptr) {
 }
 
 gltfReader::~gltfReader () {
+	FileClose () ;
 }
 
 void gltfReader::GetVersion (int &pMajor, int &pMinor, int &pRevision) {
@@ -37,27 +46,148 @@ void gltfReader::GetVersion (int &pMajor, int &pMinor, int &pRevision) {
 }
 
 bool gltfReader::FileOpen (char *pFileName) {
-	_in.open (pFileName, std::ios::in) ;
-	return (IsFileOpen ()) ;
+	FileClose () ;
+	FbxString fileName =FbxPathUtils::Clean (pFileName) ;
+	_fileName =fileName.Buffer () ;
+	_path =FbxPathUtils::GetFolderName (fileName).Buffer () ;
+	if ( !_file.open (_fileName) )
+		return (GetStatus ().SetCode (FbxStatus::eFailure, "Cannot open file %s", _fileName.c_str ()), false) ;
+	_stats.reset (
+		!GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_STATSFILE, FbxString ("")).IsEmpty (),
+		!GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_TRACEFILE, FbxString ("")).IsEmpty ()
+	) ;
+	_stats.count ("fileBytes", _file.size ()) ;
+
+	gltfStats::scope phase (_stats, "Parse") ;
+	bool bRet =_file.size () >= 12 && memcmp (_file.data (), "glTF", 4) == 0 ?
+		  ParseGLB ()
+		: ParseJson ((const char *)_file.data (), (const char *)_file.data () + _file.size ()) ;
+	if ( !bRet )
+		FileClose () ;
+	return (bRet) ;
 }
+
 bool gltfReader::FileClose () {
-	_in.close () ;
+	ResetScene () ;
+	_buffers.clear () ;
+	_json =Json::Value () ;
+	_glbBody =nullptr ;
+	_glbBodySize =0 ;
+	_file.close () ;
 	return (true) ;
 }
 
 bool gltfReader::IsFileOpen () {
-	return (_in.is_open ()) ;
+	return (_file.isOpen ()) ;
 }
 
 bool gltfReader::GetReadOptions (bool pParseFileAsNeeded) {
 	return (true) ;
 }
 
+bool gltfReader::ParseJson (const char *pBegin, const char *pEnd) {
+	Json::Features features ;
+	features.allowComments_ =false ;
+	features.strictRoot_ =true ;
+	Json::Reader reader (features) ;
+	if ( !reader.parse (pBegin, pEnd, _json, false) || !_json.isObject () )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Invalid glTF JSON in %s: %s", _fileName.c_str (), reader.getFormattedErrorMessages ().c_str ()), false) ;
+	return (true) ;
+}
+
+// Binary glTF: version 1 is the KHR_binary_glTF container (20 bytes header, JSON content, binary body),
+// version 2 is made of JSON and BIN chunks. The body is used in place from the mapped file.
+bool gltfReader::ParseGLB () {
+	const uint8_t *p =_file.data () ;
+	uint32_t version =readUInt32 (p + 4) ;
+	size_t length =readUInt32 (p + 8) ;
+	if ( length > _file.size () )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Truncated GLB file %s", _fileName.c_str ()), false) ;
+	if ( version == 1 ) {
+		if ( length < 20 )
+			return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Invalid GLB header in %s", _fileName.c_str ()), false) ;
+		size_t contentLength =readUInt32 (p + 12) ;
+		uint32_t contentFormat =readUInt32 (p + 16) ;
+		if ( contentFormat != 0 || 20 + contentLength > length )
+			return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Invalid GLB content in %s", _fileName.c_str ()), false) ;
+		_glbBody =p + 20 + contentLength ;
+		_glbBodySize =length - 20 - contentLength ;
+		return (ParseJson ((const char *)p + 20, (const char *)p + 20 + contentLength)) ;
+	}
+	if ( version != 2 )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFileVersion, "Unsupported GLB version %d in %s", (int)version, _fileName.c_str ()), false) ;
+
+	const char *pJsonBegin =nullptr, *pJsonEnd =nullptr ;
+	for ( size_t offset =12 ; offset + 8 <= length ; ) {
+		size_t chunkLength =readUInt32 (p + offset) ;
+		uint32_t chunkType =readUInt32 (p + offset + 4) ;
+		const uint8_t *pChunk =p + offset + 8 ;
+		if ( chunkLength > length - offset - 8 )
+			return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Invalid GLB chunk in %s", _fileName.c_str ()), false) ;
+		if ( chunkType == 0x4E4F534A && pJsonBegin == nullptr ) { // JSON
+			pJsonBegin =(const char *)pChunk ;
+			pJsonEnd =pJsonBegin + chunkLength ;
+		} else if ( chunkType == 0x004E4942 && _glbBody == nullptr ) { // BIN
+			_glbBody =pChunk ;
+			_glbBodySize =chunkLength ;
+		}
+		offset +=8 + chunkLength ;
+	}
+	if ( pJsonBegin == nullptr )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "No JSON chunk in %s", _fileName.c_str ()), false) ;
+	return (ParseJson (pJsonBegin, pJsonEnd)) ;
+}
+
+void gltfReader::ResetScene () {
+	_pScene =nullptr ;
+	_meshes.clear () ;
+	_meshMaterials.clear () ;
+	_materials.clear () ;
+	_textures.clear () ;
+	_cameras.clear () ;
+	_visiting.clear () ;
+	_meshJobs.clear () ;
+}
+
 bool gltfReader::Read (FbxDocument *pDocument) {
 	FbxScene *pScene =FbxCast<FbxScene> (pDocument) ;
+	if ( pScene == nullptr || !IsFileOpen () )
+		return (GetStatus ().SetCode (FbxStatus::eFailure, "Invalid document or no glTF file open"), false) ;
+	ResetScene () ;
+	_pScene =pScene ;
+
+	// glTF is Y up, right handed and in meters
+	pScene->GetGlobalSettings ().SetAxisSystem (FbxAxisSystem::OpenGL) ;
+	pScene->GetGlobalSettings ().SetSystemUnit (FbxSystemUnit::m) ;
+
+	// The scene graph is built serially, meshes only get their FBX arrays allocated at this stage.
+	// The accessors are then decoded in parallel into those arrays, and the polygons are added last.
 	FbxNode *pRoot =pScene->GetRootNode () ;
+	bool bRet =true ;
+	{
+		gltfStats::scope phase (_stats, "ReadScene") ;
+		for ( const std::string &id : RootNodes () ) {
+			FbxNode *pNode =ReadNode (id) ;
+			if ( pNode == nullptr ) {
+				bRet =false ;
+				break ;
+			}
+			pRoot->AddChild (pNode) ;
+		}
+	}
+	bRet =BuildMeshes (bRet) && bRet ;
+	ResetScene () ;
 
-	return (true) ;
+	if ( _stats.enabled () ) {
+		FbxString statsFile =GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_STATSFILE, FbxString ("")) ;
+		if ( !statsFile.IsEmpty () && !_stats.save (statsFile.Buffer ()) )
+			std::cout << "Warning: cannot write the statistics file " << statsFile.Buffer () << std::endl ;
+		FbxString traceFile =GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_TRACEFILE, FbxString ("")) ;
+		if ( _stats.tracing () && !_stats.saveTrace (traceFile.Buffer (), true) )
+			std::cout << "Warning: cannot write the trace file " << traceFile.Buffer () << std::endl ;
+		_stats.reset (false) ;
+	}
+	return (bRet) ;
 }
 
 // Creates a gltfReader in the Sdk Manager
@@ -84,6 +214,272 @@ bool gltfReader::Read (FbxDocument *pDocument) {
 	// Example at: http://help.autodesk.com/view/FBX/2015/ENU/?guid=__files_GUID_75CD0DC4_05C8_4497_AC6E_EA11406EAE26_htm
 }
 
+//-----------------------------------------------------------------------------
+/*static*/ std::string gltfReader::idOf (const Json::Value &id) {
+	if ( id.isString () )
+		return (id.asString ()) ;
+	if ( id.isIntegral () )
+		return (std::to_string (id.asLargestInt ())) ;
+	return (std::string ()) ;
+}
+
+const Json::Value &gltfReader::object (const char *pszCollection, const std::string &id) const {
+	const Json::Value &collection =_json [pszCollection] ;
+	if ( collection.isObject () )
+		return (collection.isMember (id) ? collection [id] : sNullValue) ;
+	if ( collection.isArray () && !id.empty () && id.find_first_not_of ("0123456789") == std::string::npos ) {
+		Json::ArrayIndex index =(Json::ArrayIndex)strtoul (id.c_str (), nullptr, 10) ;
+		return (index < collection.size () ? collection [index] : sNullValue) ;
+	}
+	return (sNullValue) ;
+}
+
+/*static*/ std::vector<std::string> gltfReader::idsOf (const Json::Value &list) {
+	std::vector<std::string> ids ;
+	if ( list.isArray () ) {
+		for ( Json::ArrayIndex i =0 ; i < list.size () ; i++ )
+			ids.push_back (idOf (list [i])) ;
+	} else if ( !list.isNull () ) {
+		ids.push_back (idOf (list)) ;
+	}
+	return (ids) ;
+}
+
+std::string gltfReader::ResolveUri (const std::string &uri) const {
+	// Relative uris are percent encoded
+	std::string path ;
+	path.reserve (uri.size ()) ;
+	for ( size_t i =0 ; i < uri.size () ; i++ ) {
+		if ( uri [i] == '%' && i + 2 < uri.size () && isxdigit ((unsigned char)uri [i + 1]) && isxdigit ((unsigned char)uri [i + 2]) ) {
+			path +=(char)strtol (uri.substr (i + 1, 2).c_str (), nullptr, 16) ;
+			i +=2 ;
+		} else {
+			path +=uri [i] ;
+		}
+	}
+	if ( !FbxPathUtils::IsRelative (path.c_str ()) )
+		return (path) ;
+	return (FbxPathUtils::Bind (_path.c_str (), path.c_str ()).Buffer ()) ;
+}
+
+//-----------------------------------------------------------------------------
+const gltfReader::buffer *gltfReader::ReadBuffer (const std::string &id) {
+	auto iter =_buffers.find (id) ;
+	if ( iter != _buffers.end () )
+		return (&iter->second) ;
+
+	const Json::Value &bufferDef =object ("buffers", id) ;
+	if ( bufferDef.isNull () )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Buffer '%s' not found", id.c_str ()), nullptr) ;
+	buffer buf ;
+	std::string uri =bufferDef.get ("uri", "").asString () ;
+	if ( id == "binary_glTF" || (uri.empty () && _glbBody) ) {
+		// KHR_binary_glTF body, or the GLB BIN chunk
+		buf._data =_glbBody ;
+		buf._size =_glbBodySize ;
+	} else if ( uri.compare (0, 5, "data:") == 0 ) {
+		size_t pos =uri.find (',') ;
+		if ( pos == std::string::npos || uri.rfind (";base64", pos) == std::string::npos
+			|| !base64Decode (uri.c_str () + pos + 1, uri.size () - pos - 1, buf._bytes)
+		)
+			return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Buffer '%s' has an invalid data uri", id.c_str ()), nullptr) ;
+		buf._data =buf._bytes.data () ;
+		buf._size =buf._bytes.size () ;
+	} else {
+		std::string fileName =ResolveUri (uri) ;
+		buf._file =std::make_shared<memoryMappedFile> () ;
+		if ( !buf._file->open (fileName) )
+			return (GetStatus ().SetCode (FbxStatus::eFailure, "Cannot open buffer file %s", fileName.c_str ()), nullptr) ;
+		buf._data =buf._file->data () ;
+		buf._size =buf._file->size () ;
+	}
+	size_t byteLength =(size_t)bufferDef.get ("byteLength", (Json::UInt64)buf._size).asUInt64 () ;
+	if ( byteLength > buf._size || (buf._data == nullptr && byteLength != 0) )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Buffer '%s' is shorter than its byteLength", id.c_str ()), nullptr) ;
+	buf._size =byteLength ;
+	// The vector storage (data uris) does not move when the record is moved into the map
+	return (&(_buffers [id] =std::move (buf))) ;
+}
+
+bool gltfReader::ReadBufferView (const std::string &id, const uint8_t *&data, size_t &size, size_t &stride) {
+	const Json::Value &viewDef =object ("bufferViews", id) ;
+	if ( viewDef.isNull () )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "BufferView '%s' not found", id.c_str ()), false) ;
+	const buffer *buf =ReadBuffer (idOf (viewDef ["buffer"])) ;
+	if ( buf == nullptr )
+		return (false) ;
+	size_t offset =(size_t)viewDef.get ("byteOffset", 0).asUInt64 () ;
+	size =(size_t)viewDef.get ("byteLength", (Json::UInt64)(buf->_size > offset ? buf->_size - offset : 0)).asUInt64 () ;
+	stride =(size_t)viewDef.get ("byteStride", 0).asUInt64 () ; // glTF 2.0
+	if ( offset > buf->_size || size > buf->_size - offset )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "BufferView '%s' is out of its buffer range", id.c_str ()), false) ;
+	data =buf->_data + offset ;
+	return (true) ;
+}
+
+gltfAccessor gltfReader::ReadAccessor (const std::string &id) {
+	const Json::Value &accessorDef =object ("accessors", id) ;
+	if ( accessorDef.isNull () )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Accessor '%s' not found", id.c_str ()), gltfAccessor ()) ;
+	unsigned int componentType =accessorDef.get ("componentType", 0).asUInt () ;
+	int components =gltfAccessor::componentCount (accessorDef.get ("type", "").asString ()) ;
+	size_t componentSize =gltfAccessor::componentSize (componentType) ;
+	size_t count =(size_t)accessorDef.get ("count", 0).asUInt64 () ;
+	if ( components == 0 || componentSize == 0 )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Accessor '%s' has an unsupported type", id.c_str ()), gltfAccessor ()) ;
+	if ( !accessorDef.isMember ("bufferView") ) {
+		// glTF 2.0 sparse-only accessors are not supported
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Accessor '%s' has no bufferView", id.c_str ()), gltfAccessor ()) ;
+	}
+	const uint8_t *data =nullptr ;
+	size_t size =0, viewStride =0 ;
+	if ( !ReadBufferView (idOf (accessorDef ["bufferView"]), data, size, viewStride) )
+		return (gltfAccessor ()) ;
+	size_t offset =(size_t)accessorDef.get ("byteOffset", 0).asUInt64 () ;
+	size_t elementSize =components * componentSize ;
+	size_t stride =(size_t)accessorDef.get ("byteStride", (Json::UInt64)viewStride).asUInt64 () ; // glTF 1.0
+	if ( stride == 0 )
+		stride =elementSize ;
+	if ( count && (offset > size || stride < elementSize || (count - 1) > (size - offset - elementSize) / stride || elementSize > size - offset) )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Accessor '%s' is out of its bufferView range", id.c_str ()), gltfAccessor ()) ;
+	return (gltfAccessor (data + offset, count, stride, componentType, components, accessorDef.get ("normalized", false).asBool ())) ;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<std::string> gltfReader::RootNodes () const {
+	const Json::Value &scene =_json ["scene"] ;
+	if ( !scene.isNull () ) {
+		const Json::Value &sceneDef =object ("scenes", idOf (scene)) ;
+		if ( !sceneDef.isNull () )
+			return (idsOf (sceneDef ["nodes"])) ;
+	}
+	// No default scene: every node which is not a child of another one
+	const Json::Value &nodes =_json ["nodes"] ;
+	std::vector<std::string> ids ;
+	if ( nodes.isObject () )
+		ids =nodes.getMemberNames () ;
+	else
+		for ( Json::ArrayIndex i =0 ; i < nodes.size () ; i++ )
+			ids.push_back (std::to_string (i)) ;
+	std::set<std::string> children ;
+	for ( const std::string &id : ids )
+		for ( const std::string &child : idsOf (object ("nodes", id) ["children"]) )
+			children.insert (child) ;
+	std::vector<std::string> roots ;
+	for ( const std::string &id : ids )
+		if ( children.find (id) == children.end () )
+			roots.push_back (id) ;
+	return (roots) ;
+}
+
+FbxNode *gltfReader::ReadNode (const std::string &id) {
+	const Json::Value &nodeDef =object ("nodes", id) ;
+	if ( nodeDef.isNull () )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Node '%s' not found", id.c_str ()), nullptr) ;
+	// A node can only have one parent, this also stops cycles
+	if ( !_visiting.insert (id).second )
+		return (GetStatus ().SetCode (FbxStatus::eInvalidFile, "Node '%s' is referenced more than once", id.c_str ()), nullptr) ;
+
+	std::string name =nodeDef.get ("name", id).asString () ;
+	FbxNode *pNode =FbxNode::Create (_pScene, name.c_str ()) ;
+	ReadTransform (pNode, nodeDef) ;
+
+	// glTF 1.0 nodes can instance several meshes, FBX nodes hold one attribute. Extra meshes go on child nodes.
+	std::vector<std::string> meshIds =idsOf (nodeDef.isMember ("meshes") ? nodeDef ["meshes"] : nodeDef ["mesh"]) ;
+	for ( size_t i =0 ; i < meshIds.size () ; i++ ) {
+		FbxMesh *pMesh =ReadMesh (meshIds [i]) ;
+		if ( pMesh == nullptr )
+			return (nullptr) ;
+		FbxNode *pMeshNode =pNode ;
+		if ( i > 0 ) {
+			pMeshNode =FbxNode::Create (_pScene, (name + "_" + meshIds [i]).c_str ()) ;
+			pNode->AddChild (pMeshNode) ;
+		}
+		pMeshNode->SetNodeAttribute (pMesh) ;
+		for ( FbxSurfaceMaterial *pMaterial : _meshMaterials [meshIds [i]] )
+			pMeshNode->AddMaterial (pMaterial) ;
+	}
+
+	if ( nodeDef.isMember ("camera") ) {
+		FbxCamera *pCamera =ReadCamera (idOf (nodeDef ["camera"])) ;
+		if ( pCamera && meshIds.size () ) {
+			FbxNode *pCameraNode =FbxNode::Create (_pScene, (name + "_camera").c_str ()) ;
+			pCameraNode->SetNodeAttribute (pCamera) ;
+			pNode->AddChild (pCameraNode) ;
+		} else if ( pCamera ) {
+			pNode->SetNodeAttribute (pCamera) ;
+		}
+	}
+
+	for ( const std::string &child : idsOf (nodeDef ["children"]) ) {
+		FbxNode *pChild =ReadNode (child) ;
+		if ( pChild == nullptr )
+			return (nullptr) ;
+		pNode->AddChild (pChild) ;
+	}
+	return (pNode) ;
+}
+
+void gltfReader::ReadTransform (FbxNode *pNode, const Json::Value &nodeDef) {
+	FbxAMatrix matrix ;
+	const Json::Value &m =nodeDef ["matrix"] ;
+	if ( m.isArray () && m.size () == 16 ) {
+		// Column-major, i.e. the FBX row layout (see gltfWriter::GetTransform)
+		FbxAMatrix::kDouble44 &r =matrix.Double44 () ;
+		for ( int i =0 ; i < 4 ; i++ )
+			for ( int j =0 ; j < 4 ; j++ )
+				r [i] [j] =m [i * 4 + j].asDouble () ;
+	} else {
+		const Json::Value &t =nodeDef ["translation"], &r =nodeDef ["rotation"], &s =nodeDef ["scale"] ;
+		FbxVector4 translation (0., 0., 0.), scale (1., 1., 1.) ;
+		FbxQuaternion rotation (0., 0., 0., 1.) ;
+		for ( int i =0 ; i < 3 ; i++ ) {
+			if ( t.isArray () && t.size () == 3 )
+				translation [i] =t [i].asDouble () ;
+			if ( s.isArray () && s.size () == 3 )
+				scale [i] =s [i].asDouble () ;
+		}
+		if ( r.isArray () && r.size () == 4 ) // x, y, z, w in both glTF and FBX
+			rotation =FbxQuaternion (r [0].asDouble (), r [1].asDouble (), r [2].asDouble (), r [3].asDouble ()) ;
+		matrix.SetTQS (translation, rotation, scale) ;
+	}
+	pNode->LclTranslation.Set (FbxDouble3 (matrix.GetT ())) ;
+	pNode->LclRotation.Set (FbxDouble3 (matrix.GetR ())) ;
+	pNode->LclScaling.Set (FbxDouble3 (matrix.GetS ())) ;
+}
+
+FbxCamera *gltfReader::ReadCamera (const std::string &id) {
+	auto iter =_cameras.find (id) ;
+	if ( iter != _cameras.end () )
+		return (iter->second) ;
+	const Json::Value &cameraDef =object ("cameras", id) ;
+	if ( cameraDef.isNull () ) {
+		std::cout << "Warning: camera '" << id << "' not found" << std::endl ;
+		return (_cameras [id] =nullptr) ;
+	}
+	FbxCamera *pCamera =FbxCamera::Create (_pScene, cameraDef.get ("name", id).asString ().c_str ()) ;
+	if ( cameraDef ["type"].asString () == "orthographic" ) {
+		const Json::Value &def =cameraDef ["orthographic"] ;
+		pCamera->ProjectionType.Set (FbxCamera::eOrthogonal) ;
+		pCamera->OrthoZoom.Set (def.get ("ymag", 1.).asDouble ()) ;
+		pCamera->NearPlane.Set (def.get ("znear", 0.1).asDouble ()) ;
+		pCamera->FarPlane.Set (def.get ("zfar", 1000.).asDouble ()) ;
+	} else {
+		const Json::Value &def =cameraDef ["perspective"] ;
+		double yfov =def.get ("yfov", 0.8).asDouble () ;
+		if ( !GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_ANGLEINDEGREE, false) )
+			yfov *=FBXSDK_180_DIV_PI ;
+		pCamera->ProjectionType.Set (FbxCamera::ePerspective) ;
+		pCamera->SetApertureMode (FbxCamera::eVertical) ;
+		pCamera->FieldOfView.Set (yfov) ;
+		if ( def.isMember ("aspectRatio") )
+			pCamera->FilmAspectRatio.Set (def ["aspectRatio"].asDouble ()) ;
+		pCamera->NearPlane.Set (def.get ("znear", 0.1).asDouble ()) ;
+		pCamera->FarPlane.Set (def.get ("zfar", 1000.).asDouble ()) ; // glTF 2.0 infinite projection
+	}
+	return (_cameras [id] =pCamera) ;
+}
+
 //-----------------------------------------------------------------------------
 
 }
@@ -20,14 +20,49 @@
 //
 #pragma once
 
+#include "jsoncpp/json.h"
+#include "threadPool.h"
+#include <set>
+
 namespace _IOglTF_NS_ {
 
 class gltfReader : public FbxReader {
+public:
+	// A mesh which FBX arrays are allocated, waiting for its accessors to be decoded (see gltfReader-Mesh.cpp)
+	struct meshJob ;
 
 private:
-	std::wifstream _in ;
+	// Bytes of a glTF buffer: a memory mapped .bin file, the GLB binary body, or a decoded data URI
+	struct buffer {
+		const uint8_t *_data ;
+		size_t _size ;
+		std::shared_ptr<memoryMappedFile> _file ;
+		std::vector<uint8_t> _bytes ;
+		buffer () : _data (nullptr), _size (0) {}
+	} ;
+
+private:
+	std::string _fileName ;
+	std::string _path ;
+	memoryMappedFile _file ;
+	Json::Value _json ;
+	const uint8_t *_glbBody ;
+	size_t _glbBodySize ;
 	//FbxManager*	mManager ;
 
+	FbxScene *_pScene ;
+	std::map<std::string, buffer> _buffers ;
+	std::map<std::string, FbxMesh *> _meshes ;
+	std::map<std::string, std::vector<FbxSurfaceMaterial *> > _meshMaterials ;
+	std::map<std::string, FbxSurfaceMaterial *> _materials ;
+	std::map<std::string, FbxFileTexture *> _textures ;
+	std::map<std::string, FbxCamera *> _cameras ;
+	std::set<std::string> _visiting ;
+	std::vector<std::shared_ptr<meshJob> > _meshJobs ;
+	threadPool _pool ;
+	// Per phase wall time, only collected when IOSN_FBX_GLTF_STATSFILE names a report file
+	gltfStats _stats ;
+
 public:
 	gltfReader (FbxManager &pManager, int pID) ;
 	virtual ~gltfReader () ;
@@ -44,6 +79,35 @@ public:
 	static void FillIOSettings (FbxIOSettings &pIOS) ;
 
 protected:
+	bool ParseJson (const char *pBegin, const char *pEnd) ;
+	bool ParseGLB () ;
+	void ResetScene () ;
+
+	// glTF 1.0 uses string ids and dictionaries, glTF 2.0 uses indices and arrays
+	static std::string idOf (const Json::Value &id) ;
+	const Json::Value &object (const char *pszCollection, const std::string &id) const ;
+	static std::vector<std::string> idsOf (const Json::Value &list) ;
+	std::string ResolveUri (const std::string &uri) const ;
+
+	// Buffers
+	const buffer *ReadBuffer (const std::string &id) ;
+	bool ReadBufferView (const std::string &id, const uint8_t *&data, size_t &size, size_t &stride) ;
+	gltfAccessor ReadAccessor (const std::string &id) ;
+
+	// Scene
+	std::vector<std::string> RootNodes () const ;
+	FbxNode *ReadNode (const std::string &id) ;
+	void ReadTransform (FbxNode *pNode, const Json::Value &nodeDef) ;
+	FbxCamera *ReadCamera (const std::string &id) ;
+
+	// Mesh
+	FbxMesh *ReadMesh (const std::string &id) ;
+	bool BuildMeshes (bool bDecode) ;
+
+	// Material
+	FbxSurfaceMaterial *ReadMaterial (const std::string &id) ;
+	FbxFileTexture *ReadTexture (const std::string &id, const char *pszUVSet) ;
+	void ReadColor (FbxPropertyT<FbxDouble3> &prop, FbxPropertyT<FbxDouble> &factor, const Json::Value &value, const std::string &uvSet) ;
 
 } ;
 
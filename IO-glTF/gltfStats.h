@@ -0,0 +1,228 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <fstream>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <stdint.h>
+#include "jsoncpp/json.h"
+#include "gltfMemory.h"
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfStats
+// Abstraction : Wall time per conversion phase and a few counters. Phases can nest (WriteMesh includes
+//               WriteMaterial) and accumulate over all their calls. While disabled, a scope only costs
+//               a test, so they can stay in the hot paths.
+//               When tracing, every scope is also recorded as a Chrome trace event (chrome://tracing)
+//               with its own arguments. Scopes must be opened from the converting thread only.
+//               If the application hooks the heap (gltfMemory), phases also report their allocations,
+//               peak and retained heap bytes. Named gauges keep the largest size seen of explicitly
+//               accounted containers (e.g. the binary stream or the JSON document).
+class gltfStats {
+	struct phase {
+		double _seconds ;
+		uint64_t _calls ;
+		int64_t _peakBytes ;
+		int64_t _retainedBytes ;
+		uint64_t _allocations ;
+	} ;
+	struct event {
+		std::string _name ;
+		int64_t _start ; // microseconds
+		int64_t _duration ;
+		Json::Value _args ;
+	} ;
+	std::map<std::string, phase> _phases ;
+	std::map<std::string, uint64_t> _counters ;
+	std::map<std::string, uint64_t> _gauges ;
+	std::vector<event> _events ;
+	bool _bEnabled ;
+	bool _bTrace ;
+
+public:
+	class scope {
+		gltfStats *_pStats ;
+		const char *_pszPhase ;
+		std::chrono::steady_clock::time_point _start ;
+		Json::Value _args ;
+		gltfMemoryCounters *_pMemory ;
+		int64_t _live, _outerPeak ;
+		uint64_t _allocations ;
+
+	public:
+		scope (gltfStats &stats, const char *pszPhase) : _pStats (stats.enabled () ? &stats : nullptr), _pszPhase (pszPhase), _pMemory (nullptr) {
+			if ( _pStats == nullptr )
+				return ;
+			if ( (_pMemory =gltfMemory::counters ()) != nullptr ) {
+				_live =_pMemory->_live.load () ;
+				_allocations =_pMemory->_allocations.load () ;
+				_outerPeak =gltfMemory::beginPeak (_pMemory) ;
+			}
+			_start =std::chrono::steady_clock::now () ;
+		}
+		~scope () {
+			if ( _pStats == nullptr )
+				return ;
+			std::chrono::steady_clock::time_point end =std::chrono::steady_clock::now () ;
+			phase &p =_pStats->add (_pszPhase, std::chrono::duration<double> (end - _start).count ()) ;
+			if ( _pMemory ) {
+				int64_t peak =gltfMemory::endPeak (_pMemory, _outerPeak) ;
+				p._peakBytes =std::max (p._peakBytes, peak) ;
+				p._retainedBytes +=_pMemory->_live.load () - _live ;
+				p._allocations +=_pMemory->_allocations.load () - _allocations ;
+				if ( _pStats->tracing () )
+					_args ["peakBytes"] =(Json::Int64)peak ;
+			}
+			if ( _pStats->tracing () )
+				_pStats->record (_pszPhase, _start, end, _args) ;
+		}
+
+		// Only kept when tracing
+		void arg (const char *pszName, const Json::Value &value) {
+			if ( _pStats && _pStats->tracing () )
+				_args [pszName] =value ;
+		}
+	} ;
+
+	gltfStats (bool bEnabled =false, bool bTrace =false) : _bEnabled (bEnabled || bTrace), _bTrace (bTrace) {}
+
+	void reset (bool bEnabled, bool bTrace =false) {
+		_phases.clear () ;
+		_counters.clear () ;
+		_gauges.clear () ;
+		_events.clear () ;
+		_bEnabled =bEnabled || bTrace ;
+		_bTrace =bTrace ;
+	}
+	bool enabled () const { return (_bEnabled) ; }
+	bool tracing () const { return (_bTrace) ; }
+
+	phase &add (const std::string &name, double seconds) {
+		auto iter =_phases.find (name) ;
+		if ( iter == _phases.end () ) {
+			phase p ={ 0., 0, 0, 0, 0 } ;
+			iter =_phases.insert (std::make_pair (name, p)).first ;
+		}
+		iter->second._seconds +=seconds ;
+		iter->second._calls++ ;
+		return (iter->second) ;
+	}
+	void count (const std::string &name, uint64_t value) {
+		if ( _bEnabled )
+			_counters [name] +=value ;
+	}
+	void gauge (const std::string &name, uint64_t bytes) {
+		if ( _bEnabled )
+			_gauges [name] =std::max (_gauges [name], bytes) ;
+	}
+	void record (const char *pszName, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, const Json::Value &args) {
+		event e ={
+			pszName,
+			std::chrono::duration_cast<std::chrono::microseconds> (start.time_since_epoch ()).count (),
+			std::chrono::duration_cast<std::chrono::microseconds> (end - start).count (),
+			args
+		} ;
+		_events.push_back (e) ;
+	}
+	double seconds (const std::string &name) const {
+		auto iter =_phases.find (name) ;
+		return (iter == _phases.end () ? 0. : iter->second._seconds) ;
+	}
+
+	// { "phases": { "<name>": { "seconds": s, "calls": n [, "peakBytes": b, "retainedBytes": b, "allocations": n] } },
+	//   "counters": { "<name>": n }, "memory": { "<name>": bytes } }
+	Json::Value json () const {
+		Json::Value ret ;
+		ret ["phases"] =Json::Value (Json::objectValue) ;
+		ret ["counters"] =Json::Value (Json::objectValue) ;
+		ret ["memory"] =Json::Value (Json::objectValue) ;
+		bool bMemory =gltfMemory::counters () != nullptr ;
+		for ( const auto &iter : _phases ) {
+			Json::Value &phaseDef =ret ["phases"] [iter.first] ;
+			phaseDef ["seconds"] =iter.second._seconds ;
+			phaseDef ["calls"] =(Json::UInt64)iter.second._calls ;
+			if ( bMemory ) {
+				phaseDef ["peakBytes"] =(Json::Int64)iter.second._peakBytes ;
+				phaseDef ["retainedBytes"] =(Json::Int64)iter.second._retainedBytes ;
+				phaseDef ["allocations"] =(Json::UInt64)iter.second._allocations ;
+			}
+		}
+		for ( const auto &iter : _counters )
+			ret ["counters"] [iter.first] =(Json::UInt64)iter.second ;
+		for ( const auto &iter : _gauges )
+			ret ["memory"] [iter.first] =(Json::UInt64)iter.second ;
+		return (ret) ;
+	}
+	bool save (const std::string &fileName) const {
+		std::ofstream out (fileName, std::ios::out | std::ios::trunc) ;
+		if ( !out.is_open () )
+			return (false) ;
+		Json::StyledWriter writer ;
+		out << writer.write (json ()) ;
+		return (out.good ()) ;
+	}
+	// Complete ("X") events of the Chrome trace event format. The steady clock is shared by the plug-in
+	// and the application, so their traces can go in the same file (bAppend) and line up.
+	bool saveTrace (const std::string &fileName, bool bAppend) const {
+		Json::Value trace ;
+		if ( !bAppend || !load (fileName, trace) || !trace ["traceEvents"].isArray () ) {
+			trace =Json::Value (Json::objectValue) ;
+			trace ["traceEvents"] =Json::Value (Json::arrayValue) ;
+			trace ["displayTimeUnit"] ="ms" ;
+		}
+		Json::Value &events =trace ["traceEvents"] ;
+		Json::Int64 tid =(Json::Int64)(std::hash<std::thread::id> () (std::this_thread::get_id ()) & 0x7fffffff) ;
+		for ( const event &e : _events ) {
+			Json::Value eventDef ;
+			eventDef ["name"] =e._name ;
+			eventDef ["cat"] ="glTF" ;
+			eventDef ["ph"] ="X" ;
+			eventDef ["ts"] =(Json::Int64)e._start ;
+			eventDef ["dur"] =(Json::Int64)e._duration ;
+			eventDef ["pid"] =1 ;
+			eventDef ["tid"] =tid ;
+			if ( !e._args.isNull () )
+				eventDef ["args"] =e._args ;
+			events.append (eventDef) ;
+		}
+		std::ofstream out (fileName, std::ios::out | std::ios::trunc) ;
+		if ( !out.is_open () )
+			return (false) ;
+		Json::FastWriter writer ;
+		out << writer.write (trace) ;
+		return (out.good ()) ;
+	}
+	static bool load (const std::string &fileName, Json::Value &stats) {
+		std::ifstream in (fileName, std::ios::in) ;
+		Json::Reader reader ;
+		return (in.is_open () && reader.parse (in, stats, false)) ;
+	}
+
+} ;
+
+}
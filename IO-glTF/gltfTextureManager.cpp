@@ -0,0 +1,294 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfTextureManager.h"
+#include "gltfHash.h"
+#include <algorithm>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <stdlib.h>
+#elif defined(__APPLE__)
+#include <stdlib.h>
+#include <copyfile.h>
+#else
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/fs.h> // for FICLONE
+#endif
+#endif
+
+namespace _IOglTF_NS_ {
+
+//-----------------------------------------------------------------------------
+void gltfTextureManager::wait () {
+	for ( auto &job : _pending )
+		job.wait () ;
+	_pending.clear () ;
+}
+
+void gltfTextureManager::reset (const std::string &outputFolder, bool bCopy, bool bEmbed) {
+	wait () ;
+	_assets.clear () ;
+	_byPath.clear () ;
+	_byContent.clear () ;
+	_targets.clear () ;
+	_folder =outputFolder ;
+#if defined(_WIN32) || defined(_WIN64)
+	if ( !_folder.empty () && _folder.back () != '\\' && _folder.back () != '/' )
+		_folder +="\\" ;
+#else
+	if ( !_folder.empty () && _folder.back () != '/' )
+		_folder +="/" ;
+#endif
+	_copy =bCopy ;
+	_embed =bEmbed ;
+}
+
+std::string gltfTextureManager::add (const std::string &imageId, const std::string &fileName, const std::string &relativeUri) {
+	std::string source =resolvePath (fileName) ;
+	std::map<std::string, int>::iterator iter =_byPath.find (source) ;
+	if ( iter != _byPath.end () ) {
+		asset &a =*_assets [iter->second] ;
+		a._images.push_back (imageId) ;
+		return (_copy ? a._target : a._uri) ;
+	}
+
+	int index =(int)_assets.size () ;
+	std::shared_ptr<asset> a (new asset) ;
+	a->_source =source ;
+	a->_uri =relativeUri ;
+	a->_hash =0 ;
+	a->_size =0 ;
+	a->_alias =-1 ;
+	a->_read =false ;
+	a->_ok =false ;
+	a->_images.push_back (imageId) ;
+	if ( _copy )
+		a->_target =reserveTarget (source) ;
+	_assets.push_back (a) ;
+	_byPath [source] =index ;
+
+	if ( _copy || _embed ) {
+		if ( _pool )
+			_pending.push_back (_pool->submit ([this, a] () { process (*a) ; })) ;
+		else
+			process (*a) ;
+	}
+	return (_copy ? a->_target : a->_uri) ;
+}
+
+void gltfTextureManager::finalize (Json::Value &images, Json::Value &textures) {
+	wait () ;
+	if ( !_copy && !_embed )
+		return ;
+
+	// Same content, the first registered asset is the canonical one
+	_byContent.clear () ;
+	for ( size_t i =0 ; i < _assets.size () ; i++ ) {
+		asset &a =*_assets [i] ;
+		if ( !a._read )
+			continue ;
+		uint64_t key =gltfHashCombine (a._hash, a._size) ;
+		std::unordered_map<uint64_t, int>::iterator iter =_byContent.find (key) ;
+		if ( iter != _byContent.end () )
+			a._alias =iter->second ;
+		else
+			_byContent [key] =(int)i ;
+	}
+	if ( _copy ) {
+		for ( auto &a : _assets ) {
+			if ( !a->_read || a->_alias != -1 )
+				continue ;
+			if ( _pool )
+				_pending.push_back (_pool->submit ([this, a] () { copy (*a) ; })) ;
+			else
+				copy (*a) ;
+		}
+		wait () ;
+		// An alias is only as good as the file it points to
+		for ( auto &a : _assets ) {
+			if ( a->_alias != -1 )
+				a->_ok =_assets [a->_alias]->_ok ;
+		}
+	}
+
+	for ( auto &a : _assets ) {
+		asset *pContent =a->_alias != -1 ? _assets [a->_alias].get () : a.get () ;
+		std::string uri =a->_uri ;
+		if ( !a->_read ) {
+			std::cout << ("Warning: cannot read image file ") << a->_source << std::endl ;
+			pContent =a.get () ;
+		} else if ( !a->_ok ) {
+			std::cout << ("Warning: cannot copy image file ") << pContent->_source << (" to ") << _folder << pContent->_target << std::endl ;
+			pContent =a.get () ;
+		} else if ( _embed ) {
+			if ( pContent->_dataURI.empty () )
+				pContent->_dataURI =_pDataURIs->defer (pContent->_source, pContent->_uri) ;
+			uri =pContent->_dataURI ;
+		} else if ( _copy ) {
+			uri =pContent->_target ;
+		}
+		if ( pContent != a.get () && !pContent->_images.empty () ) {
+			const std::string &sharedId =pContent->_images.front () ;
+			for ( auto &imageId : a->_images )
+				images.removeMember (imageId) ;
+			for ( auto &texName : textures.getMemberNames () ) {
+				Json::Value &texture =textures [texName] ;
+				if ( std::find (a->_images.begin (), a->_images.end (), texture [("source")].asString ()) != a->_images.end () )
+					texture [("source")] =sharedId ;
+			}
+			continue ;
+		}
+		for ( auto &imageId : a->_images ) {
+			if ( images.isMember (imageId) )
+				images [imageId] [("uri")] =uri ;
+		}
+	}
+}
+
+size_t gltfTextureManager::uniqueCount () const {
+	size_t nb =0 ;
+	for ( auto &a : _assets )
+		nb +=a->_alias == -1 ? 1 : 0 ;
+	return (nb) ;
+}
+
+//-----------------------------------------------------------------------------
+// Runs on the worker pool - only touches its own asset. The file is hashed in place, through its mapping.
+void gltfTextureManager::process (asset &a) {
+	memoryMappedFile file ;
+	if ( !file.open (a._source) )
+		return ;
+	a._size =file.size () ;
+	a._hash =gltfHash64 (file.data (), file.size ()) ;
+	a._read =true ;
+	a._ok =!_copy ;
+}
+
+// Runs on the worker pool, for the canonical assets only
+void gltfTextureManager::copy (asset &a) {
+	std::string dst =_folder + a._target ;
+	// Never truncate the source when exporting next to it
+	a._ok =resolvePath (dst) == a._source || copyFile (a._source, dst) ;
+}
+
+std::string gltfTextureManager::reserveTarget (const std::string &fileName) {
+	std::string name =FbxPathUtils::GetFileName (fileName.c_str ()).Buffer () ;
+	std::string base =name, ext ;
+	size_t pos =name.rfind ('.') ;
+	if ( pos != std::string::npos ) {
+		base =name.substr (0, pos) ;
+		ext =name.substr (pos) ;
+	}
+	// Two different source files with the same name should not overwrite each other
+	for ( int i =1 ; _targets.find (name) != _targets.end () ; i++ )
+		name =base + "_" + std::to_string (i) + ext ;
+	_targets [name] =(int)_assets.size () ;
+	return (name) ;
+}
+
+//-----------------------------------------------------------------------------
+/*static*/ std::string gltfTextureManager::resolvePath (const std::string &fileName) {
+#if defined(_WIN32) || defined(_WIN64)
+	char buffer [_MAX_PATH] ;
+	if ( _fullpath (buffer, fileName.c_str (), _MAX_PATH) == nullptr )
+		return (fileName) ;
+	return (std::string (buffer)) ;
+#else
+	char *pszPath =realpath (fileName.c_str (), nullptr) ;
+	if ( pszPath == nullptr )
+		return (fileName) ;
+	std::string ret (pszPath) ;
+	free (pszPath) ;
+	return (ret) ;
+#endif
+}
+
+// Copies a file letting the OS do the work when it can: block cloning (reflink) first, then an
+// in-kernel copy, and a plain 1Mb buffer copy as a last resort.
+/*static*/ bool gltfTextureManager::copyFile (const std::string &src, const std::string &dst) {
+#if defined(_WIN32) || defined(_WIN64)
+	// CopyFile uses block cloning on ReFS volumes
+	return (CopyFileA (src.c_str (), dst.c_str (), FALSE) != FALSE) ;
+#elif defined(__APPLE__)
+#ifdef COPYFILE_CLONE
+	// Clones on APFS, and silently falls back to a data copy elsewhere
+	return (copyfile (src.c_str (), dst.c_str (), nullptr, COPYFILE_CLONE | COPYFILE_DATA) == 0) ;
+#else
+	return (copyfile (src.c_str (), dst.c_str (), nullptr, COPYFILE_DATA) == 0) ;
+#endif
+#else
+	int in =open (src.c_str (), O_RDONLY) ;
+	if ( in < 0 )
+		return (false) ;
+	struct stat st ;
+	if ( fstat (in, &st) != 0 ) {
+		close (in) ;
+		return (false) ;
+	}
+	int out =open (dst.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644) ;
+	if ( out < 0 ) {
+		close (in) ;
+		return (false) ;
+	}
+	bool bOk =false ;
+#ifdef FICLONE
+	// btrfs, xfs, ...
+	bOk =ioctl (out, FICLONE, in) == 0 ;
+#endif
+	off_t remaining =st.st_size ;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+	// Both offsets move with the copy, so the buffer loop below can resume where this one stopped
+	while ( !bOk && remaining > 0 ) {
+		ssize_t nb =copy_file_range (in, nullptr, out, nullptr, (size_t)remaining, 0) ;
+		if ( nb <= 0 )
+			break ;
+		remaining -=nb ;
+	}
+#endif
+	if ( !bOk && remaining > 0 ) {
+		std::vector<char> buffer (1024 * 1024) ;
+		ssize_t nb ;
+		while ( (nb =read (in, buffer.data (), buffer.size ())) > 0 ) {
+			const char *p =buffer.data () ;
+			while ( nb > 0 ) {
+				ssize_t written =write (out, p, (size_t)nb) ;
+				if ( written <= 0 )
+					break ;
+				p +=written ;
+				nb -=written ;
+				remaining -=written ;
+			}
+			if ( nb > 0 )
+				break ;
+		}
+	}
+	bOk =bOk || remaining <= 0 ;
+	close (in) ;
+	return ((close (out) == 0) && bOk) ;
+#endif
+}
+
+}
@@ -0,0 +1,86 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <unordered_map>
+#include "threadPool.h"
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfTextureManager
+// Abstraction : Owns the image files referenced by the exported scene. Images are deduplicated
+//               first by their resolved path, then by a content hash, so every unique file is read,
+//               copied (--copy) or base64 encoded (--embed) only once. Files are hashed on the worker
+//               pool while the writer keeps processing geometry. finalize () then picks the first
+//               registered file of every content as the canonical one (so the output does not depend
+//               on the job order), copies the canonical files on the pool, and patches the 'images' uri.
+class gltfTextureManager {
+	struct asset {
+		std::string _source ;    // resolved source file
+		std::string _uri ;       // uri as written if no copy/embed is requested
+		std::string _target ;    // file name in the output folder (--copy)
+		std::string _dataURI ;   // --embed, a gltfDataURIs placeholder
+		uint64_t _hash ;
+		size_t _size ;
+		int _alias ;             // index of the first asset with the same content, or -1
+		bool _read ;             // hashed
+		bool _ok ;               // read, and copied for --copy (the copy of the canonical asset for an alias)
+		std::vector<std::string> _images ; // json 'images' ids using this asset
+	} ;
+	std::vector<std::shared_ptr<asset> > _assets ;
+	std::map<std::string, int> _byPath ;
+	std::unordered_map<uint64_t, int> _byContent ;
+	std::map<std::string, int> _targets ;
+	std::vector<std::future<void> > _pending ;
+	threadPool *_pool ;
+	gltfDataURIs *_pDataURIs ;
+	std::string _folder ;
+	bool _copy ;
+	bool _embed ;
+
+public:
+	gltfTextureManager (threadPool *pPool, gltfDataURIs *pDataURIs) : _pool (pPool), _pDataURIs (pDataURIs), _copy (false), _embed (false) {}
+	// The pool may outlive the manager, its queued jobs refer to this
+	~gltfTextureManager () { wait () ; }
+
+	void reset (const std::string &outputFolder, bool bCopy, bool bEmbed) ;
+	// Registers an image, queues the copy/encode job if that file was not seen yet, and returns the
+	// uri to write in the meantime.
+	std::string add (const std::string &imageId, const std::string &fileName, const std::string &relativeUri) ;
+	// Waits for the pending jobs and writes the final uri of every registered image. Images found to
+	// have the same content as another one are dropped, and the textures using them re-pointed.
+	void finalize (Json::Value &images, Json::Value &textures) ;
+
+	size_t fileCount () const { return (_assets.size ()) ; }
+	size_t uniqueCount () const ;
+
+	static std::string resolvePath (const std::string &fileName) ;
+	static bool copyFile (const std::string &src, const std::string &dst) ;
+
+protected:
+	void wait () ;
+	void process (asset &a) ;
+	void copy (asset &a) ;
+	std::string reserveTarget (const std::string &fileName) ;
+
+} ;
+
+}
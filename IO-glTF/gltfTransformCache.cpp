@@ -0,0 +1,67 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfTransformCache.h"
+
+namespace _IOglTF_NS_ {
+
+//-----------------------------------------------------------------------------
+// Function    : record
+// Abstraction : Evaluate the node local matrix and compose its global matrix from the parent one.
+//               Nodes must be recorded parent first, a parent which was not recorded yet is recorded on the fly.
+const FbxAMatrix &gltfTransformCache::record (FbxNode *pNode) {
+	transforms &entry =_cache [pNode->GetUniqueID ()] ; // unordered_map references survive a rehash
+	FbxNode *pParentNode =pNode->GetParent () ;
+	FbxTransform::EInheritType inheritType =FbxTransform::eInheritRrSs ;
+	pNode->GetTransformationInheritType (inheritType) ;
+	// For Single Matrix situation, obtain transform matrix from eDestinationPivot, which include pivot offsets and pre/post rotations.
+	if ( pParentNode == nullptr ) {
+		entry._local =pNode->EvaluateLocalTransform (FBXSDK_TIME_ZERO, FbxNode::eDestinationPivot) ;
+		entry._global =entry._local ;
+	} else if ( inheritType == FbxTransform::eInheritRrSs ) {
+		entry._local =pNode->EvaluateLocalTransform (FBXSDK_TIME_ZERO, FbxNode::eDestinationPivot) ;
+		entry._global =lookup (pParentNode)._global * entry._local ;
+	} else {
+		// RSrs / Rrs inheritance cannot be composed from the parent global matrix, ask the evaluator for this node only
+		entry._global =pNode->EvaluateGlobalTransform (FBXSDK_TIME_ZERO, FbxNode::eDestinationPivot) ;
+		entry._local =lookup (pParentNode)._global.Inverse () * entry._global ;
+	}
+	return (entry._global) ;
+}
+
+const gltfTransformCache::transforms &gltfTransformCache::lookup (FbxNode *pNode) {
+	std::unordered_map<FbxUInt64, transforms>::const_iterator iter =_cache.find (pNode->GetUniqueID ()) ;
+	if ( iter == _cache.end () ) {
+		record (pNode) ;
+		iter =_cache.find (pNode->GetUniqueID ()) ;
+	}
+	return (iter->second) ;
+}
+
+const FbxAMatrix &gltfTransformCache::local (FbxNode *pNode) {
+	return (lookup (pNode)._local) ;
+}
+
+const FbxAMatrix &gltfTransformCache::global (FbxNode *pNode) {
+	return (lookup (pNode)._global) ;
+}
+
+}
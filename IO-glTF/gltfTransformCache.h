@@ -0,0 +1,55 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <unordered_map>
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfTransformCache
+// Abstraction : Evaluates every node local matrix once (eDestinationPivot, time zero) and composes
+//               the global matrices top-down from the parent one, so the writer never asks the FBX
+//               evaluator for a node and its parent global transform again.
+class gltfTransformCache {
+	struct transforms {
+		FbxAMatrix _local ;
+		FbxAMatrix _global ;
+	} ;
+	std::unordered_map<FbxUInt64, transforms> _cache ;
+
+public:
+	gltfTransformCache () {}
+
+	void clear () { _cache.clear () ; }
+	size_t size () const { return (_cache.size ()) ; }
+
+	// Must be called parent first (i.e. during a top-down scene walk)
+	const FbxAMatrix &record (FbxNode *pNode) ;
+
+	const FbxAMatrix &local (FbxNode *pNode) ;
+	const FbxAMatrix &global (FbxNode *pNode) ;
+
+protected:
+	const transforms &lookup (FbxNode *pNode) ;
+
+} ;
+
+}
@@ -0,0 +1,147 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfTriangulator.h"
+
+namespace _IOglTF_NS_ {
+
+//-----------------------------------------------------------------------------
+void gltfTriangulator::queue (FbxMesh *pMesh, threadPool &pool) {
+	if ( pMesh == nullptr || _jobs.find (pMesh) != _jobs.end () )
+		return ;
+	std::shared_ptr<triangles> pTriangles (new triangles) ;
+	// The job only reads the control points and polygon arrays, WriteMesh () waits for it before touching the mesh
+	job &entry =_jobs [pMesh] ;
+	entry._triangles =pTriangles ;
+	entry._done =pool.submit ([pMesh, pTriangles] () { triangulate (pMesh, *pTriangles) ; }) ;
+}
+
+const gltfTriangulator::triangles *gltfTriangulator::get (FbxMesh *pMesh) {
+	auto iter =_jobs.find (pMesh) ;
+	if ( iter == _jobs.end () )
+		return (nullptr) ;
+	if ( iter->second._done.valid () )
+		iter->second._done.get () ;
+	return (iter->second._triangles.get ()) ;
+}
+
+//-----------------------------------------------------------------------------
+/*static*/ void gltfTriangulator::triangulate (FbxMesh *pMesh, triangles &tris) {
+	const FbxVector4 *pControlPoints =pMesh->GetControlPoints () ;
+	const int *pPolygonVertices =pMesh->GetPolygonVertices () ;
+	int nb =pMesh->GetPolygonCount () ;
+	// Quads are the common case, reserve for 2 triangles per polygon
+	tris._corners.reserve ((size_t)nb * 6) ;
+	tris._polygons.reserve ((size_t)nb * 2) ;
+	for ( int i =0 ; i < nb ; i++ ) {
+		int size =pMesh->GetPolygonSize (i) ;
+		int start =pMesh->GetPolygonVertexIndex (i) ;
+		if ( size == 3 ) {
+			tris._corners.push_back (start) ;
+			tris._corners.push_back (start + 1) ;
+			tris._corners.push_back (start + 2) ;
+			tris._polygons.push_back (i) ;
+		} else if ( size > 3 ) {
+			triangulatePolygon (pControlPoints, pPolygonVertices, start, size, i, tris) ;
+		}
+		// Points and lines (size < 3) have no surface to export
+	}
+}
+
+// Function    : cross2D
+// Abstraction : z component of (b - a) x (c - a), positive for a counter-clockwise turn
+static inline double cross2D (const FbxDouble2 &a, const FbxDouble2 &b, const FbxDouble2 &c) {
+	return ((b [0] - a [0]) * (c [1] - a [1]) - (b [1] - a [1]) * (c [0] - a [0])) ;
+}
+
+/*static*/ void gltfTriangulator::triangulatePolygon (const FbxVector4 *pControlPoints, const int *pPolygonVertices, int start, int size, int polygon, triangles &tris) {
+	// Newell normal, robust for non planar polygons
+	double normal [3] ={ 0., 0., 0. } ;
+	for ( int i =0 ; i < size ; i++ ) {
+		const FbxVector4 &a =pControlPoints [pPolygonVertices [start + i]] ;
+		const FbxVector4 &b =pControlPoints [pPolygonVertices [start + (i + 1) % size]] ;
+		normal [0] +=(a [1] - b [1]) * (a [2] + b [2]) ;
+		normal [1] +=(a [2] - b [2]) * (a [0] + b [0]) ;
+		normal [2] +=(a [0] - b [0]) * (a [1] + b [1]) ;
+	}
+	// Project on the plane of the largest normal component, flipped so the polygon is counter-clockwise
+	int axis =fabs (normal [0]) > fabs (normal [1]) ? (fabs (normal [0]) > fabs (normal [2]) ? 0 : 2) : (fabs (normal [1]) > fabs (normal [2]) ? 1 : 2) ;
+	int u =(axis + 1) % 3, v =(axis + 2) % 3 ;
+	bool bFlip =normal [axis] < 0. ;
+	std::vector<FbxDouble2> pts (size) ;
+	for ( int i =0 ; i < size ; i++ ) {
+		const FbxVector4 &p =pControlPoints [pPolygonVertices [start + i]] ;
+		pts [i] =FbxDouble2 (p [u], bFlip ? -p [v] : p [v]) ;
+	}
+
+	bool bConvex =normal [axis] != 0. ;
+	for ( int i =0 ; bConvex && i < size ; i++ )
+		bConvex =cross2D (pts [(i + size - 1) % size], pts [i], pts [(i + 1) % size]) >= 0. ;
+	if ( bConvex ) { // Fan, also used for degenerate polygons
+		for ( int i =1 ; i < size - 1 ; i++ ) {
+			tris._corners.push_back (start) ;
+			tris._corners.push_back (start + i) ;
+			tris._corners.push_back (start + i + 1) ;
+			tris._polygons.push_back (polygon) ;
+		}
+		return ;
+	}
+
+	// Ear clipping, O(n^2) which is fine for the polygon sizes found in FBX files
+	std::vector<int> remaining (size) ;
+	for ( int i =0 ; i < size ; i++ )
+		remaining [i] =i ;
+	while ( remaining.size () > 3 ) {
+		int nb =(int)remaining.size () ;
+		bool bEar =false ;
+		for ( int i =0 ; i < nb && !bEar ; i++ ) {
+			int prev =remaining [(i + nb - 1) % nb], cur =remaining [i], next =remaining [(i + 1) % nb] ;
+			if ( cross2D (pts [prev], pts [cur], pts [next]) <= 0. )
+				continue ; // Reflex or flat corner
+			bEar =true ;
+			for ( int j =0 ; j < nb && bEar ; j++ ) {
+				int k =remaining [j] ;
+				if ( k == prev || k == cur || k == next )
+					continue ;
+				bEar = !(  cross2D (pts [prev], pts [cur], pts [k]) >= 0.
+						&& cross2D (pts [cur], pts [next], pts [k]) >= 0.
+						&& cross2D (pts [next], pts [prev], pts [k]) >= 0.) ;
+			}
+			if ( bEar ) {
+				tris._corners.push_back (start + prev) ;
+				tris._corners.push_back (start + cur) ;
+				tris._corners.push_back (start + next) ;
+				tris._polygons.push_back (polygon) ;
+				remaining.erase (remaining.begin () + i) ;
+			}
+		}
+		if ( !bEar )
+			break ; // Self intersecting polygon, fan what is left
+	}
+	for ( size_t i =1 ; i + 1 < remaining.size () ; i++ ) {
+		tris._corners.push_back (start + remaining [0]) ;
+		tris._corners.push_back (start + remaining [i]) ;
+		tris._corners.push_back (start + remaining [i + 1]) ;
+		tris._polygons.push_back (polygon) ;
+	}
+}
+
+}
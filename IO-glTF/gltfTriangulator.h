@@ -0,0 +1,69 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include "threadPool.h"
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfTriangulator
+// Abstraction : Triangulates the mesh polygons for the VBO without touching the FbxScene. Triangles are
+//               polygon-vertex indices (i.e. the layer element eByPolygonVertex index), so the mesh and its
+//               layer elements are read in place. Convex polygons are fanned, concave ones are ear clipped
+//               in the plane of their Newell normal. Every mesh the mesh cache does not have is queued on
+//               the writer pool during the scene preprocessing, and WriteMesh () only waits for the one it
+//               needs.
+class gltfTriangulator {
+public:
+	struct triangles {
+		std::vector<int> _corners ;  // 3 polygon-vertex indices per triangle
+		std::vector<int> _polygons ; // source polygon of every triangle (eByPolygon layer elements)
+		size_t count () const { return (_polygons.size ()) ; }
+	} ;
+
+protected:
+	// The pool task owns the triangles only, not the job, else the future shared state (which owns the
+	// task) and the job would keep each other alive until get ()
+	struct job {
+		std::shared_ptr<triangles> _triangles ;
+		std::future<void> _done ;
+	} ;
+	std::unordered_map<FbxMesh *, job> _jobs ;
+
+public:
+	gltfTriangulator () {}
+
+	void clear () { _jobs.clear () ; }
+	// Instanced meshes are queued once
+	void queue (FbxMesh *pMesh, threadPool &pool) ;
+	// Waits for the mesh job, nullptr if the mesh was never queued
+	const triangles *get (FbxMesh *pMesh) ;
+
+	static void triangulate (FbxMesh *pMesh, triangles &tris) ;
+
+protected:
+	static void triangulatePolygon (const FbxVector4 *pControlPoints, const int *pPolygonVertices, int start, int size, int polygon, triangles &tris) ;
+
+} ;
+
+}
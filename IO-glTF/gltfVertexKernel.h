@@ -0,0 +1,485 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include "gltfHash.h"
+#include "gltfWeld.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string.h> // for memcmp
+#include <unordered_map>
+#include <vector>
+
+namespace _IOglTF_NS_ {
+
+// Vertex attributes present in a gltfVertexStreams, positions are always present
+enum gltfVertexAttributes {
+	eVertexUV =0x01,
+	eVertexNormal =0x02,
+	eVertexTangent =0x04,
+	eVertexBinormal =0x08,
+	eVertexColor =0x10,
+	eVertexAllAttributes =0x1f
+} ;
+
+// Attributes the writer outputs for the mesh of pNode: the normals, and one uv set when the node has
+// materials to bind it to. Colors, tangents and binormals are never written.
+inline unsigned int gltfVertexAttributesOf (FbxNode *pNode) {
+	unsigned int attributes =eVertexNormal ;
+	FbxMesh *pMesh =pNode->GetMesh () ;
+	FbxLayer *pLayer =nullptr ;
+	for ( int iLayer =0 ; iLayer < pMesh->GetLayerCount () && pLayer == nullptr ; iLayer++ )
+		pLayer =pMesh->GetLayer (iLayer, FbxLayerElement::eMaterial) ;
+	if ( pLayer && pLayer->GetMaterials () && pNode->GetMaterialCount () )
+		attributes |=eVertexUV ;
+	return (attributes) ;
+}
+
+// Class       : gltfVertexStreams
+// Abstraction : One vector per vertex attribute, either one entry per triangle corner (before indexing) or one
+//               entry per glTF vertex (after). Attributes the mesh does not have are left empty.
+class gltfVertexStreams {
+public:
+	std::vector<unsigned int> _indices ;
+	std::vector<FbxDouble3> _positions ; // babylon.js does not like homogeneous coordinates (i.e. FbxDouble4)
+	std::vector<FbxDouble2> _uvs ;
+	std::vector<FbxDouble3> _normals ;
+	std::vector<FbxDouble3> _tangents ;
+	std::vector<FbxDouble3> _binormals ;
+	std::vector<FbxColor> _vcolors ;
+
+public:
+	unsigned int attributes () const {
+		return (
+			  (_uvs.size () ? eVertexUV : 0)
+			| (_normals.size () ? eVertexNormal : 0)
+			| (_tangents.size () ? eVertexTangent : 0)
+			| (_binormals.size () ? eVertexBinormal : 0)
+			| (_vcolors.size () ? eVertexColor : 0)
+		) ;
+	}
+
+} ;
+
+// Function    : gltfParallelFor
+// Abstraction : Runs f (chunk) for chunk in [0, nbChunks) on the pool, and waits for all of them. Must not be
+//               called from a pool worker.
+template<class F>
+inline void gltfParallelFor (threadPool &pool, size_t nbChunks, F f) {
+	std::vector<std::future<void> > jobs ;
+	jobs.reserve (nbChunks) ;
+	for ( size_t chunk =0 ; chunk < nbChunks ; chunk++ )
+		jobs.push_back (pool.submit ([&f, chunk] () { f (chunk) ; })) ;
+	for ( auto &job : jobs )
+		job.get () ;
+}
+
+// Class       : gltfVertexKernel
+// Abstraction : indexVBO () / weldVBO () for one combination of vertex attributes (M, a gltfVertexAttributes mask).
+//               The vertex key holds the present attributes only (6 doubles for positions and normals, instead
+//               of the 21 of all attributes) and the attribute tests fold at compile time, so the per vertex
+//               loops carry no branch on the attributes. gltfVertexKernels::index () / weld () pick the kernel
+//               once per mesh.
+template<unsigned int M>
+class gltfVertexKernel {
+public:
+	static const size_t width =3
+		+ ((M & eVertexUV) ? 2 : 0)
+		+ ((M & eVertexNormal) ? 3 : 0)
+		+ ((M & eVertexTangent) ? 3 : 0)
+		+ ((M & eVertexBinormal) ? 3 : 0)
+		+ ((M & eVertexColor) ? 4 : 0) ;
+	typedef std::array<double, width> key ;
+
+	// Vertices are merged when bitwise identical, like the former memcmp () on the packed vertex
+	struct keyHash {
+		size_t operator() (const key &k) const { return ((size_t)gltfHash64 (k.data (), sizeof (key))) ; }
+	} ;
+	struct keyEqual {
+		bool operator() (const key &a, const key &b) const { return (memcmp (a.data (), b.data (), sizeof (key)) == 0) ; }
+	} ;
+
+public:
+	static void pack (const gltfVertexStreams &in, size_t i, key &k) {
+		double *p =k.data () ;
+		p =copy (in._positions [i].mData, 3, p) ;
+		if ( M & eVertexUV )
+			p =copy (in._uvs [i].mData, 2, p) ;
+		if ( M & eVertexNormal )
+			p =copy (in._normals [i].mData, 3, p) ;
+		if ( M & eVertexTangent )
+			p =copy (in._tangents [i].mData, 3, p) ;
+		if ( M & eVertexBinormal )
+			p =copy (in._binormals [i].mData, 3, p) ;
+		if ( M & eVertexColor ) {
+			const FbxColor &c =in._vcolors [i] ;
+			*p++ =c.mRed ; *p++ =c.mGreen ; *p++ =c.mBlue ; *p++ =c.mAlpha ;
+		}
+	}
+
+	static void append (const gltfVertexStreams &in, size_t i, gltfVertexStreams &out) {
+		out._positions.push_back (in._positions [i]) ;
+		if ( M & eVertexUV )
+			out._uvs.push_back (in._uvs [i]) ;
+		if ( M & eVertexNormal )
+			out._normals.push_back (in._normals [i]) ;
+		if ( M & eVertexTangent )
+			out._tangents.push_back (in._tangents [i]) ;
+		if ( M & eVertexBinormal )
+			out._binormals.push_back (in._binormals [i]) ;
+		if ( M & eVertexColor )
+			out._vcolors.push_back (in._vcolors [i]) ;
+	}
+
+	// append () at a given output vertex, for outputs sized upfront
+	static void store (const gltfVertexStreams &in, size_t i, gltfVertexStreams &out, size_t o) {
+		out._positions [o] =in._positions [i] ;
+		if ( M & eVertexUV )
+			out._uvs [o] =in._uvs [i] ;
+		if ( M & eVertexNormal )
+			out._normals [o] =in._normals [i] ;
+		if ( M & eVertexTangent )
+			out._tangents [o] =in._tangents [i] ;
+		if ( M & eVertexBinormal )
+			out._binormals [o] =in._binormals [i] ;
+		if ( M & eVertexColor )
+			out._vcolors [o] =in._vcolors [i] ;
+	}
+
+	static void resize (gltfVertexStreams &out, size_t nb) {
+		out._positions.resize (nb) ;
+		if ( M & eVertexUV )
+			out._uvs.resize (nb) ;
+		if ( M & eVertexNormal )
+			out._normals.resize (nb) ;
+		if ( M & eVertexTangent )
+			out._tangents.resize (nb) ;
+		if ( M & eVertexBinormal )
+			out._binormals.resize (nb) ;
+		if ( M & eVertexColor )
+			out._vcolors.resize (nb) ;
+	}
+
+	// The input vertex is within the tolerances of the output vertex, for every attribute
+	static bool weldable (const gltfVertexStreams &in, size_t i, const gltfVertexStreams &out, size_t j, const gltfWeldTolerances &tolerances) {
+		if ( !within (in._positions [i].mData, out._positions [j].mData, 3, tolerances._position) )
+			return (false) ;
+		if ( (M & eVertexNormal) && !within (in._normals [i].mData, out._normals [j].mData, 3, tolerances._normal) )
+			return (false) ;
+		if ( (M & eVertexUV) && !within (in._uvs [i].mData, out._uvs [j].mData, 2, tolerances._uv) )
+			return (false) ;
+		if ( (M & eVertexTangent) && !within (in._tangents [i].mData, out._tangents [j].mData, 3, tolerances._normal) )
+			return (false) ;
+		if ( (M & eVertexBinormal) && !within (in._binormals [i].mData, out._binormals [j].mData, 3, tolerances._normal) )
+			return (false) ;
+		if ( M & eVertexColor ) {
+			const FbxColor &a =in._vcolors [i], &b =out._vcolors [j] ;
+			double ca [4] ={ a.mRed, a.mGreen, a.mBlue, a.mAlpha }, cb [4] ={ b.mRed, b.mGreen, b.mBlue, b.mAlpha } ;
+			if ( !within (ca, cb, 4, tolerances._color) )
+				return (false) ;
+		}
+		return (true) ;
+	}
+
+	// Bitwise identical vertices become one, the first occurrence gives the output order
+	static void index (const gltfVertexStreams &in, gltfVertexStreams &out) {
+		std::unordered_map<key, uint32_t, keyHash, keyEqual> VertexToOutIndex ;
+		VertexToOutIndex.reserve (in._positions.size ()) ;
+		out._indices.reserve (out._indices.size () + in._positions.size ()) ;
+		key k ;
+		for ( size_t i =0 ; i < in._positions.size () ; i++ ) {
+			pack (in, i, k) ;
+			auto ret =VertexToOutIndex.insert (std::make_pair (k, (uint32_t)out._positions.size ())) ;
+			if ( ret.second )
+				append (in, i, out) ;
+			out._indices.push_back (ret.first->second) ;
+		}
+	}
+
+	// index () on the pool threads, same output. The corners are hashed in parallel, the (hash, corner) pairs are
+	// radix sorted in parallel (LSD, 8 bits per pass, stable so a run of equal hashes lists its corners in input
+	// order), then runs are resolved with full key compares, each corner getting the first identical corner of
+	// its run. Vertices are finally numbered in first occurrence order with a parallel prefix sum.
+	static void indexParallel (const gltfVertexStreams &in, gltfVertexStreams &out, threadPool &pool) {
+		struct entry {
+			uint32_t _hash ;
+			uint32_t _corner ;
+		} ;
+		const size_t nb =in._positions.size () ;
+		const size_t nbChunks =std::max ((size_t)1, pool.size ()) ;
+		auto chunkBegin =[nb, nbChunks] (size_t chunk) { return (nb * chunk / nbChunks) ; } ;
+
+		// 1. Hash the corners
+		std::vector<entry> entries (nb), sorted (nb) ;
+		gltfParallelFor (pool, nbChunks, [&] (size_t chunk) {
+			key k ;
+			for ( size_t i =chunkBegin (chunk) ; i < chunkBegin (chunk + 1) ; i++ ) {
+				pack (in, i, k) ;
+				entries [i]._hash =(uint32_t)gltfHash64 (k.data (), sizeof (key)) ;
+				entries [i]._corner =(uint32_t)i ;
+			}
+		}) ;
+
+		// 2. Sort on the hash, runs of equal hashes only need to be contiguous
+		std::vector<size_t> offsets (nbChunks * 256) ;
+		for ( int shift =0 ; shift < 32 ; shift +=8 ) {
+			std::fill (offsets.begin (), offsets.end (), 0) ;
+			gltfParallelFor (pool, nbChunks, [&] (size_t chunk) {
+				size_t *pCounts =&offsets [chunk * 256] ;
+				for ( size_t i =chunkBegin (chunk) ; i < chunkBegin (chunk + 1) ; i++ )
+					pCounts [(entries [i]._hash >> shift) & 0xff]++ ;
+			}) ;
+			size_t offset =0 ;
+			for ( size_t digit =0 ; digit < 256 ; digit++ ) {
+				for ( size_t chunk =0 ; chunk < nbChunks ; chunk++ ) {
+					size_t count =offsets [chunk * 256 + digit] ;
+					offsets [chunk * 256 + digit] =offset ;
+					offset +=count ;
+				}
+			}
+			gltfParallelFor (pool, nbChunks, [&] (size_t chunk) {
+				size_t *pOffsets =&offsets [chunk * 256] ;
+				for ( size_t i =chunkBegin (chunk) ; i < chunkBegin (chunk + 1) ; i++ )
+					sorted [pOffsets [(entries [i]._hash >> shift) & 0xff]++] =entries [i] ;
+			}) ;
+			entries.swap (sorted) ;
+		}
+		std::vector<entry> ().swap (sorted) ;
+
+		// 3. Resolve the runs, chunks are moved to run boundaries
+		std::vector<size_t> runs (nbChunks + 1, nb) ;
+		for ( size_t chunk =0 ; chunk < nbChunks ; chunk++ ) {
+			size_t begin =chunkBegin (chunk) ;
+			while ( begin > 0 && begin < nb && entries [begin]._hash == entries [begin - 1]._hash )
+				begin++ ;
+			runs [chunk] =begin ;
+		}
+		std::vector<uint32_t> first (nb) ; // corner -> first identical corner
+		gltfParallelFor (pool, nbChunks, [&] (size_t chunk) {
+			std::vector<std::pair<uint32_t, key> > leaders ;
+			key k ;
+			for ( size_t run =runs [chunk] ; run < runs [chunk + 1] ; ) {
+				size_t end =run + 1 ;
+				while ( end < nb && entries [end]._hash == entries [run]._hash )
+					end++ ;
+				if ( end - run == 1 ) {
+					first [entries [run]._corner] =entries [run]._corner ;
+					run =end ;
+					continue ;
+				}
+				leaders.clear () ;
+				for ( size_t i =run ; i < end ; i++ ) {
+					uint32_t corner =entries [i]._corner ;
+					pack (in, corner, k) ;
+					first [corner] =corner ;
+					for ( const auto &leader : leaders ) {
+						if ( keyEqual () (k, leader.second) ) {
+							first [corner] =leader.first ;
+							break ;
+						}
+					}
+					if ( first [corner] == corner )
+						leaders.push_back (std::make_pair (corner, k)) ;
+				}
+				run =end ;
+			}
+		}) ;
+		std::vector<entry> ().swap (entries) ;
+
+		// 4. Number the vertices in first occurrence order, and write them
+		std::vector<size_t> bases (nbChunks + 1, 0) ;
+		gltfParallelFor (pool, nbChunks, [&] (size_t chunk) {
+			size_t count =0 ;
+			for ( size_t i =chunkBegin (chunk) ; i < chunkBegin (chunk + 1) ; i++ )
+				count +=first [i] == i ? 1 : 0 ;
+			bases [chunk + 1] =count ;
+		}) ;
+		for ( size_t chunk =0 ; chunk < nbChunks ; chunk++ )
+			bases [chunk + 1] +=bases [chunk] ;
+		const size_t outBase =out._positions.size (), indexBase =out._indices.size () ;
+		resize (out, outBase + bases [nbChunks]) ;
+		out._indices.resize (indexBase + nb) ;
+		std::vector<uint32_t> vertex (nb) ; // first identical corner -> output vertex
+		gltfParallelFor (pool, nbChunks, [&] (size_t chunk) {
+			size_t o =outBase + bases [chunk] ;
+			for ( size_t i =chunkBegin (chunk) ; i < chunkBegin (chunk + 1) ; i++ ) {
+				if ( first [i] != i )
+					continue ;
+				vertex [i] =(uint32_t)o ;
+				store (in, i, out, o++) ;
+			}
+		}) ;
+		gltfParallelFor (pool, nbChunks, [&] (size_t chunk) {
+			for ( size_t i =chunkBegin (chunk) ; i < chunkBegin (chunk + 1) ; i++ )
+				out._indices [indexBase + i] =vertex [first [i]] ;
+		}) ;
+	}
+
+	// index () when every attribute is per control point: the input streams hold one entry per control point,
+	// and corners the control point of every triangle corner. Only the control points are hashed (to merge the
+	// bitwise identical ones, like index () would), then the corners are a table lookup each. Same output as
+	// index () on the expanded corners.
+	static void indexPoints (const gltfVertexStreams &in, const std::vector<int> &corners, gltfVertexStreams &out) {
+		std::vector<int> unique (in._positions.size ()) ; // control point -> first identical control point
+		{
+			std::unordered_map<key, int, keyHash, keyEqual> PointToFirst ;
+			PointToFirst.reserve (in._positions.size ()) ;
+			key k ;
+			for ( size_t i =0 ; i < in._positions.size () ; i++ ) {
+				pack (in, i, k) ;
+				unique [i] =PointToFirst.insert (std::make_pair (k, (int)i)).first->second ;
+			}
+		}
+		std::vector<int> remap (in._positions.size (), -1) ; // first identical control point -> output vertex
+		out._indices.reserve (out._indices.size () + corners.size ()) ;
+		for ( size_t i =0 ; i < corners.size () ; i++ ) {
+			int point =unique [corners [i]] ;
+			if ( remap [point] < 0 ) {
+				remap [point] =(int)out._positions.size () ;
+				append (in, (size_t)point, out) ;
+			}
+			out._indices.push_back ((uint32_t)remap [point]) ;
+		}
+	}
+
+	// The per corner streams of per control point streams
+	static void expand (const gltfVertexStreams &in, const std::vector<int> &corners, gltfVertexStreams &out) {
+		for ( size_t i =0 ; i < corners.size () ; i++ )
+			append (in, (size_t)corners [i], out) ;
+	}
+
+	// Output vertices are bucketed in a hash grid of position tolerance sized cells, so an input vertex only
+	// compares with the output vertices of its 27 neighbour cells (linear expected time). The first output vertex
+	// within the tolerances is reused, so a welded vertex never moves by more than the tolerances.
+	static void weld (const gltfVertexStreams &in, gltfVertexStreams &out, const gltfWeldTolerances &tolerances) {
+		const double cellSize =tolerances._position ;
+		std::unordered_map<uint64_t, int> cells ; // cell -> last output vertex in the cell
+		std::vector<int> next ; // output vertex -> previous output vertex in the same cell
+		cells.reserve (in._positions.size ()) ;
+		next.reserve (in._positions.size ()) ;
+		out._indices.reserve (out._indices.size () + in._positions.size ()) ;
+		for ( size_t i =0 ; i < in._positions.size () ; i++ ) {
+			int64_t cell [3] ;
+			for ( int k =0 ; k < 3 ; k++ )
+				cell [k] =(int64_t)std::floor (in._positions [i] [k] / cellSize) ;
+
+			int found =-1 ;
+			for ( int dx =-1 ; dx <= 1 && found < 0 ; dx++ ) {
+				for ( int dy =-1 ; dy <= 1 && found < 0 ; dy++ ) {
+					for ( int dz =-1 ; dz <= 1 && found < 0 ; dz++ ) {
+						int64_t neighbour [3] ={ cell [0] + dx, cell [1] + dy, cell [2] + dz } ;
+						auto iter =cells.find (gltfHash64 (neighbour, sizeof (neighbour))) ;
+						if ( iter == cells.end () )
+							continue ;
+						// Cells sharing a hash share a list, weldable () sorts them out
+						for ( int j =iter->second ; j >= 0 && found < 0 ; j =next [j] ) {
+							if ( weldable (in, i, out, (size_t)j, tolerances) )
+								found =j ;
+						}
+					}
+				}
+			}
+			if ( found >= 0 ) {
+				out._indices.push_back ((uint32_t)found) ;
+				continue ;
+			}
+
+			int index =(int)out._positions.size () ;
+			append (in, i, out) ;
+			int &head =cells.insert (std::make_pair (gltfHash64 (cell, sizeof (cell)), -1)).first->second ;
+			next.push_back (head) ;
+			head =index ;
+			out._indices.push_back ((uint32_t)index) ;
+		}
+	}
+
+protected:
+	static double *copy (const double *from, int nb, double *to) {
+		for ( int i =0 ; i < nb ; i++ )
+			*to++ =from [i] ;
+		return (to) ;
+	}
+	static bool within (const double *a, const double *b, int nb, double tolerance) {
+		for ( int i =0 ; i < nb ; i++ ) {
+			if ( std::fabs (a [i] - b [i]) > tolerance )
+				return (false) ;
+		}
+		return (true) ;
+	}
+
+} ;
+
+// Expands K (M) for every gltfVertexAttributes mask
+#define _GLTF_VERTEX_MASKS_(K) \
+	K(0x00) K(0x01) K(0x02) K(0x03) K(0x04) K(0x05) K(0x06) K(0x07) \
+	K(0x08) K(0x09) K(0x0a) K(0x0b) K(0x0c) K(0x0d) K(0x0e) K(0x0f) \
+	K(0x10) K(0x11) K(0x12) K(0x13) K(0x14) K(0x15) K(0x16) K(0x17) \
+	K(0x18) K(0x19) K(0x1a) K(0x1b) K(0x1c) K(0x1d) K(0x1e) K(0x1f)
+
+// Class       : gltfVertexKernels
+// Abstraction : Runs the gltfVertexKernel of the attributes present in the input streams
+class gltfVertexKernels {
+public:
+	static void index (const gltfVertexStreams &in, gltfVertexStreams &out) {
+		switch ( in.attributes () ) {
+#define _GLTF_INDEX_KERNEL_(M) case M: gltfVertexKernel<M>::index (in, out) ; break ;
+			_GLTF_VERTEX_MASKS_(_GLTF_INDEX_KERNEL_)
+#undef _GLTF_INDEX_KERNEL_
+		}
+	}
+
+	static void indexParallel (const gltfVertexStreams &in, gltfVertexStreams &out, threadPool &pool) {
+		switch ( in.attributes () ) {
+#define _GLTF_INDEX_PARALLEL_KERNEL_(M) case M: gltfVertexKernel<M>::indexParallel (in, out, pool) ; break ;
+			_GLTF_VERTEX_MASKS_(_GLTF_INDEX_PARALLEL_KERNEL_)
+#undef _GLTF_INDEX_PARALLEL_KERNEL_
+		}
+	}
+
+	static void indexPoints (const gltfVertexStreams &in, const std::vector<int> &corners, gltfVertexStreams &out) {
+		switch ( in.attributes () ) {
+#define _GLTF_INDEX_POINTS_KERNEL_(M) case M: gltfVertexKernel<M>::indexPoints (in, corners, out) ; break ;
+			_GLTF_VERTEX_MASKS_(_GLTF_INDEX_POINTS_KERNEL_)
+#undef _GLTF_INDEX_POINTS_KERNEL_
+		}
+	}
+
+	static void expand (const gltfVertexStreams &in, const std::vector<int> &corners, gltfVertexStreams &out) {
+		switch ( in.attributes () ) {
+#define _GLTF_EXPAND_KERNEL_(M) case M: gltfVertexKernel<M>::expand (in, corners, out) ; break ;
+			_GLTF_VERTEX_MASKS_(_GLTF_EXPAND_KERNEL_)
+#undef _GLTF_EXPAND_KERNEL_
+		}
+	}
+
+	static void weld (const gltfVertexStreams &in, gltfVertexStreams &out, const gltfWeldTolerances &tolerances) {
+		switch ( in.attributes () ) {
+#define _GLTF_WELD_KERNEL_(M) case M: gltfVertexKernel<M>::weld (in, out, tolerances) ; break ;
+			_GLTF_VERTEX_MASKS_(_GLTF_WELD_KERNEL_)
+#undef _GLTF_WELD_KERNEL_
+		}
+	}
+
+} ;
+
+}
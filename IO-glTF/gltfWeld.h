@@ -0,0 +1,77 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <string>
+#include <sstream>
+
+namespace _IOglTF_NS_ {
+
+// Class       : gltfWeldTolerances
+// Abstraction : Per attribute tolerances of the vertex welding (gltfwriterVBO::weldVBO). Two polygon corners
+//               become one glTF vertex when their positions, normals (tangents, binormals), uvs and colors
+//               all differ by no more than these values on every component. Different uvs across a seam or
+//               different normals across a hard edge stay apart as long as they differ by more. A zero
+//               position tolerance disables welding, the vertices are then merged when bitwise identical only.
+//               Tolerances travel in the IOSettings as a 'position,normal,uv,color' string.
+class gltfWeldTolerances {
+public:
+	double _position ;
+	double _normal ;
+	double _uv ;
+	double _color ;
+
+public:
+	gltfWeldTolerances () : _position (0.), _normal (1e-3), _uv (1e-5), _color (1e-3) {}
+
+	bool enabled () const { return (_position > 0.) ; }
+
+	std::string spec () const {
+		if ( !enabled () )
+			return (std::string ()) ;
+		std::ostringstream output ;
+		output.precision (17) ;
+		output << _position << ',' << _normal << ',' << _uv << ',' << _color ;
+		return (output.str ()) ;
+	}
+	// A position tolerance alone keeps the default normal, uv and color tolerances
+	bool parse (const std::string &spec) {
+		*this =gltfWeldTolerances () ;
+		if ( spec.empty () )
+			return (true) ;
+		double *values [4] ={ &_position, &_normal, &_uv, &_color } ;
+		std::istringstream input (spec) ;
+		std::string value ;
+		for ( int i =0 ; i < 4 && std::getline (input, value, ',') ; i++ ) {
+			std::istringstream number (value) ;
+			double tolerance =-1. ;
+			if ( !(number >> tolerance) || tolerance < 0. ) {
+				*this =gltfWeldTolerances () ;
+				return (false) ;
+			}
+			*values [i] =tolerance ;
+		}
+		return (true) ;
+	}
+
+} ;
+
+}
@@ -24,9 +24,11 @@
 namespace _IOglTF_NS_ {
 
 bool gltfWriter::WriteAsset (FbxDocumentInfo *pSceneInfo) {
+	gltfStats::scope phase (_stats, "WriteAsset") ;
 	Json::Value asset ;
 
 	// unit - <meter> and <name>. In FBX we always work in centimeters, but we already converted to meter here
+	// (or the top nodes matrix and the camera clip planes do, with IOSN_FBX_GLTF_ROOTCONVERSION)
 	//double scale =_scene->GetGlobalSettings ().GetSystemUnit ().GetScaleFactor () / 100. ;
 
 	// Up axis - Y up axis. The scene already got converted to Maya Y up axis
@@ -24,6 +24,7 @@
 namespace _IOglTF_NS_ {
 
 bool gltfWriter::WriteBuffer () {
+	gltfStats::scope phase (_stats, "WriteBuffer") ;
 	Json::Value buffer ;
 	FbxString filename =FbxPathUtils::GetFileName ((_fileName).c_str (), false) ;
 	buffer [("name")] =filename.Buffer () ;
@@ -32,12 +33,14 @@ bool gltfWriter::WriteBuffer () {
 	// The Buffer file should be fully completed by now.
 	if ( GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_EMBEDMEDIA, false) ) {
 		// data:[<mime type>][;charset=<charset>][;base64],<encoded data>
-		buffer [("uri")] =IOglTF::dataURI (_bin) ;
+		// Encoded while serializing, see gltfDataURIs
+		buffer [("uri")] =_dataURIs.defer (IOglTF::mimeType (("")), _bin.vec ()) ;
 	}
 
 	if ( _writeDefaults )
 		buffer [("type")] =("arraybuffer") ; ; // default is arraybuffer
-	buffer [("byteLength")] =((int)_bin.tellg ()) ;
+	buffer [("byteLength")] =((Json::UInt64)_bin.tellg ()) ;
+	_stats.gauge ("memoryStream", _bin.footprint ()) ;
 
 	_json [("buffers")] [filename.Buffer ()] =buffer ;
 	return (true) ;
@@ -76,6 +76,7 @@ double gltfWriter::cameraYFOV (FbxCamera *pCamera) {
 }
 
 Json::Value gltfWriter::WriteCamera (FbxNode *pNode) {
+	gltfStats::scope phase (_stats, "WriteCamera") ;
 	Json::Value camera;
 	Json::Value cameraDef;
 	camera [("name")] =nodeId (pNode, true) ;
@@ -96,8 +97,8 @@ Json::Value gltfWriter::WriteCamera (FbxNode *pNode) {
 			cameraDef [("aspectRatio")] =(pCamera->FilmAspectRatio.Get()) ; // (pCamera->AspectWidth / pCamera->AspectHeight) ;
 			//cameraDef [("yfov")] =(DEG2RAD(pCamera->FieldOfView)) ;
 			cameraDef [("yfov")] =(GLTF_ANGLE (cameraYFOV (pCamera))) ;
-			cameraDef [("zfar")] =(pCamera->FarPlane.Get()) ;
-			cameraDef [("znear")] =(pCamera->NearPlane.Get()) ;
+			cameraDef [("zfar")] =(pCamera->FarPlane.Get() * _unitScale) ;
+			cameraDef [("znear")] =(pCamera->NearPlane.Get() * _unitScale) ;
 			camera [("perspective")] =cameraDef ;
 			break ;
 		case FbxCamera::EProjectionType::eOrthogonal:
@@ -106,8 +107,8 @@ Json::Value gltfWriter::WriteCamera (FbxNode *pNode) {
 			//cameraDef [("ymag")] =(pCamera->_2DMagnifierY) ;
 			cameraDef [("xmag")] =(pCamera->OrthoZoom.Get()) ;
 			cameraDef [("ymag")] =(pCamera->OrthoZoom.Get()) ; // FBX Collada reader set OrthoZoom using xmag and ymag each time they appear
-			cameraDef [("zfar")] =(pCamera->FarPlane.Get()) ;
-			cameraDef [("znear")] =(pCamera->NearPlane.Get()) ;
+			cameraDef [("zfar")] =(pCamera->FarPlane.Get() * _unitScale) ;
+			cameraDef [("znear")] =(pCamera->NearPlane.Get() * _unitScale) ;
 			camera [("orthographic")] =cameraDef ;
 			break ;
 		default:
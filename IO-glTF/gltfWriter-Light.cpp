@@ -56,6 +56,7 @@ void gltfWriter::lightAttenuation (FbxLight *pLight, Json::Value &lightDef) {
 }
 
 Json::Value gltfWriter::WriteLight (FbxNode *pNode) {
+	gltfStats::scope phase (_stats, "WriteLight") ;
 	Json::Value light ;
 	Json::Value lightDef ;
 	light [("name")] =nodeId (pNode, true) ;
@@ -78,6 +78,7 @@ FbxArray<FbxVector4> GetVertexPositions (FbxLine *pLine, bool bInGeometry =true,
 
 //-----------------------------------------------------------------------------
 Json::Value gltfWriter::WriteLine (FbxNode *pNode) {
+	gltfStats::scope phase (_stats, "WriteLine") ;
 #ifdef GG
 	Json::Value lineDef  ;
 	lineDef [("name")] =(nodeId (pNode, true)) ;
@@ -44,7 +44,9 @@ std::string gltfWriter::LighthingModel (FbxSurfaceMaterial *pMaterial) {
 }
 
 Json::Value gltfWriter::WriteMaterial (FbxNode *pNode, FbxSurfaceMaterial *pMaterial) {
+	gltfStats::scope phase (_stats, "WriteMaterial") ;
 	std::string materialName =pMaterial->GetNameWithoutNameSpacePrefix ().Buffer () ; // Material do not support namespaces.
+	phase.arg ("material", materialName) ;
 
 	// Look if this material is already in the materials library.
 	//if ( _json [("materials")].isMember (materialName) )
@@ -145,6 +147,7 @@ Json::Value gltfWriter::WriteMaterial (FbxNode *pNode, FbxSurfaceMaterial *pMate
 }
 
 Json::Value gltfWriter::WriteDefaultMaterial (FbxNode *pNode) {
+	gltfStats::scope phase (_stats, "WriteMaterial") ;
 	std::string materialName (("defaultMaterial")) ;
 
 	// Look if this material is already in the materials library.
@@ -244,9 +247,9 @@ Json::Value gltfWriter::WriteMaterialParameter (const char *pszName, FbxProperty
 		return (ret) ;
 	if ( property.GetSrcObjectCount<FbxTexture> () != 0 ) {
 		FbxTexture *pTexture =property.GetSrcObject<FbxTexture> (0) ;
-		values [pszName] =(createTextureName (pTexture->GetName ())) ;
-		techniqueParameters [pszName] [("type")] = IOglTF::SAMPLER_2D ;
 		ret =WriteTexture (pTexture) ;
+		values [pszName] =(GetJsonFirstKey (ret [("textures")])) ;
+		techniqueParameters [pszName] [("type")] = IOglTF::SAMPLER_2D ;
 	} else {
 		FbxDouble3 color =property.Get () ;
 		MultiplyDouble3By (color, factor) ;
@@ -266,9 +269,9 @@ Json::Value gltfWriter::WriteMaterialParameter (const char *pszName, FbxProperty
 		return (ret) ;
 	if ( property.GetSrcObjectCount<FbxTexture> () != 0 ) {
 		FbxTexture *pTexture =property.GetSrcObject<FbxTexture> (0) ;
-		values [pszName] =(createTextureName (pTexture->GetName ())) ;
-		techniqueParameters [pszName] [("type")] = IOglTF::SAMPLER_2D ;
 		ret =WriteTexture (pTexture) ;
+		values [pszName] =(GetJsonFirstKey (ret [("textures")])) ;
+		techniqueParameters [pszName] [("type")] = IOglTF::SAMPLER_2D ;
 	} else {
 		double value =property.Get () ;
 		values [pszName] =(value) ;
@@ -282,9 +285,9 @@ Json::Value gltfWriter::WriteMaterialParameter (const char *pszName, FbxSurfaceM
 	FbxProperty property =pMaterial->FindProperty (propertyName, FbxColor3DT, false) ;
 	if ( property.IsValid () && property.GetSrcObjectCount<FbxTexture> () != 0 ) {
 		FbxTexture *pTexture =property.GetSrcObject<FbxTexture> (0) ;
-		values [pszName] =(createTextureName (pTexture->GetName ())) ;
-		techniqueParameters [pszName] [("type")] = IOglTF::SAMPLER_2D ;
 		ret =WriteTexture (pTexture) ;
+		values [pszName] =(GetJsonFirstKey (ret [("textures")])) ;
+		techniqueParameters [pszName] [("type")] = IOglTF::SAMPLER_2D ;
 	} else {
 		FbxProperty factorProperty =pMaterial->FindProperty (factorName, FbxDoubleDT, false) ;
 		double factor =factorProperty.IsValid () ? factorProperty.Get<FbxDouble> () : 1. ;
@@ -26,7 +26,25 @@
 namespace _IOglTF_NS_ {
 
 //-----------------------------------------------------------------------------
+// The vertex attributes the primitive and its program consume, only these are extracted and take part in the
+// vertex indexing / welding. Tangents and binormals are never written (so no technique gets a TEXTANGENT /
+// TEXBINORMAL), and texcoords are declared by the program of a mesh material only. No generated program reads
+// a COLOR attribute (see glslTech), so vertex colors are skipped too and primitives get no COLOR_0 accessor.
+// Normals are always written when present.
+unsigned int gltfWriter::VertexAttributes (FbxNode *pNode) {
+	return (gltfVertexAttributesOf (pNode)) ;
+}
+
+uint64_t gltfWriter::MeshCacheKey (FbxNode *pNode) {
+	FbxMesh *pMesh =pNode->GetMesh () ;
+	auto iter =_meshKeys.find (pMesh) ;
+	if ( iter == _meshKeys.end () )
+		iter =_meshKeys.insert (std::make_pair (pMesh, _meshCache.key (pMesh))).first ;
+	return (gltfHashCombine (iter->second, VertexAttributes (pNode))) ;
+}
+
 Json::Value gltfWriter::WriteMesh (FbxNode *pNode) {
+	gltfStats::scope phase (_stats, "WriteMesh") ;
 	Json::Value meshDef  ;
 	meshDef [("name")] =(nodeId (pNode, true)) ;
 
@@ -58,7 +76,11 @@ Json::Value gltfWriter::WriteMesh (FbxNode *pNode) {
 	textures[("textures")] = Json::Value( Json::objectValue ) ;
 
 	FbxMesh *pMesh =pNode->GetMesh () ; //FbxCast<FbxMesh>(pNode->GetNodeAttribute ()) ;
+	// The triangulator job reads the mesh, wait for it before anything writes to the mesh. nullptr if the
+	// mesh was not queued (cached), in which case the VBO triangulates it if it is a cache miss after all.
+	const gltfTriangulator::triangles *pTriangles =_triangulator.get (pMesh) ;
 	pMesh->ComputeBBox () ;
+	size_t binStart =_bin.vec ().size () ;
 
 	// FBX Layers works like Photoshop layers
 	// - Vertices, Polygons and Edges are not on layers, but every other elements can
@@ -85,56 +107,134 @@ Json::Value gltfWriter::WriteMesh (FbxNode *pNode) {
 ////	{ ("colors"), Json::Value::object () }
 ////}) ;
 	Json::Value localAccessorsAndBufferViews  ;
+	Json::Value polygons ;
+	bool bNormals =false ;
+	Json::UInt64 nbUnique =0 ;
+	bool bUIntIndices =false ;
 
-	gltfwriterVBO vbo (pMesh) ;
-	vbo.GetLayerElements (true) ;
-	vbo.indexVBO () ;
-
-	std::vector<unsigned short> out_indices =vbo.getIndices () ;
-	std::vector<FbxDouble3> out_positions =vbo.getPositions () ;
-	std::vector<FbxDouble3> out_normals =vbo.getNormals () ;
-	std::vector<FbxDouble2> out_uvs =vbo.getUvs () ;
-	std::vector<FbxDouble3> out_tangents =vbo.getTangents () ;
-	std::vector<FbxDouble3> out_binormals =vbo.getBinormals () ;
-	std::vector<FbxColor> out_vcolors =vbo.getVertexColors () ;
-
-	_uvSets =vbo.getUvSets () ;
-
-	Json::Value vertex =WriteArrayWithMinMax<FbxDouble3, float> (out_positions, pMesh->GetNode (), ("_Positions")) ;
-	MergeJsonObjects (localAccessorsAndBufferViews, vertex);
-	primitive [("attributes")] [("POSITION")] =(GetJsonFirstKey (vertex [("accessors")])) ;
-
-	if ( out_normals.size () ) {
-		std::string st (("_Normals")) ;
-		Json::Value ret =WriteArrayWithMinMax<FbxDouble3, float> (out_normals, pMesh->GetNode (), st.c_str ()) ;
-		MergeJsonObjects (localAccessorsAndBufferViews, ret) ;
-		st=("NORMAL") ;
-		primitive [("attributes")] [st] =(GetJsonFirstKey (ret [("accessors")])) ;
+	// An unchanged mesh is copied back from the cache, with its ids and offsets rebased on this node/buffer
+	uint64_t cacheKey =0 ;
+	Json::Value cached ;
+	if ( _meshCache.enabled () ) {
+		cacheKey =MeshCacheKey (pNode) ;
+		bool bHit =_meshCache.lookup (cacheKey, cached, _bin) ;
+		_stats.count (bHit ? "meshCacheHits" : "meshCacheMisses", 1) ;
+		if ( !bHit )
+			cached =Json::Value () ;
 	}
+	std::string prefix =nodeId (pNode, true) ;
+	if ( cached.isObject () ) {
+		FbxString filename =FbxPathUtils::GetFileName (_fileName.c_str (), false) ;
+		localAccessorsAndBufferViews =gltfMeshCache::absolute (cached [("vertices")], prefix, filename.Buffer (), binStart) ;
+		polygons =gltfMeshCache::absolute (cached [("polygons")], prefix, filename.Buffer (), binStart) ;
+		const Json::Value &attributes =cached [("attributes")] ;
+		for ( Json::Value::const_iterator iter =attributes.begin () ; iter != attributes.end () ; iter++ )
+			primitive [("attributes")] [iter.memberName ()] =prefix + (*iter).asString () ;
+		primitive [("indices")] =prefix + cached [("indices")].asString () ;
+		_uvSets.clear () ;
+		const Json::Value &uvSets =cached [("uvSets")] ;
+		for ( Json::Value::const_iterator iter =uvSets.begin () ; iter != uvSets.end () ; iter++ )
+			_uvSets [iter.memberName ()] =(*iter).asString () ;
+		bNormals =cached [("normals")].asBool () ;
+		nbUnique =cached [("unique")].asUInt64 () ;
+		bUIntIndices =cached [("uintIndices")].asBool () ;
+	} else {
+		if ( pTriangles )
+			_stats.count ("triangles", pTriangles->count ()) ;
+		gltfwriterVBO vbo (pMesh, &_transforms, pTriangles) ;
+		vbo.GetLayerElements (true, VertexAttributes (pNode)) ;
+		for ( unsigned int skipped =vbo.skippedAttributes () ; skipped ; skipped &=skipped - 1 )
+			_stats.count ("skippedAttributes", 1) ;
+		if ( _weld.enabled () )
+			vbo.weldVBO (_weld) ;
+		else
+			vbo.indexVBO (&_pool) ;
 
-	if ( out_uvs.size () ) { // todo more than 1
-		std::map<std::string, std::string>::iterator iter =_uvSets.begin () ;
-		std::string st (("_") + iter->second) ;
-		Json::Value ret =WriteArrayWithMinMax<FbxDouble2, float> (out_uvs, pMesh->GetNode (), st.c_str ()) ;
-		MergeJsonObjects (localAccessorsAndBufferViews, ret) ;
-		primitive [("attributes")] [iter->second] =(GetJsonFirstKey (ret [("accessors")])) ;
-	}
+		std::vector<unsigned int> out_indices =vbo.getIndices () ;
+		std::vector<FbxDouble3> out_positions =vbo.getPositions () ;
+		std::vector<FbxDouble3> out_normals =vbo.getNormals () ;
+		std::vector<FbxDouble2> out_uvs =vbo.getUvs () ;
+		std::vector<FbxDouble3> out_tangents =vbo.getTangents () ;
+		std::vector<FbxDouble3> out_binormals =vbo.getBinormals () ;
 
-	int nb=(int)out_vcolors.size () ;
-	if ( nb ) {
-		std::vector<FbxDouble4> vertexColors_ (nb);
-		for ( int i =0 ; i < nb ; i++ )
-			vertexColors_.push_back (FbxDouble4 (out_vcolors [i].mRed, out_vcolors [i].mGreen, out_vcolors [i].mBlue, out_vcolors [i].mAlpha)) ;
-		std::string st (("_Colors0")) ;
-		Json::Value ret =WriteArrayWithMinMax<FbxDouble4, float> (vertexColors_, pMesh->GetNode (), st.c_str ()) ;
-		MergeJsonObjects (localAccessorsAndBufferViews, ret) ;
-		st =("COLOR_0") ;
-		primitive [("attributes")] [st] =(GetJsonFirstKey (ret [("accessors")])) ;
-	}
+		_uvSets =vbo.getUvSets () ;
+		_stats.gauge ("gltfwriterVBO",
+			  out_indices.capacity () * sizeof (unsigned int)
+			+ (out_positions.capacity () + out_normals.capacity () + out_tangents.capacity () + out_binormals.capacity ()) * sizeof (FbxDouble3)
+			+ out_uvs.capacity () * sizeof (FbxDouble2)
+		) ;
+
+		Json::Value vertex =WriteArrayWithMinMax<FbxDouble3, float> (out_positions, pMesh->GetNode (), ("_Positions")) ;
+		MergeJsonObjects (localAccessorsAndBufferViews, vertex);
+		primitive [("attributes")] [("POSITION")] =(GetJsonFirstKey (vertex [("accessors")])) ;
+
+		if ( out_normals.size () ) {
+			std::string st (("_Normals")) ;
+			Json::Value ret =WriteArrayWithMinMax<FbxDouble3, float> (out_normals, pMesh->GetNode (), st.c_str ()) ;
+			MergeJsonObjects (localAccessorsAndBufferViews, ret) ;
+			st=("NORMAL") ;
+			primitive [("attributes")] [st] =(GetJsonFirstKey (ret [("accessors")])) ;
+		}
 
-	// Get mesh face indices
-	Json::Value polygons =WriteArray<unsigned short> (out_indices, 1, pMesh->GetNode (), ("_Polygons")) ;
-	primitive [("indices")] =(GetJsonFirstKey (polygons [("accessors")])) ;
+		if ( out_uvs.size () ) { // todo more than 1
+			std::map<std::string, std::string>::iterator iter =_uvSets.begin () ;
+			std::string st (("_") + iter->second) ;
+			Json::Value ret =WriteArrayWithMinMax<FbxDouble2, float> (out_uvs, pMesh->GetNode (), st.c_str ()) ;
+			MergeJsonObjects (localAccessorsAndBufferViews, ret) ;
+			primitive [("attributes")] [iter->second] =(GetJsonFirstKey (ret [("accessors")])) ;
+		}
+
+		// Get mesh face indices, 32 bits ones only when the vertices do not fit 16 bits
+		bUIntIndices =out_positions.size () > 0xffff ;
+		if ( bUIntIndices ) {
+			polygons =WriteArray<unsigned int> (out_indices, 1, pMesh->GetNode (), ("_Polygons")) ;
+		} else {
+			std::vector<unsigned short> out_shortIndices (out_indices.begin (), out_indices.end ()) ;
+			polygons =WriteArray<unsigned short> (out_shortIndices, 1, pMesh->GetNode (), ("_Polygons")) ;
+		}
+		primitive [("indices")] =(GetJsonFirstKey (polygons [("accessors")])) ;
+		bNormals =out_normals.size () != 0 ;
+		nbUnique =(Json::UInt64)out_positions.size () ;
+		if ( _weld.enabled () ) {
+			_weldCorners +=vbo.inputVertices () ;
+			_weldVertices +=nbUnique ;
+			_stats.count ("weldedVertices", vbo.inputVertices () - out_positions.size ()) ;
+		}
+
+		if ( _meshCache.enabled () ) {
+			Json::Value meta ;
+			meta [("vertices")] =gltfMeshCache::relative (localAccessorsAndBufferViews, prefix, binStart) ;
+			meta [("polygons")] =gltfMeshCache::relative (polygons, prefix, binStart) ;
+			meta [("attributes")] =Json::Value (Json::objectValue) ;
+			const Json::Value &attributes =primitive [("attributes")] ;
+			for ( Json::Value::const_iterator iter =attributes.begin () ; iter != attributes.end () ; iter++ )
+				meta [("attributes")] [iter.memberName ()] =(*iter).asString ().substr (prefix.size ()) ;
+			meta [("indices")] =primitive [("indices")].asString ().substr (prefix.size ()) ;
+			meta [("uvSets")] =Json::Value (Json::objectValue) ;
+			for ( auto iter : _uvSets )
+				meta [("uvSets")] [iter.first] =iter.second ;
+			meta [("normals")] =bNormals ;
+			meta [("unique")] =nbUnique ;
+			meta [("uintIndices")] =bUIntIndices ;
+			if ( !_meshCache.store (cacheKey, meta, _bin.vec ().data () + binStart, _bin.vec ().size () - binStart) )
+				std::cout << "Warning: cannot store " << pNode->GetName () << " in the mesh cache" << std::endl ;
+		}
+	}
+	// glTF 1.0 indices are unsigned short unless the OES_element_index_uint extension is declared
+	if ( bUIntIndices ) {
+		Json::Value &extensionsUsed =_json [("extensionsUsed")] ;
+		bool bDeclared =false ;
+		for ( Json::Value::iterator iter =extensionsUsed.begin () ; iter != extensionsUsed.end () ; iter++ )
+			bDeclared |=(*iter).asString () == "OES_element_index_uint" ;
+		if ( !bDeclared )
+			extensionsUsed.append ("OES_element_index_uint") ;
+		_stats.count ("uintIndices", 1) ;
+	}
+	phase.arg ("node", pNode->GetName ()) ;
+	phase.arg ("vertices", pMesh->GetPolygonVertexCount ()) ;
+	phase.arg ("unique", nbUnique) ;
+	phase.arg ("bytes", (Json::UInt64)(_bin.vec ().size () - binStart)) ;
+	phase.arg ("cached", cached.isObject ()) ;
 
 	MergeJsonObjects (accessorsAndBufferViews, polygons) ;
 	MergeJsonObjects (accessorsAndBufferViews, localAccessorsAndBufferViews) ;
@@ -158,7 +258,7 @@ Json::Value gltfWriter::WriteMesh (FbxNode *pNode) {
 
 			std::string techniqueName =GetJsonFirstKey (ret [("techniques")]) ;
 			Json::Value techniqueParameters =ret [("techniques")] [techniqueName] [("parameters")] ;
-			AdditionalTechniqueParameters (pNode, techniqueParameters, out_normals.size () != 0) ;
+			AdditionalTechniqueParameters (pNode, techniqueParameters, bNormals) ;
 			TechniqueParameters (pNode, techniqueParameters, primitive [("attributes")], localAccessorsAndBufferViews [("accessors")], false) ;
 			ret =WriteTechnique (pNode, nullptr, techniqueParameters) ;
 			//MergeJsonObjects (techniques, ret) ;
@@ -199,7 +299,7 @@ Json::Value gltfWriter::WriteMesh (FbxNode *pNode) {
 
 			std::string techniqueName =GetJsonFirstKey (ret [("techniques")]) ;
 			Json::Value techniqueParameters =ret [("techniques")] [techniqueName] [("parameters")] ;
-			AdditionalTechniqueParameters (pNode, techniqueParameters, out_normals.size () != 0) ;
+			AdditionalTechniqueParameters (pNode, techniqueParameters, bNormals) ;
 			TechniqueParameters (pNode, techniqueParameters, primitive [("attributes")], localAccessorsAndBufferViews [("accessors")]) ;
 			ret =WriteTechnique (pNode, pNode->GetMaterial (i), techniqueParameters) ;
 			//MergeJsonObjects (techniques, ret) ;
@@ -25,6 +25,7 @@ namespace _IOglTF_NS_ {
 
 //-----------------------------------------------------------------------------
 Json::Value gltfWriter::WriteNull (FbxNode *pNode) {
+	gltfStats::scope phase (_stats, "WriteNull") ;
 	Json::Value node =WriteNode (pNode) ;
 	Json::Value ret ;
 	ret["nodes"] =node ;
@@ -24,6 +24,7 @@
 namespace _IOglTF_NS_ {
 
 Json::Value gltfWriter::WriteProgram (FbxNode *pNode, FbxSurfaceMaterial *pMaterial, std::string programName, Json::Value &attributes) {
+	gltfStats::scope phase (_stats, "WriteProgram") ;
 	Json::Value programAttributes ;
 	auto memberNames = attributes.getMemberNames();
 	for ( const auto &name : memberNames )
@@ -24,6 +24,7 @@
 namespace _IOglTF_NS_ {
 
 bool gltfWriter::WriteScene (FbxScene *pScene, int poseIndex /*=-1*/) {
+	gltfStats::scope phase (_stats, "WriteScene") ;
 	FbxNode *pRoot =pScene->GetRootNode () ;
 	FbxPose *pPose =poseIndex >= 0 ? pScene->GetPose (poseIndex) : nullptr ;
 	std::string szName = (pScene->GetName ()) ;
@@ -35,7 +36,12 @@ bool gltfWriter::WriteScene (FbxScene *pScene, int poseIndex /*=-1*/) {
 	//FbxDouble3 rotation =pRoot->LclRotation.Get () ;
 	//FbxDouble3 scaling =pRoot->LclScaling.Get () ;
 
-	WriteSceneNodeRecursive (pRoot, pPose, true) ;
+	if ( _filter.active () ) {
+		for ( FbxNode *pNode : _filter.roots () )
+			WriteSceneNodeRecursive (pNode, pPose, true) ;
+	} else {
+		WriteSceneNodeRecursive (pRoot, pPose, true) ;
+	}
 
 	return (true) ;
 }
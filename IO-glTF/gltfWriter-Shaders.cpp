@@ -25,6 +25,7 @@
 namespace _IOglTF_NS_ {
 
 bool gltfWriter::WriteShaders () {
+	gltfStats::scope phase (_stats, "WriteShaders") ;
 	//Json::Value buffer  ;
 	//FbxString filename =FbxPathUtils::GetFileName (utility::conversions::to_utf8string (_fileName).c_str (), false) ;
 	//buffer [("name")] =(utility::conversions::to_string_t (filename.Buffer ())) ;
@@ -51,24 +52,38 @@ bool gltfWriter::WriteShaders () {
 	//}
 
 
-	Json::Value materials =_json [("materials")] ;
+	// Materials with the same feature set get the same sources: generate them once, and point the
+	// programs to the first shaders written for that set
+	std::string lightsKey =glslTech::lightsKey (_json) ;
+	std::map<std::string, std::pair<std::string, std::string> > shared ;
+	const Json::Value &materials =_json [("materials")] ;
 	auto memberNames = materials.getMemberNames();
 	for ( auto &name : memberNames ) {
 		std::string techniqueName = materials[name] [("technique")].asString () ;
-		glslTech tech (
-			_json [("techniques")] [techniqueName],
-			materials[name] [("values")],
-			_json
-		) ;
+		std::shared_ptr<const glslTech::sources> tech =_shaderLibrary.get (_json [("techniques")] [techniqueName], _json, lightsKey) ;
 
 		std::string programName =_json [("techniques")] [techniqueName] [("program")].asString () ;
 		std::string vsName =_json [("programs")] [programName] [("vertexShader")].asString () ;
 		std::string fsName =_json [("programs")] [programName] [("fragmentShader")].asString () ;
-		
+
+		auto iter =shared.find (tech->_key) ;
+		if ( iter != shared.end () ) {
+			if ( iter->second.first != vsName ) {
+				_json [("shaders")].removeMember (vsName) ;
+				_json [("programs")] [programName] [("vertexShader")] =iter->second.first ;
+			}
+			if ( iter->second.second != fsName ) {
+				_json [("shaders")].removeMember (fsName) ;
+				_json [("programs")] [programName] [("fragmentShader")] =iter->second.second ;
+			}
+			continue ;
+		}
+		shared [tech->_key] =std::make_pair (vsName, fsName) ;
+
 		if ( GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_EMBEDMEDIA, false) ) {
 			// data:[<mime type>][;charset=<charset>][;base64],<encoded data>
-			_json [("shaders")] [vsName] [("uri")] =(IOglTF::dataURI (tech.vertexShader ().source ())) ;
-			_json [("shaders")] [fsName] [("uri")] =(IOglTF::dataURI (tech.fragmentShader ().source ())) ;
+			_json [("shaders")] [vsName] [("uri")] =(IOglTF::dataURI (vsName + (".glsl"), std::vector<uint8_t> (tech->_vertexShader.begin (), tech->_vertexShader.end ()))) ;
+			_json [("shaders")] [fsName] [("uri")] =(IOglTF::dataURI (fsName + (".glsl"), std::vector<uint8_t> (tech->_fragmentShader.begin (), tech->_fragmentShader.end ()))) ;
 		} else {
 			FbxString gltfFilename ((_fileName).c_str ()) ;
 			std::string vsFilename =_json [("shaders")] [vsName] [("uri")].asString () ;
@@ -77,11 +92,11 @@ bool gltfWriter::WriteShaders () {
 #if defined(_WIN32) || defined(_WIN64)
 				shaderFilename =FbxPathUtils::GetFolderName (gltfFilename) + "\\" + shaderFilename ;
 #else
-				shaderFilename =FbxPathUtils::GetFolderName (vsFilename.c_str()) + "/" + shaderFilename ;
+				shaderFilename =FbxPathUtils::GetFolderName (gltfFilename) + "/" + shaderFilename ;
 #endif
 				std::fstream shaderFile (shaderFilename, std::ios::out | std::ofstream::binary) ;
 				//_bin.seekg (0, std::ios_base::beg) ;
-				shaderFile.write (tech.vertexShader ().source ().c_str (), tech.vertexShader ().source ().length ()) ;
+				shaderFile.write (tech->_vertexShader.c_str (), tech->_vertexShader.length ()) ;
 				shaderFile.close () ;
 			}
 			std::string fsFilename =_json [("shaders")] [fsName] [("uri")].asString () ;
@@ -90,15 +105,16 @@ bool gltfWriter::WriteShaders () {
 #if defined(_WIN32) || defined(_WIN64)
 				shaderFilename =FbxPathUtils::GetFolderName (gltfFilename) + "\\" + shaderFilename ;
 #else
-				shaderFilename =FbxPathUtils::GetFolderName (fsFilename.c_str()) + "/" + shaderFilename ;
+				shaderFilename =FbxPathUtils::GetFolderName (gltfFilename) + "/" + shaderFilename ;
 #endif
 				std::fstream shaderFile (shaderFilename, std::ios::out | std::ofstream::binary) ;
 				//_bin.seekg (0, std::ios_base::beg) ;
-				shaderFile.write (tech.fragmentShader ().source ().c_str (), tech.fragmentShader ().source ().length ()) ;
+				shaderFile.write (tech->_fragmentShader.c_str (), tech->_fragmentShader.length ()) ;
 				shaderFile.close () ;
 			}
 		}
 	}
+	phase.arg ("featureSets", (Json::UInt64)_shaderLibrary.size ()) ;
 	return (true) ;
 }
 
@@ -136,6 +136,7 @@ void gltfWriter::TechniqueParameters (FbxNode *pNode, Json::Value &techniquePara
 }
 
 Json::Value gltfWriter::WriteTechnique (FbxNode *pNode, FbxSurfaceMaterial *pMaterial, Json::Value &techniqueParameters) {
+	gltfStats::scope phase (_stats, "WriteTechnique") ;
 	// The FBX SDK does not have such attribute. At best, it is an attribute of a Shader FX, CGFX or HLSL.
 	Json::Value commonProfile ;
 	commonProfile[("doubleSided")] = false ;
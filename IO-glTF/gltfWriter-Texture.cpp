@@ -29,56 +29,83 @@ namespace _IOglTF_NS_ {
 //	std::cout << ("\t  ") << j << (".- ") << arrayTextures.GetAt (j)->GetName () << std::endl
 //	   << ("\t  ") << j << (".- ") << ((FbxFileTexture *)arrayTextures.GetAt (j))->GetFileName () << std::endl;
 
+// Returns the image, sampler and texture records used by this texture. Identical records are shared, so
+// ret ["textures"] first key is the texture id to reference from the material values.
 Json::Value gltfWriter::WriteTexture (FbxTexture *pTexture) {
+	gltfStats::scope phase (_stats, "WriteTexture") ;
 	std::string name =(pTexture->GetNameWithoutNameSpacePrefix ().Buffer ()) ;
 	std::string uri =(FbxCast<FbxFileTexture> (pTexture)->GetRelativeFileName ()) ;
+	FbxString imageFile =FbxCast<FbxFileTexture> (pTexture)->GetFileName () ;
 	Json::Value ret;
-	auto &image = ret["images"];
-	auto &namedImage = image[name];
-	namedImage[("name")] = (name) ;
-	namedImage[("uri")] = (uri) ;
-	
-	if ( GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_EMBEDMEDIA, false) ) {
-		// data:[<mime type>][;charset=<charset>][;base64],<encoded data>
-		FbxString imageFile =FbxCast<FbxFileTexture> (pTexture)->GetFileName () ;
-		image [name] [("uri")] =(IOglTF::dataURI ((imageFile.Buffer ()))) ;
-	} /*else*/
-	if ( GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_COPYMEDIA, false) ) {
-		FbxString path =FbxPathUtils::GetFolderName ((_fileName).c_str ()) ;
-#if defined(_WIN32) || defined(_WIN64)
-		path +="\\" ;
-#else
-		path +="/" ;
-#endif
-		FbxString imageFile =FbxCast<FbxFileTexture> (pTexture)->GetFileName () ;
-		std::ifstream src (imageFile.Buffer (), std::ios::binary) ;
-		std::ofstream dst (path + FbxPathUtils::GetFileName (imageFile), std::ios::binary) ;
-		dst << src.rdbuf () ;
+
+	std::string source =gltfTextureManager::resolvePath (imageFile.Buffer ()) ;
+	std::map<std::string, std::string>::iterator imageIter =_imageIds.find (source) ;
+	std::string imageName ;
+	if ( imageIter == _imageIds.end () ) {
+		imageName =createMediaId (name) ;
+		_imageIds [source] =imageName ;
+		auto &namedImage = ret["images"][imageName];
+		namedImage[("name")] = (imageName) ;
+		// --copy / --embed: the file is copied or encoded (once per unique file) on the worker pool,
+		// and the final uri is patched in PostprocessScene ()
+		namedImage[("uri")] = (_textures.add (imageName, imageFile.Buffer (), uri)) ;
+	} else {
+		imageName =imageIter->second ;
+	}
+
+	std::tuple<int, int, int, int> samplerState (
+		(int)IOglTF::LINEAR,
+		(int)IOglTF::LINEAR_MIPMAP_LINEAR,
+		(int)(pTexture->WrapModeU.Get () == FbxTexture::eRepeat ? IOglTF::REPEAT : IOglTF::CLAMP_TO_EDGE),
+		(int)(pTexture->WrapModeV.Get () == FbxTexture::eRepeat ? IOglTF::REPEAT : IOglTF::CLAMP_TO_EDGE)
+	) ;
+	std::map<std::tuple<int, int, int, int>, std::string>::iterator samplerIter =_samplerIds.find (samplerState) ;
+	std::string samplerName ;
+	if ( samplerIter == _samplerIds.end () ) {
+		samplerName =createMediaId (("sampler_") + utility::conversions::to_string_t ((int)_samplerIds.size ())) ;
+		_samplerIds [samplerState] =samplerName ;
+		auto &samplerDef = ret["samplers"][samplerName];
+		samplerDef[("name")] = (samplerName);
+		samplerDef[("magFilter")] = std::get<0> (samplerState) ;
+		samplerDef[("minFilter")] = std::get<1> (samplerState) ;
+		samplerDef[("wrapS")] = std::get<2> (samplerState) ;
+		samplerDef[("wrapT")] = std::get<3> (samplerState) ;
+	} else {
+		samplerName =samplerIter->second ;
 	}
 
-	std::string texName =createTextureName (pTexture->GetNameWithoutNameSpacePrefix ()) ;
-	std::string samplerName =createSamplerName (pTexture->GetNameWithoutNameSpacePrefix ()) ;
-	
+	std::pair<std::string, std::string> textureKey (imageName, samplerName) ;
+	std::map<std::pair<std::string, std::string>, std::string>::iterator textureIter =_textureIds.find (textureKey) ;
+	std::string texName ;
+	if ( textureIter == _textureIds.end () ) {
+		texName =createMediaId (createTextureName (pTexture->GetNameWithoutNameSpacePrefix ())) ;
+		_textureIds [textureKey] =texName ;
+	} else {
+		texName =textureIter->second ;
+	}
+	// Always returned, so the caller can read the texture id back
 	auto &textureDef = ret["textures"][texName];
 	textureDef[("name")] = (texName);
 	textureDef[("format")] = ((int)IOglTF::RGBA);
 	textureDef[("internalFormat")] = ((int)IOglTF::RGBA);
-	textureDef[("sampler")] = (samplerName); // todo do I need one everytime
-	textureDef[("source")] = (name);
+	textureDef[("sampler")] = (samplerName);
+	textureDef[("source")] = (imageName);
 	textureDef[("target")] = ((int)IOglTF::TEXTURE_2D) ;
 	textureDef[("type")] = ((int)IOglTF::UNSIGNED_BYTE) ;
-	
-	//TODO: Shall try to find a similar sampler defined already vs create one each time?
-	auto &samplerDef = ret["samplers"][samplerName];
-	samplerDef[("name")] = (samplerName);
-	samplerDef[("magFilter")] = ((int)IOglTF::LINEAR) ;
-	samplerDef[("minFilter")] = ((int)IOglTF::LINEAR_MIPMAP_LINEAR) ;
-	samplerDef[("wrapS")] = ((int)(pTexture->WrapModeU.Get () == FbxTexture::eRepeat ? IOglTF::REPEAT : IOglTF::CLAMP_TO_EDGE)) ;
-	samplerDef[("wrapT")] = ((int)(pTexture->WrapModeV.Get () == FbxTexture::eRepeat ? IOglTF::REPEAT : IOglTF::CLAMP_TO_EDGE)) ;
 
 	return ret;
 }
 
+// images, samplers and textures ids share one namespace, this avoids a texture named after an image
+// of a different file overwriting it
+std::string gltfWriter::createMediaId (const std::string &name) {
+	std::string id (name) ;
+	for ( int i =1 ; _mediaIds.find (id) != _mediaIds.end () ; i++ )
+		id =name + ("_") + utility::conversions::to_string_t (i) ;
+	_mediaIds.insert (id) ;
+	return (id) ;
+}
+
 Json::Value gltfWriter::WriteTextureBindings (FbxMesh *pMesh, FbxSurfaceMaterial *pMaterial, Json::Value &params) {
 	return false ;
 }
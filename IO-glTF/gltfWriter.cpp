@@ -20,6 +20,7 @@
 //
 #include "StdAfx.h"
 #include "gltfWriter.h"
+#include "gltfHash.h"
 #ifdef _DEBUG
 #include "JsonPrettify.h"
 #endif
@@ -68,7 +69,7 @@ std::string GetJsonObjectKeyAt (Json::Value &a, int i) {
 //-----------------------------------------------------------------------------
 gltfWriter::gltfWriter (FbxManager &pManager, int id)
 	: FbxWriter (pManager, id, FbxStatusGlobal::GetRef ()),
-	  _fileName(), _writeDefaults(true)
+	  _fileName(), _writeDefaults(true), _textures(&_pool, &_dataURIs), _unitScale(1.), _weldCorners(0), _weldVertices(0)
 { 
 	_samplingPeriod =1. / 30. ;
 }
@@ -80,6 +81,21 @@ gltfWriter::~gltfWriter () {
 bool gltfWriter::FileCreate (char *pFileName) {
 	FbxString fileName =FbxPathUtils::Clean (pFileName) ;
 	_fileName = (fileName.Buffer ()) ;
+	_stats.reset (
+		!GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_STATSFILE, FbxString ("")).IsEmpty (),
+		!GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_TRACEFILE, FbxString ("")).IsEmpty ()
+	) ;
+	FbxString weld =GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_WELD, FbxString ("")) ;
+	if ( !_weld.parse (weld.Buffer ()) )
+		std::cout << "Warning: invalid weld tolerances " << weld.Buffer () << ", welding disabled" << std::endl ;
+	_weldCorners =_weldVertices =0 ;
+	// The welding tolerances are the only export option changing the mesh buffers, the key depends on them
+	// and on the writer version
+	FbxString meshCache =GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_MESHCACHE, FbxString ("")) ;
+	std::string weldSpec =_weld.spec () ;
+	uint64_t meshCacheSeed =gltfHashCombine (gltfHash64 (FBX_GLTF_EXPORTER, strlen (FBX_GLTF_EXPORTER)), gltfHash64 (weldSpec.data (), weldSpec.size ())) ;
+	if ( !_meshCache.reset (meshCache.Buffer (), meshCacheSeed) )
+		std::cout << "Warning: cannot create the mesh cache folder " << meshCache.Buffer () << std::endl ;
 
 	//std::string path =_GLTF_NAMESPACE_::GetModulePath () ;
 	std::string path = ((const char *)FbxGetApplicationDirectory ()) ;
@@ -106,29 +122,65 @@ bool gltfWriter::FileCreate (char *pFileName) {
 }
 
 bool gltfWriter::FileClose () {
-	PrepareForSerialization () ;
+	{
+		gltfStats::scope closePhase (_stats, "FileClose") ;
+		PrepareForSerialization () ;
+		if ( _stats.enabled () )
+			_stats.gauge ("json", gltfMemory::footprint (_json)) ;
+		std::string temp ;
+		{
+			gltfStats::scope phase (_stats, "Serialize") ;
 #ifdef _DEBUG
-	Json::StyledWriter writer;
-	writer.write( _json );
+			Json::StyledWriter writer;
 #else
-	Json::FastWriter writer;
-	auto temp = writer.write( _json );
-	_gltf.write( temp.c_str(), temp.length() ) ;
+			Json::FastWriter writer;
 #endif
-	_gltf.close () ;
-
-	// If media saved in file, gltfWriter::PostprocessScene / gltfWriter::WriteBuffer should have embed the data already
-	if ( !GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_EMBEDMEDIA, false) ) {
-		FbxString fileName ( (_fileName).c_str ()) ;
+			temp = writer.write( _json );
+		}
+		_stats.gauge ("jsonText", temp.capacity ()) ;
+		{
+			gltfStats::scope phase (_stats, "FileIO") ;
+			// Embedded buffers and images are only placeholders in _json, encode them straight into the file
+			_dataURIs.write (_gltf, temp) ;
+			if ( _gltf.is_open () )
+				_stats.count ("jsonBytes", (uint64_t)_gltf.tellp ()) ;
+			_gltf.close () ;
+
+			// If media saved in file, gltfWriter::PostprocessScene / gltfWriter::WriteBuffer should have embed the data already
+			if ( !GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_EMBEDMEDIA, false) ) {
+				FbxString fileName ( (_fileName).c_str ()) ;
 #if defined(_WIN32) || defined(_WIN64)
-		fileName =FbxPathUtils::GetFolderName (fileName) + "\\" + FbxPathUtils::GetFileName (fileName, false) + ".bin" ;
+				fileName =FbxPathUtils::GetFolderName (fileName) + "\\" + FbxPathUtils::GetFileName (fileName, false) + ".bin" ;
 #else
-		fileName =FbxPathUtils::GetFolderName (fileName) + "/" + FbxPathUtils::GetFileName (fileName, false) + ".bin" ;
+				fileName =FbxPathUtils::GetFolderName (fileName) + "/" + FbxPathUtils::GetFileName (fileName, false) + ".bin" ;
 #endif
-		std::ofstream binFile (fileName, std::ios::out | std::ofstream::binary) ;
-		//_bin.seekg (0, std::ios_base::beg) ;
-		binFile.write ((const char *)_bin.rdbuf (), _bin.vec ().size ()) ;
-		binFile.close () ;
+				std::ofstream binFile (fileName, std::ios::out | std::ofstream::binary) ;
+				//_bin.seekg (0, std::ios_base::beg) ;
+				binFile.write ((const char *)_bin.rdbuf (), _bin.vec ().size ()) ;
+				binFile.close () ;
+				_stats.count ("binBytes", _bin.vec ().size ()) ;
+			}
+		}
+	}
+	// FileClose () is called again from the destructor, report once only
+	if ( _weld.enabled () && _weldCorners ) {
+		std::cout << "Welding: " << _weldCorners << " corner(s) to " << _weldVertices << " vertices ("
+			<< (100. * _weldVertices / _weldCorners) << "%)" << std::endl ;
+		_weldCorners =_weldVertices =0 ;
+	}
+	if ( _meshCache.enabled () && _meshCache.hits () + _meshCache.misses () ) {
+		std::cout << "Mesh cache: " << _meshCache.hits () << " hit(s), " << _meshCache.misses () << " miss(es), "
+			<< _meshCache.stores () << " stored" << std::endl ;
+		_meshCache.reset ("", 0) ;
+	}
+	if ( _stats.enabled () ) {
+		FbxString statsFile =GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_STATSFILE, FbxString ("")) ;
+		if ( !statsFile.IsEmpty () && !_stats.save (statsFile.Buffer ()) )
+			std::cout << "Warning: cannot write the statistics file " << statsFile.Buffer () << std::endl ;
+		FbxString traceFile =GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_TRACEFILE, FbxString ("")) ;
+		if ( _stats.tracing () && !_stats.saveTrace (traceFile.Buffer (), true) )
+			std::cout << "Warning: cannot write the trace file " << traceFile.Buffer () << std::endl ;
+		_stats.reset (false) ;
 	}
 	return (true) ;
 }
@@ -190,11 +242,42 @@ bool gltfWriter::IsGeometryNode (FbxNode *pNode) {
 }
 
 bool gltfWriter::PreprocessScene (FbxScene &scene) {
+	gltfStats::scope phase (_stats, "PreprocessScene") ;
 	//FbxSceneRenamer renamer (&pScene) ; // Rename ALL the nodes from FBX to Collada since GLTF is mainly based on Collada
 	//renamer.RenameFor (FbxSceneRenamer::eFBX_TO_DAE) ;
 
 	FbxNode *pRootNode =scene.GetRootNode () ;
-	PreprocessNodeRecursive (pRootNode) ;
+	_transforms.clear () ;
+	_triangulator.clear () ;
+	_meshKeys.clear () ;
+	_shaderLibrary.clear () ;
+	_rootConversion.SetIdentity () ;
+	_unitScale =1. ;
+	if ( GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_ROOTCONVERSION, false) ) {
+		_rootConversion =RootConversion (scene) ;
+		_unitScale =scene.GetGlobalSettings ().GetSystemUnit ().GetConversionFactorTo (FbxSystemUnit::m) ;
+	}
+	FbxString filter =GetIOSettings ()->GetStringProp (IOSN_FBX_GLTF_NODEFILTER, FbxString ("")) ;
+	if ( !_filter.parse (filter.Buffer ()) )
+		std::cout << "Warning: invalid node filter, some rules were ignored" << std::endl ;
+	if ( _filter.active () ) {
+		_filter.select (pRootNode) ;
+		phase.arg ("exportedNodes", (Json::UInt64)_filter.exportedCount ()) ;
+		for ( FbxNode *pNode : _filter.roots () )
+			PreprocessNodeRecursive (pNode) ;
+	} else {
+		PreprocessNodeRecursive (pRootNode) ;
+	}
+	_dataURIs.clear () ;
+	_imageIds.clear () ;
+	_samplerIds.clear () ;
+	_textureIds.clear () ;
+	_mediaIds.clear () ;
+	_textures.reset (
+		FbxPathUtils::GetFolderName (_fileName.c_str ()).Buffer (),
+		GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_COPYMEDIA, false),
+		GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_EMBEDMEDIA, false)
+	) ;
 
 	/*if ( mSingleMatrix ) {
 		lRootNode->ResetPivotSetAndConvertAnimation (1. / mSamplingPeriod.GetSecondDouble ());
@@ -242,13 +325,22 @@ bool gltfWriter::PreprocessScene (FbxScene &scene) {
 }
 
 void gltfWriter::PreprocessNodeRecursive (FbxNode *pNode) {
+	if ( _filter.active () && !_filter.kept (pNode) )
+		return ;
 	FbxVector4 postR ;
 	FbxNodeAttribute const *nodeAttribute =pNode->GetNodeAttribute () ;
 	// Set PivotState to active to ensure ConvertPivotAnimationRecursive() execute correctly. 
 	pNode->SetPivotState (FbxNode::eSourcePivot, FbxNode::ePivotActive) ;
 	pNode->SetPivotState (FbxNode::eDestinationPivot, FbxNode::ePivotActive) ;
 	// ~
+	// Evaluate the node transforms once, parents are visited before their children
+	_transforms.record (pNode) ;
 	if ( nodeAttribute ) {
+		// Meshes the cache has are copied back, they are never triangulated
+		if (   nodeAttribute->GetAttributeType () == FbxNodeAttribute::eMesh && (!_filter.active () || _filter.exported (pNode))
+			&& !(_meshCache.enabled () && _meshCache.contains (MeshCacheKey (pNode)))
+		)
+			_triangulator.queue (pNode->GetMesh (), _pool) ;
 		//// Special transformation conversion cases. If spotlight or directional light, 
 		//// rotate node so spotlight is directed at the X axis (was Z axis).
 		//if ( nodeAttribute->GetAttributeType () == FbxNodeAttribute::eLight ) {
@@ -291,20 +383,13 @@ void gltfWriter::PreprocessNodeRecursive (FbxNode *pNode) {
 //	pMesh =FbxCast<FbxMesh> (lConverter.Triangulate (pMesh, true));
 
 bool gltfWriter::PostprocessScene (FbxScene &scene) {
+	gltfStats::scope phase (_stats, "PostprocessScene") ;
 	/*Json::Value val =WriteAmbientLight (pScene) ;
 	for ( const auto &iter : val.as_object () )
 		_json [("lights")] [iter.first] =iter.second ;
 	*/
-	//if ( GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_COPYMEDIA, false) ) {
-	//#if defined(_WIN32) || defined(_WIN64)
-	//	FbxString path =FbxPathUtils::GetFolderName (utility::conversions::to_utf8string (_fileName).c_str ()) + "\\" ;
-	//#else
-	//	FbxString path =FbxPathUtils::GetFolderName (utility::conversions::to_utf8string (_fileName).c_str ()) + "/" ;
-	//#endif
-	//	for ( const auto &iter : _json [("images")].as_object () ) {
-	//	}
-	//		
-	//}
+	// Media copies and encodings were queued by WriteTexture () and ran while the geometry was written
+	_textures.finalize (_json [("images")], _json [("textures")]) ;
 
 	return (true) ;
 }
@@ -335,6 +420,13 @@ bool gltfWriter::PostprocessScene (FbxScene &scene) {
 		FbxProperty myOption =pIOS.AddProperty (pluginGroup, GLTF_INVERTTRANSPARENCY, FbxBoolDT, "Invert Transparency [bool]", &defaultValue, true) ;
 		myOption =pIOS.AddProperty (pluginGroup, GLTF_DEFAULTLIGHTING, FbxBoolDT, "Enable Default Lighting [bool]", &defaultValue, true) ;
 		myOption =pIOS.AddProperty (pluginGroup, GLTF_COPYMEDIA, FbxBoolDT, "Copy Media [bool]", &defaultValue, true) ;
+		FbxString defaultFile ("") ;
+		myOption =pIOS.AddProperty (pluginGroup, GLTF_STATSFILE, FbxStringDT, "Phase Timings Report [json file]", &defaultFile, true) ;
+		myOption =pIOS.AddProperty (pluginGroup, GLTF_TRACEFILE, FbxStringDT, "Chrome Trace [json file]", &defaultFile, true) ;
+		myOption =pIOS.AddProperty (pluginGroup, GLTF_MESHCACHE, FbxStringDT, "Mesh Cache [folder]", &defaultFile, true) ;
+		myOption =pIOS.AddProperty (pluginGroup, GLTF_NODEFILTER, FbxStringDT, "Node Filter [root|include|exclude|type lines]", &defaultFile, true) ;
+		myOption =pIOS.AddProperty (pluginGroup, GLTF_WELD, FbxStringDT, "Vertex Welding Tolerances [position,normal,uv,color]", &defaultFile, true) ;
+		myOption =pIOS.AddProperty (pluginGroup, GLTF_ROOTCONVERSION, FbxBoolDT, "Axis and Unit Conversion on the Root Nodes [bool]", &defaultValue, true) ;
 		//myOption =pIOS.AddProperty (pluginGroup, GLTF_EMBEDMEDIA, FbxBoolDT, "Embed all Resources as Data URIs [bool]", &defaultValue, eFbxBool) ;
 	}
 }
@@ -412,6 +504,8 @@ std::string gltfWriter::createUniqueName (std::string type, FbxUInt64 id) {
 
 //-----------------------------------------------------------------------------
 Json::Value gltfWriter::WriteSceneNodeRecursive (FbxNode *pNode, FbxPose *pPose /*=nullptr*/, bool bRoot /*=false*/) {
+	if ( _filter.active () && !_filter.kept (pNode) )
+		return (Json::Value (Json::nullValue)) ;
 	//if ( !WriteSceneNode (pNode, pPose) )
 	//	//return (GetStatus ().SetCode (FbxStatus::eFailure, "Could not export node " + pNode->GetName () + "!"), false) ;
 	//	return (false) ;
@@ -527,6 +621,9 @@ Json::Value gltfWriter::WriteSceneNode (FbxNode *pNode, FbxPose *pPose) {
 	//	std::cout << (" << ") << st  ;
 	//std::cout << std::endl ;
 #endif
+	// Filtered out, but some descendants are exported
+	if ( _filter.active () && !_filter.exported (pNode) )
+		return (WriteNull (pNode)) ;
 	ExporterRouteFct fct =(*(_routes.find (enodeType))).second ;
 	Json::Value val =(this->*fct) (pNode) ;
 //	Json::Value val =WriteNull (pNode) ;
@@ -574,20 +671,12 @@ Json::Value gltfWriter::GetTransform (FbxNode *pNode) {
 	//		return (true) ;
 	//}
 
-	FbxAMatrix identity ;
-	identity.SetIdentity () ;
-	FbxAMatrix thisLocal ;
-	// For Single Matrix situation, obtain transform matrix from eDestinationPivot, which include pivot offsets and pre/post rotations.
-	FbxAMatrix &thisGlobal =const_cast<FbxNode *>(pNode)->EvaluateGlobalTransform (FBXSDK_TIME_ZERO, FbxNode::eDestinationPivot) ;
-	const FbxNode *pParentNode =pNode->GetParent () ;
-	if ( pParentNode ) {
-		// For Single Matrix situation, obtain transform matrix from eDestinationPivot, which include pivot offsets and pre/post rotations.
-		FbxAMatrix &parentGlobal =const_cast<FbxNode *>(pParentNode)->EvaluateGlobalTransform (FBXSDK_TIME_ZERO, FbxNode::eDestinationPivot) ;
-		FbxAMatrix parentInverted =parentGlobal.Inverse () ;
-		thisLocal =parentInverted * thisGlobal ;
-	} else {
-		thisLocal =thisGlobal ;
-	}
+	// The local matrix was evaluated once in PreprocessScene (eDestinationPivot, which include pivot offsets and pre/post rotations)
+	// The root of an exported subtree keeps its place in the scene
+	FbxAMatrix thisLocal =_filter.isRoot (pNode) ? _transforms.global (pNode) : _transforms.local (pNode) ;
+	// The axis / unit conversion of an unconverted scene applies above the top nodes only
+	if ( _filter.isRoot (pNode) || pNode->GetParent () == nullptr )
+		thisLocal =_rootConversion * thisLocal ;
 
 	FbxAMatrix::kDouble44 &r =thisLocal.Double44 () ;
 	Json::Value ar( Json::arrayValue ) ;
@@ -598,6 +687,23 @@ Json::Value gltfWriter::GetTransform (FbxNode *pNode) {
 	return (ar) ;
 }
 
+// The matrix FbxAxisSystem::MayaYUp and FbxSystemUnit::m ConvertScene () would set on the root node children.
+// They are run on an empty scene with the same axis system and unit, the exported scene is left untouched
+// and its nodes / geometries keep their original values.
+FbxAMatrix gltfWriter::RootConversion (FbxScene &scene) {
+	FbxScene *pScene =FbxScene::Create (scene.GetFbxManager (), "") ;
+	pScene->GetGlobalSettings ().SetAxisSystem (scene.GetGlobalSettings ().GetAxisSystem ()) ;
+	pScene->GetGlobalSettings ().SetSystemUnit (scene.GetGlobalSettings ().GetSystemUnit ()) ;
+	FbxNode *pNode =FbxNode::Create (pScene, "") ;
+	pScene->GetRootNode ()->AddChild (pNode) ;
+	FbxAxisSystem::MayaYUp.ConvertScene (pScene) ;
+	if ( pScene->GetGlobalSettings ().GetSystemUnit () != FbxSystemUnit::m )
+		FbxSystemUnit::m.ConvertScene (pScene) ;
+	FbxAMatrix ret =pNode->EvaluateGlobalTransform () ;
+	pScene->Destroy () ;
+	return (ret) ;
+}
+
 //-----------------------------------------------------------------------------
 Json::Value gltfWriter::WriteNode (FbxNode *pNode) {
 	Json::Value nodeDef  ;
@@ -626,11 +732,13 @@ Json::Value gltfWriter::WriteNode (FbxNode *pNode) {
 		nodeDef [("jointName")] =(("JOINT")) ;
 	}
 	
+	// Nodes filtered out are written as transforms only
+	bool bAttribute =!_filter.active () || _filter.exported (pNode) ;
 	//if ( szType == ("mesh") )
-	if ( pNode->GetNodeAttribute () && pNode->GetNodeAttribute ()->GetAttributeType () == FbxNodeAttribute::eMesh )
+	if ( bAttribute && pNode->GetNodeAttribute () && pNode->GetNodeAttribute ()->GetAttributeType () == FbxNodeAttribute::eMesh )
 		nodeDef [("meshes")][0] = (nodeId (pNode, true)) ;
 	//if ( szType == ("camera") || szType == ("light") )
-	if (   pNode->GetNodeAttribute ()
+	if (   bAttribute && pNode->GetNodeAttribute ()
 		&& (   pNode->GetNodeAttribute ()->GetAttributeType () == FbxNodeAttribute::eCamera
 			|| pNode->GetNodeAttribute ()->GetAttributeType () == FbxNodeAttribute::eLight)
 	)
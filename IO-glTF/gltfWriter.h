@@ -23,6 +23,10 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include "jsoncpp/json.h"
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include "glslShader.h"
 
 #define FBX_GLTF_EXPORTER ("FBX GLTF Exporter v1.0")
 #define PROFILE_API ("WebGL")
@@ -62,6 +66,35 @@ private:
 	std::map<FbxUInt64, std::string> _IDs ;
 	std::vector<std::string> _registeredNames ;
 	std::map<std::string, std::string> _uvSets ;
+	gltfTransformCache _transforms ;
+	gltfDataURIs _dataURIs ;
+	gltfTextureManager _textures ;
+	// Media records are interned: images by source file, samplers by their (magFilter, minFilter, wrapS, wrapT)
+	// state, and textures by their (image, sampler) pair
+	std::map<std::string, std::string> _imageIds ;
+	std::map<std::tuple<int, int, int, int>, std::string> _samplerIds ;
+	std::map<std::pair<std::string, std::string>, std::string> _textureIds ;
+	std::set<std::string> _mediaIds ;
+	// Per phase wall time, only collected when IOSN_FBX_GLTF_STATSFILE names a report file
+	gltfStats _stats ;
+	// Processed mesh buffers from previous exports, only used when IOSN_FBX_GLTF_MESHCACHE names a folder
+	gltfMeshCache _meshCache ;
+	std::unordered_map<FbxMesh *, uint64_t> _meshKeys ; // instanced meshes are hashed once
+	// Generated shader sources of the document, per feature set
+	glslTechLibrary _shaderLibrary ;
+	// Mesh triangles, computed on _pool while the scene is preprocessed
+	gltfTriangulator _triangulator ;
+	// Part of the scene to export (IOSN_FBX_GLTF_NODEFILTER), everything when inactive
+	gltfNodeFilter _filter ;
+	// Y up / meter correction of the top nodes, when IOSN_FBX_GLTF_ROOTCONVERSION leaves the scene unconverted
+	FbxAMatrix _rootConversion ;
+	// Scene unit to meter factor of the distances the matrix cannot carry (camera clip planes), 1 when converted
+	double _unitScale ;
+	// Vertex welding tolerances (IOSN_FBX_GLTF_WELD), and the polygon corners / vertices of the welded meshes
+	gltfWeldTolerances _weld ;
+	uint64_t _weldCorners, _weldVertices ;
+	// Declared last, so it is destroyed (and its queued jobs run) before the members the jobs refer to
+	threadPool _pool ;
 #ifdef _DEBUG
 	std::vector<std::string> _path ;
 #endif
@@ -102,6 +135,7 @@ public:
 	inline std::string createSamplerName (const char *pszName) { return (("sampler_") + std::string(pszName)) ; }
 	inline std::string createTextureName (FbxString &szname) { return (("texture_") + std::string(szname.Buffer ())) ; }
 	inline std::string createTextureName (const char *pszName) { return (("texture_") + std::string(pszName)) ; }
+	std::string createMediaId (const std::string &name) ;
 
 protected:
 	Json::Value WriteSceneNodeRecursive (FbxNode *pNode, FbxPose *pPose =nullptr, bool bRoot =false) ;
@@ -113,6 +147,7 @@ protected:
 	void PreprocessNodeRecursive (FbxNode *pNode) ;
 	Json::Value WriteNode (FbxNode *pNode) ;
 	Json::Value GetTransform (FbxNode *pNode) ;
+	FbxAMatrix RootConversion (FbxScene &scene) ;
 
 	// The following list is json nodes generated by other json nodes
 	// accessor / bufferView
@@ -146,6 +181,8 @@ protected:
 	Json::Value WriteDefaultShadingModelMaterial (FbxNode *pNode) ;
 	// mesh
 	Json::Value WriteMesh (FbxNode *pNode) ;
+	unsigned int VertexAttributes (FbxNode *pNode) ;
+	uint64_t MeshCacheKey (FbxNode *pNode) ;
 	// line
 	//Json::Value WriteLine (FbxNode *pNode) ;
 	// null
@@ -208,8 +245,8 @@ Json::Value gltfWriter::WriteArray (std::vector<Type> &data, int size, FbxNode *
 	FbxString filename =FbxPathUtils::GetFileName (_fileName.c_str (), false) ;
 	viewDef [("buffer")] =filename.Buffer () ;
 	size_t nb =data.size () / size ;
-	viewDef [("byteLength")] =((int)(sizeof (Type) * nb * size)) ;
-	viewDef [("byteOffset")] =((int)offset) ;
+	viewDef [("byteLength")] =((Json::UInt64)(sizeof (Type) * nb * size)) ;
+	viewDef [("byteOffset")] =((Json::UInt64)offset) ;
 	// Array buffers (ARRAY_BUFFER) : These buffers contain vertex attributes, such as vertex coordinates, texture coordinate data,
 	// per vertex - color data, and normals.They can be interleaved (using the stride parameter) or sequential, with one array after
 	// another (write 1, 000 vertices, then 1, 000 normals, and so on).glVertexPointer and glNormalPointer each point to the appropriate offsets.
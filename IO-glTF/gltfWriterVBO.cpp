@@ -20,59 +20,38 @@
 //
 #include "StdAfx.h"
 #include "gltfwriterVBO.h"
+#include "gltfLayerElementReader.h"
 
 namespace _IOglTF_NS_ {
 
 //-----------------------------------------------------------------------------
-// Function    : getSimilarVertexIndex
-// Abstraction : Find the Packed Vertex from the existing map, if found return true else return false
-bool gltfwriterVBO::getSimilarVertexIndex (PackedVertex &packed, std::map<PackedVertex, unsigned short> &VertexToOutIndex, unsigned short &result) {
-	std::map<PackedVertex, unsigned short>::iterator it =VertexToOutIndex.find (packed) ;
-	if ( it == VertexToOutIndex.end () )
-		return (false) ;
-	result =it->second ;
-	return (true) ;
-}
-
 // Function    : indexVBO()
-// Abstraction : 1. Pack positions, uvs, normals, vertex colors in to single entity (packedVertex)
-//               2. Search the packed vertex in the Index List
-//               3. If found, don't add it just use the existing one. If NOT found then add them into list
-void gltfwriterVBO::indexVBO () {
-	std::map<PackedVertex, unsigned short> VertexToOutIndex;
-	// For each input vertex
-	for ( unsigned int i =0 ; i < _in_positions.size () ; i++ ) {
-		FbxDouble2 in_uv =i < _in_uvs.size () ? _in_uvs [i] : FbxDouble2 () ;
-		FbxDouble3 in_normal =i < _in_normals.size () ? _in_normals [i] : FbxDouble3 () ;
-		FbxDouble3 in_tangent =i < _in_tangents.size () ? _in_tangents [i] : FbxDouble3 () ;
-		FbxDouble3 in_binormal =i < _in_binormals.size () ? _in_binormals [i] : FbxDouble3 () ;
-		FbxColor in_vcolor =i < _in_vcolors.size () ? _in_vcolors [i] : FbxColor () ;
-
-		PackedVertex packed ={ _in_positions [i], in_uv, in_normal, in_tangent, in_binormal, in_vcolor } ;
-
-		// Try to find a similar vertex in out_XXXX
-		unsigned short index ;
-		bool found =getSimilarVertexIndex (packed, VertexToOutIndex, index) ;
-		if ( found ) { // A similar vertex is already in the VBO, use it instead !
-			_out_indices.push_back (index) ;
-		} else { // If not, it needs to be added in the output data.
-			_out_positions.push_back (_in_positions [i]) ;
-			if ( _in_uvs.size () )
-				_out_uvs.push_back (in_uv) ;
-			if ( _in_normals.size () )
-				_out_normals.push_back (in_normal) ;
-			if ( _in_tangents.size () )
-				_out_tangents.push_back (in_tangent) ;
-			if ( _in_binormals.size () )
-				_out_binormals.push_back (in_binormal) ;
-			if ( _in_vcolors.size () )
-				_out_vcolors.push_back (in_vcolor) ;
+// Abstraction : Merge the triangle corners which have the same position, uv, normal, tangent, binormal and
+//               vertex color into a single glTF vertex. The kernel is chosen on the attributes the mesh has.
+//               Large meshes are indexed on the pool threads, when given.
+static const size_t sParallelIndexCorners =1 << 18 ;
+
+void gltfwriterVBO::indexVBO (threadPool *pPool /*=nullptr*/) {
+	if ( _bControlPoints )
+		gltfVertexKernels::indexPoints (_in, _cornerPoints, _out) ;
+	else if ( pPool && pPool->size () > 1 && _in._positions.size () >= sParallelIndexCorners )
+		gltfVertexKernels::indexParallel (_in, _out, *pPool) ;
+	else
+		gltfVertexKernels::index (_in, _out) ;
+}
 
-			index =(unsigned short)_out_positions.size () - 1 ;
-			VertexToOutIndex [packed] =index ;
-			_out_indices.push_back (index) ;
-		}
+// Function    : weldVBO()
+// Abstraction : indexVBO () with tolerances (see gltfVertexKernel::weld ())
+void gltfwriterVBO::weldVBO (const gltfWeldTolerances &tolerances) {
+	// Welding merges control points too, it needs the corners
+	if ( _bControlPoints ) {
+		gltfVertexStreams corners ;
+		gltfVertexKernels::expand (_in, _cornerPoints, corners) ;
+		_in =std::move (corners) ;
+		_cornerPoints.clear () ;
+		_bControlPoints =false ;
 	}
+	gltfVertexKernels::weld (_in, _out, tolerances) ;
 }
 
 // Function    : GetVertexPositions
@@ -93,7 +72,7 @@ FbxArray<FbxVector4> gltfwriterVBO::GetVertexPositions (bool bInGeometry, bool b
 
 	if ( bExportControlPoints ) {
 		if ( !bInGeometry ) {
-			FbxAMatrix transform =_pMesh->GetNode ()->EvaluateGlobalTransform () ;
+			FbxAMatrix transform =globalTransform (_pMesh->GetNode ()) ;
 			for ( int i =0 ; i < nbControlPoints ; i++ )
 				controlPoints [i] =transform.MultT (controlPoints [i]) ;
 		}
@@ -110,7 +89,7 @@ FbxArray<FbxVector4> gltfwriterVBO::GetVertexPositions (bool bInGeometry, bool b
 		int clusterCount =FbxCast<FbxSkin> (_pMesh->GetDeformer (FbxDeformer::eSkin))->GetClusterCount () ;
 		for ( int indexLink =0 ; indexLink < clusterCount ; indexLink++ ) {
 			FbxCluster *pLink =FbxCast<FbxSkin> (_pMesh->GetDeformer (FbxDeformer::eSkin))->GetCluster (indexLink) ;
-			FbxAMatrix jointPosition =pLink->GetLink ()->EvaluateGlobalTransform () ;
+			FbxAMatrix jointPosition =globalTransform (pLink->GetLink ()) ;
 			FbxAMatrix transformLink ;
 			pLink->GetTransformLinkMatrix (transformLink) ;
 			FbxAMatrix m =transformLink.Inverse () * jointPosition ;
@@ -127,6 +106,14 @@ FbxArray<FbxVector4> gltfwriterVBO::GetVertexPositions (bool bInGeometry, bool b
 	return (positions) ;
 }
 
+// Function    : globalTransform
+// Abstraction : Get the node global matrix from the writer transform cache, or from the FBX evaluator when used standalone
+FbxAMatrix gltfwriterVBO::globalTransform (FbxNode *pNode) {
+	if ( _pTransforms )
+		return (_pTransforms->global (pNode)) ;
+	return (pNode->EvaluateGlobalTransform ()) ;
+}
+
 // Function : GetLayerElements
 FbxArray<FbxLayerElement::EType> myGetAllChannelUV (FbxMesh *pMesh) {
 	FbxArray<FbxLayerElement::EType> ret ;
@@ -153,7 +140,7 @@ FbxArray<FbxLayerElement::EType> myGetAllChannelUV (FbxMesh *pMesh) {
 	return (ret) ;
 }
 
-void gltfwriterVBO::GetLayerElements (bool bInGeometry /*=true*/) {
+void gltfwriterVBO::GetLayerElements (bool bInGeometry /*=true*/, unsigned int attributes /*=eVertexAllAttributes*/) {
 
     // ambient: material.ambientColorMap | material.ambientColor | [0, 0, 0, 1]
     // diffuse: material.diffuseColorMap | material.diffuseColor | [0, 0, 0, 1]
@@ -171,6 +158,11 @@ void gltfwriterVBO::GetLayerElements (bool bInGeometry /*=true*/) {
 
 	FbxArray<FbxVector4> vertices =GetVertexPositions (bInGeometry, (clusterCount == 0)) ; // Vertex Positions
 	FbxLayerElementNormal *pLayerElementNormals =elementNormals () ; // Normals
+	_skipped =0 ;
+	if ( pLayerElementNormals && !(attributes & eVertexNormal) ) {
+		pLayerElementNormals =nullptr ;
+		_skipped |=eVertexNormal ;
+	}
 
 #define _GetAllChannelUV_ 1
 #ifndef _GetAllChannelUV_
@@ -193,6 +185,12 @@ void gltfwriterVBO::GetLayerElements (bool bInGeometry /*=true*/) {
 	// UV or Vertex Color
 	std::map<FbxLayerElement::EType, FbxLayerElementUV *> channels ;
 	int nbLayers =_pMesh->GetLayerCount () ;
+	if ( !(attributes & eVertexUV) ) {
+		// No texcoord binding either, the technique would refer to an attribute the primitive does not have
+		if ( elementUVs (FbxLayerElement::eTextureDiffuse) )
+			_skipped |=eVertexUV ;
+		nbLayers =0 ;
+	}
 	for ( int iLayer =0 ; iLayer < nbLayers ; iLayer++ ) {
 		FbxArray<FbxLayerElement::EType> uvChannels =_pMesh->GetAllChannelUV (iLayer) ;
 		for ( int i =0 ; i < uvChannels.GetCount () ; i++ ) {
@@ -216,46 +214,74 @@ void gltfwriterVBO::GetLayerElements (bool bInGeometry /*=true*/) {
 	FbxGeometryElementTangent *pLayerTangents =elementTangents () ; // Tangents
 	FbxGeometryElementBinormal *pLayerBinormals =elementBinormals () ; // Binormals
 	FbxLayerElementVertexColor *pLayerElementColors =elementVcolors () ; // Vertex Color
+	if ( pLayerTangents && !(attributes & eVertexTangent) ) {
+		pLayerTangents =nullptr ;
+		_skipped |=eVertexTangent ;
+	}
+	if ( pLayerBinormals && !(attributes & eVertexBinormal) ) {
+		pLayerBinormals =nullptr ;
+		_skipped |=eVertexBinormal ;
+	}
+	if ( pLayerElementColors && !(attributes & eVertexColor) ) {
+		pLayerElementColors =nullptr ;
+		_skipped |=eVertexColor ;
+	}
 
-	int nb =_pMesh->GetPolygonCount () ;
-	for ( int i =0, index =0 ; i < nb ; i++ ) {
-		int count =_pMesh->GetPolygonSize (i) ;
-		_ASSERTE( count == 3 ) ; // We forced triangulation, so we expect '3' here
-		for ( int v =0 ; v < count ; v++, index++ ) {
-			int vertexID =_pMesh->GetPolygonVertex (i, v) ;
-			// In an ordinary geometry, export the control points.
-			// In a binded geometry, export transformed control points...
-			// In a controller, export the control points.
-			FbxVector4 position =vertices [vertexID] ; // pMesh->GetControlPoints () [vertexID] ;
-			_in_positions.push_back (position) ;
-
-			GetLayerElement (pLayerElementNormals, normalIndex, FbxVector4, normal, index, [this] (FbxVector4 &V) {
-				_in_normals.push_back (V) ;
-			}) ;
-			FbxLayerElementUV *pLayerElementUVs =channels [FbxLayerElement::eTextureDiffuse] ;
-			GetLayerElement (pLayerElementUVs, uvIndex, FbxVector2, uv, index, [this] (FbxVector2 &V) {
-				V [1] =1.0 - V [1] ;
-				_in_uvs.push_back (V) ;
-			}) ;
-			GetLayerElement (pLayerTangents, tangentIndex, FbxVector4, tangent, index, [this] (FbxVector4 &V) {
-				_in_tangents.push_back (V) ;
-			}) ;
-			GetLayerElement (pLayerBinormals, binormalIndex, FbxVector4, binormal, index, [this] (FbxVector4 &V) {
-				_in_binormals.push_back (V) ;
-			}) ;
-			GetLayerElement (pLayerElementColors, colorIndex, FbxColor, color, index, [this] (FbxColor &V) {
-				_in_vcolors.push_back (V) ;
-			}) ;
-		}
+	// The scene meshes are not triangulated, use the writer triangles or triangulate here when used standalone
+	gltfTriangulator::triangles localTriangles ;
+	const gltfTriangulator::triangles *pTriangles =_pTriangles ;
+	if ( pTriangles == nullptr ) {
+		gltfTriangulator::triangulate (_pMesh, localTriangles) ;
+		pTriangles =&localTriangles ;
+	}
+	// In an ordinary geometry, export the control points.
+	// In a binded geometry, export transformed control points...
+	// In a controller, export the control points.
+	const int *pPolygonVertices =_pMesh->GetPolygonVertices () ;
+	size_t nb =pTriangles->_corners.size () ;
+	gltfLayerElementReader<FbxVector4> normals (_pMesh, pLayerElementNormals) ;
+	gltfLayerElementReader<FbxVector2> uvs (_pMesh, channels [FbxLayerElement::eTextureDiffuse]) ;
+	gltfLayerElementReader<FbxVector4> tangents (_pMesh, pLayerTangents) ;
+	gltfLayerElementReader<FbxVector4> binormals (_pMesh, pLayerBinormals) ;
+	gltfLayerElementReader<FbxColor> colors (_pMesh, pLayerElementColors) ;
+	auto toDouble3 =[] (const FbxVector4 &V) { return (FbxDouble3 (V [0], V [1], V [2])) ; } ;
+	auto toUV =[] (const FbxVector2 &V) { return (FbxDouble2 (V [0], 1.0 - V [1])) ; } ;
+	auto toColor =[] (const FbxColor &V) { return (V) ; } ;
+
+	// When no attribute tells the corners of a control point apart, read the attributes per control point
+	// and keep the control point of every corner, indexVBO () then hashes control points instead of corners
+	_bControlPoints =normals.perControlPoint () && uvs.perControlPoint () && tangents.perControlPoint ()
+		&& binormals.perControlPoint () && colors.perControlPoint () ;
+	if ( _bControlPoints ) {
+		int nbControlPoints =vertices.GetCount () ;
+		_in._positions.reserve (nbControlPoints) ;
+		for ( int i =0 ; i < nbControlPoints ; i++ )
+			_in._positions.push_back (vertices [i]) ;
+		_cornerPoints.reserve (nb) ;
+		for ( size_t i =0 ; i < nb ; i++ )
+			_cornerPoints.push_back (pPolygonVertices [pTriangles->_corners [i]]) ;
+		normals.gatherControlPoints (nbControlPoints, _in._normals, toDouble3) ;
+		uvs.gatherControlPoints (nbControlPoints, _in._uvs, toUV) ;
+		tangents.gatherControlPoints (nbControlPoints, _in._tangents, toDouble3) ;
+		binormals.gatherControlPoints (nbControlPoints, _in._binormals, toDouble3) ;
+		colors.gatherControlPoints (nbControlPoints, _in._vcolors, toColor) ;
+		return ;
 	}
+
+	_in._positions.reserve (nb) ;
+	for ( size_t i =0 ; i < nb ; i++ )
+		_in._positions.push_back (vertices [pPolygonVertices [pTriangles->_corners [i]]]) ;
+	normals.gather (*pTriangles, _in._normals, toDouble3) ;
+	uvs.gather (*pTriangles, _in._uvs, toUV) ;
+	tangents.gather (*pTriangles, _in._tangents, toDouble3) ;
+	binormals.gather (*pTriangles, _in._binormals, toDouble3) ;
+	colors.gather (*pTriangles, _in._vcolors, toColor) ;
 }
 
 FbxLayerElementNormal *gltfwriterVBO::elementNormals (int iLayer /*=-1*/)  {
 	if ( iLayer != -1 ) {
 		FbxLayer *pLayer =_pMesh->GetLayer (iLayer) ;
 		FbxLayerElementNormal *pLayerElementNormals =pLayer->GetNormals () ;
-		if ( pLayerElementNormals && pLayerElementNormals->GetMappingMode () != FbxLayerElement::eByPolygonVertex )
-			pLayerElementNormals->RemapIndexTo (FbxLayerElement::eByPolygonVertex) ;
 		return (pLayerElementNormals) ;
 	} else {
 		int nbLayers =_pMesh->GetLayerCount () ;
@@ -272,8 +298,6 @@ FbxLayerElementUV *gltfwriterVBO::elementUVs (FbxLayerElement::EType channel, in
 	if ( iLayer != -1 ) {
 		FbxLayer *pLayer =_pMesh->GetLayer (iLayer) ;
 		FbxLayerElementUV *pLayerElementUVs =pLayer->GetUVs (channel) ;
-		if ( pLayerElementUVs && pLayerElementUVs->GetMappingMode () != FbxLayerElement::eByPolygonVertex )
-			pLayerElementUVs->RemapIndexTo (FbxLayerElement::eByPolygonVertex) ;
 		return (pLayerElementUVs) ;
 	} else {
 		int nbLayers =_pMesh->GetLayerCount () ;
@@ -290,8 +314,6 @@ FbxGeometryElementTangent *gltfwriterVBO::elementTangents (int iLayer /*=-1*/) {
 	if ( iLayer != -1 ) {
 		FbxLayer *pLayer =_pMesh->GetLayer (iLayer) ;
 		FbxGeometryElementTangent* pLayerTangent =pLayer->GetTangents () ;
-		if ( pLayerTangent && pLayerTangent->GetMappingMode () == FbxGeometryElement::eByPolygonVertex )
-			pLayerTangent->RemapIndexTo (FbxLayerElement::eByPolygonVertex) ;
 		return (pLayerTangent) ;
 	} else {
 		int nbLayers =_pMesh->GetLayerCount () ;
@@ -308,8 +330,6 @@ FbxGeometryElementBinormal *gltfwriterVBO::elementBinormals (int iLayer /*=-1*/)
 	if ( iLayer != -1 ) {
 		FbxLayer *pLayer =_pMesh->GetLayer (iLayer) ;
 		FbxGeometryElementBinormal* pLayerBinormal =pLayer->GetBinormals () ;
-		if ( pLayerBinormal && pLayerBinormal->GetMappingMode () == FbxGeometryElement::eByPolygonVertex )
-			pLayerBinormal->RemapIndexTo (FbxLayerElement::eByPolygonVertex) ;
 		return (pLayerBinormal) ;
 	} else {
 		int nbLayers =_pMesh->GetLayerCount () ;
@@ -327,8 +347,6 @@ FbxLayerElementVertexColor *gltfwriterVBO::elementVcolors (int iLayer /*=-1*/) {
 		FbxLayer *pLayer =_pMesh->GetLayer (iLayer) ;
 		FbxLayerElementVertexColor *pLayerElementColors =nullptr ;
 		pLayerElementColors =pLayer->GetVertexColors () ;
-		if ( pLayerElementColors && pLayerElementColors->GetMappingMode () != FbxLayerElement::eByPolygonVertex )
-			pLayerElementColors->RemapIndexTo (FbxLayerElement::eByPolygonVertex) ;
 		return (pLayerElementColors) ;
 	} else {
 		int nbLayers =_pMesh->GetLayerCount () ;
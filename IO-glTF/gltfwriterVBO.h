@@ -20,58 +20,40 @@
 //
 #include "StdAfx.h"
 #include "gltfWriter.h"
+#include "gltfVertexKernel.h"
 #include <string.h> // for memcmp
 
 namespace _IOglTF_NS_ {
 
-// Function    : GetLayerElement
-// Abstraction : From the given layer get the single element
-#define GetLayerElement(layerElt, indexV, T, V, index, lambda) \
-	int indexV =-1 ; \
-	T V ; \
-	if ( layerElt ) { \
-		indexV =(layerElt->GetReferenceMode () == FbxLayerElement::eDirect ? index : layerElt->GetIndexArray () [index]) ; \
-		V =layerElt->GetDirectArray ().GetAt (indexV) ; \
-		lambda (V) ; \
-	}
-
 class gltfwriterVBO {
-	struct PackedVertex {
-		FbxDouble3 _position ;
-		FbxDouble2 _uv ;
-		FbxDouble3 _normal ;
-		FbxDouble3 _tangent ;
-		FbxDouble3 _binormal ;
-		FbxColor _vcolor ;
-		bool operator<(const PackedVertex that) const {
-			return (memcmp ((void *)this, (void *)&that, sizeof (PackedVertex)) > 0) ;
-		} ;
-	} ;
-	std::vector<unsigned short> _in_indices, _out_indices ;
-	std::vector<FbxDouble3> _in_positions, _out_positions ; // babylon.js does not like homogeneous coordinates (i.e. FbxDouble4)
-	std::vector<FbxDouble2> _in_uvs, _out_uvs ;
-	std::vector<FbxDouble3> _in_normals, _out_normals ;
-	std::vector<FbxDouble3> _in_tangents, _out_tangents ;
-	std::vector<FbxDouble3> _in_binormals, _out_binormals ;
-	std::vector<FbxColor> _in_vcolors, _out_vcolors ;
+	gltfVertexStreams _in, _out ;
 	std::map<std::string, std::string> _uvSets ;
 	FbxMesh *_pMesh ;
+	gltfTransformCache *_pTransforms ;
+	const gltfTriangulator::triangles *_pTriangles ;
+	unsigned int _skipped ;
+	bool _bControlPoints ; // _in holds one entry per control point, _cornerPoints the control point of every corner
+	std::vector<int> _cornerPoints ;
 
 public:
-	gltfwriterVBO (FbxMesh *pMesh) { _pMesh =pMesh ; }
+	gltfwriterVBO (FbxMesh *pMesh, gltfTransformCache *pTransforms =nullptr, const gltfTriangulator::triangles *pTriangles =nullptr)
+		: _pMesh (pMesh), _pTransforms (pTransforms), _pTriangles (pTriangles), _skipped (0), _bControlPoints (false) {}
 
-	void GetLayerElements (bool bInGeometry) ;
+	// Only the attributes in the gltfVertexAttributes mask are read, and so take part in the indexing / welding
+	void GetLayerElements (bool bInGeometry, unsigned int attributes =eVertexAllAttributes) ;
 	FbxArray<FbxVector4> GetVertexPositions (bool bInGeometry, bool bExportControlPoints) ;
-	bool getSimilarVertexIndex (PackedVertex & packed, std::map<PackedVertex, unsigned short> &VertexToOutIndex, unsigned short &result) ;
-	void indexVBO () ;
+	void indexVBO (threadPool *pPool =nullptr) ;
+	void weldVBO (const gltfWeldTolerances &tolerances) ;
 
-	std::vector<unsigned short> getIndices () { return (_out_indices) ; }
-	std::vector<FbxDouble3> getPositions () { return (_out_positions) ; }
-	std::vector<FbxDouble2> getUvs () { return (_out_uvs) ; }
-	std::vector<FbxDouble3> getNormals () { return( _out_normals) ; }
-	std::vector<FbxDouble3> getTangents () { return (_out_tangents) ; }
-	std::vector<FbxDouble3> getBinormals () { return (_out_binormals) ; }
-	std::vector<FbxColor> getVertexColors () { return (_out_vcolors) ; }
+	size_t inputVertices () const { return (_bControlPoints ? _cornerPoints.size () : _in._positions.size ()) ; }
+	unsigned int skippedAttributes () const { return (_skipped) ; } // Present in the mesh, but not read
+	std::vector<unsigned int> getIndices () { return (_out._indices) ; }
+	std::vector<FbxDouble3> getPositions () { return (_out._positions) ; }
+	std::vector<FbxDouble2> getUvs () { return (_out._uvs) ; }
+	std::vector<FbxDouble3> getNormals () { return( _out._normals) ; }
+	std::vector<FbxDouble3> getTangents () { return (_out._tangents) ; }
+	std::vector<FbxDouble3> getBinormals () { return (_out._binormals) ; }
+	std::vector<FbxColor> getVertexColors () { return (_out._vcolors) ; }
 	std::map<std::string, std::string> getUvSets () { return (_uvSets) ; }
 
 protected:
@@ -80,6 +62,7 @@ protected:
 	FbxGeometryElementTangent *elementTangents (int iLayer =-1)  ;
 	FbxGeometryElementBinormal *elementBinormals (int iLayer =-1) ;
 	FbxLayerElementVertexColor *elementVcolors (int iLayer =-1) ;
+	FbxAMatrix globalTransform (FbxNode *pNode) ;
 public:
 	static FbxLayer *getLayer (FbxMesh *pMesh, FbxLayerElement::EType pType) ;
 
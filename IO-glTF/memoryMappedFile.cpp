@@ -0,0 +1,115 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "memoryMappedFile.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace _IOglTF_NS_ {
+
+//-----------------------------------------------------------------------------
+#if defined(_WIN32) || defined(_WIN64)
+memoryMappedFile::memoryMappedFile () : _data (nullptr), _size (0), _bOpen (false), _hFile (INVALID_HANDLE_VALUE), _hMapping (NULL) {
+}
+
+bool memoryMappedFile::open (const std::string &fileName) {
+	close () ;
+	_hFile =CreateFileA (fileName.c_str (), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL) ;
+	if ( _hFile == INVALID_HANDLE_VALUE )
+		return (false) ;
+	LARGE_INTEGER size ;
+	if ( !GetFileSizeEx (_hFile, &size) )
+		return (close (), false) ;
+	_size =(size_t)size.QuadPart ;
+	_bOpen =true ;
+	if ( _size == 0 )
+		return (true) ;
+	_hMapping =CreateFileMappingA (_hFile, NULL, PAGE_READONLY, 0, 0, NULL) ;
+	if ( _hMapping == NULL )
+		return (close (), false) ;
+	_data =(const uint8_t *)MapViewOfFile (_hMapping, FILE_MAP_READ, 0, 0, 0) ;
+	if ( _data == nullptr )
+		return (close (), false) ;
+	return (true) ;
+}
+
+void memoryMappedFile::close () {
+	if ( _data )
+		UnmapViewOfFile (_data) ;
+	if ( _hMapping != NULL )
+		CloseHandle (_hMapping) ;
+	if ( _hFile != INVALID_HANDLE_VALUE )
+		CloseHandle (_hFile) ;
+	_data =nullptr ;
+	_size =0 ;
+	_bOpen =false ;
+	_hMapping =NULL ;
+	_hFile =INVALID_HANDLE_VALUE ;
+}
+
+#else
+memoryMappedFile::memoryMappedFile () : _data (nullptr), _size (0), _bOpen (false) {
+}
+
+bool memoryMappedFile::open (const std::string &fileName) {
+	close () ;
+	int fd =::open (fileName.c_str (), O_RDONLY) ;
+	if ( fd < 0 )
+		return (false) ;
+	struct stat st ;
+	if ( fstat (fd, &st) != 0 ) {
+		::close (fd) ;
+		return (false) ;
+	}
+	_size =(size_t)st.st_size ;
+	_bOpen =true ;
+	if ( _size ) {
+		void *p =mmap (nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0) ;
+		if ( p == MAP_FAILED ) {
+			::close (fd) ;
+			return (close (), false) ;
+		}
+		// Accessors are mostly walked front to back, let the kernel read ahead aggressively
+		madvise (p, _size, MADV_SEQUENTIAL) ;
+		_data =(const uint8_t *)p ;
+	}
+	::close (fd) ; // The mapping keeps its own reference on the file
+	return (true) ;
+}
+
+void memoryMappedFile::close () {
+	if ( _data )
+		munmap ((void *)_data, _size) ;
+	_data =nullptr ;
+	_size =0 ;
+	_bOpen =false ;
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,58 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <string>
+#include <stdint.h>
+
+namespace _IOglTF_NS_ {
+
+// Class       : memoryMappedFile
+// Abstraction : Read-only view of a whole file mapped in memory (mmap or MapViewOfFile). Pages are
+//               only read from disk when first touched, so buffers can be read in place with no copy.
+class memoryMappedFile {
+	const uint8_t *_data ;
+	size_t _size ;
+	bool _bOpen ;
+#if defined(_WIN32) || defined(_WIN64)
+	HANDLE _hFile ;
+	HANDLE _hMapping ;
+#endif
+
+public:
+	memoryMappedFile () ;
+	~memoryMappedFile () { close () ; }
+
+	bool open (const std::string &fileName) ;
+	void close () ;
+
+	// An empty file is open, but has no data
+	bool isOpen () const { return (_bOpen) ; }
+	const uint8_t *data () const { return (_data) ; }
+	size_t size () const { return (_size) ; }
+
+private:
+	memoryMappedFile (const memoryMappedFile &) ;
+	memoryMappedFile &operator= (const memoryMappedFile &) ;
+
+} ;
+
+}
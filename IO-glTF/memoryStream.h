@@ -82,6 +82,10 @@ public:
 		return (_vec) ;
 	}
 
+	size_t footprint () const { // bytes reserved, not written
+		return (_vec.capacity () * sizeof (T)) ;
+	}
+
 	void read (T *p, size_t size) {
 		if ( eof () )
 			throw std::runtime_error ("end of array!") ;
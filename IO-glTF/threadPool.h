@@ -0,0 +1,112 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX importer/exporter plug-in
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+
+namespace _IOglTF_NS_ {
+
+// Class       : threadPool
+// Abstraction : Small fixed size worker pool. Workers are only started on the first submit () so
+//               an export which never queues a job does not pay for thread creation.
+class threadPool {
+	std::vector<std::thread> _workers ;
+	std::deque<std::function<void ()> > _jobs ;
+	std::mutex _mutex ;
+	std::condition_variable _wakeup ;
+	std::condition_variable _idle ;
+	size_t _size ;
+	size_t _busy ;
+	bool _stop ;
+
+public:
+	threadPool (size_t nb =0) : _size (nb ? nb : defaultSize ()), _busy (0), _stop (false) {}
+	~threadPool () {
+		{
+			std::unique_lock<std::mutex> lock (_mutex) ;
+			_stop =true ;
+		}
+		_wakeup.notify_all () ;
+		for ( auto &worker : _workers )
+			worker.join () ;
+	}
+
+	static size_t defaultSize () {
+		unsigned int nb =std::thread::hardware_concurrency () ;
+		return (nb ? nb : 2) ;
+	}
+	size_t size () const { return (_size) ; }
+
+	template<class F>
+	std::future<typename std::result_of<F ()>::type> submit (F f) {
+		typedef typename std::result_of<F ()>::type R ;
+		auto task =std::make_shared<std::packaged_task<R ()> > (f) ;
+		std::future<R> ret =task->get_future () ;
+		{
+			std::unique_lock<std::mutex> lock (_mutex) ;
+			if ( _workers.empty () ) {
+				for ( size_t i =0 ; i < _size ; i++ )
+					_workers.push_back (std::thread (&threadPool::run, this)) ;
+			}
+			_jobs.push_back ([task] () { (*task) () ; }) ;
+		}
+		_wakeup.notify_one () ;
+		return (ret) ;
+	}
+
+	// Blocks until the queue is empty and no worker is busy
+	void wait () {
+		std::unique_lock<std::mutex> lock (_mutex) ;
+		_idle.wait (lock, [this] () { return (_jobs.empty () && _busy == 0) ; }) ;
+	}
+
+protected:
+	void run () {
+		for ( ;; ) {
+			std::function<void ()> job ;
+			{
+				std::unique_lock<std::mutex> lock (_mutex) ;
+				_wakeup.wait (lock, [this] () { return (_stop || !_jobs.empty ()) ; }) ;
+				if ( _jobs.empty () )
+					return ; // _stop
+				job =std::move (_jobs.front ()) ;
+				_jobs.pop_front () ;
+				_busy++ ;
+			}
+			job () ;
+			{
+				std::unique_lock<std::mutex> lock (_mutex) ;
+				_busy-- ;
+				if ( _jobs.empty () && _busy == 0 )
+					_idle.notify_all () ;
+			}
+		}
+	}
+
+} ;
+
+}
@@ -0,0 +1,420 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "getopt.h"
+#include "gltfBatch.h"
+#include "gltfLayerBench.h"
+#include "gltfVertexBench.h"
+#include "gltfTransformBench.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment (lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Tests
+// -n 5 -o /tmp/gltf-bench -r bench.json models
+// -n 3 --roundtrip -r bench.json models/duck/duck.fbx models/teapot/teapot.fbx
+// -n 5 -p static -r static.json models/LocalMotionBlend models/Zombie models/Roger_CharacterFace_Shape
+// -n 5 -p full -r full.json models/LocalMotionBlend models/Zombie models/Roger_CharacterFace_Shape
+// -n 9 -l 1024 -r layers.json
+// -n 9 -k 180 -r kernels.json
+// -n 3 -t 1826 -r threads.json
+// -n 5 -x 100000 -d 50 -r transforms.json
+
+void usage () {
+	std::cout << std::endl << ("gltf-bench [-h] [-n <iterations>] [-o <scratch path>] [-r <report file>] [-w] [-p <profile>] [-l <grid size>] [-k <grid size>] [-t <grid size>] [-x <nodes> [-d <depth>]] [-c] [-e] [<file or directory> ...]") << std::endl ;
+	std::cout << ("-n/--iterations \t- number of conversions per input file [int], default:3") << std::endl ;
+	std::cout << ("-o/--output \t\t- scratch directory receiving the glTF files [string], default:bench-out") << std::endl ;
+	std::cout << ("-r/--report \t\t- JSON report file [string], default:none") << std::endl ;
+	std::cout << ("-w/--roundtrip \t\t- import back the generated glTF file and time the reader") << std::endl ;
+	std::cout << ("-p/--profile \t\t- FBX import profile [auto|static|full], default:auto") << std::endl ;
+	std::cout << ("-l/--layers \t\t- time the layer element readers on a synthetic grid of that size, for every mapping and reference mode, instead of converting files [int]") << std::endl ;
+	std::cout << ("-k/--kernels \t\t- time the vertex index and weld kernels on the corners of a synthetic grid of that size (180 max), instead of converting files [int]") << std::endl ;
+	std::cout << ("-t/--threads \t\t- time the parallel vertex indexing at 1, 4, 16 and 32 threads on the corners of a synthetic grid of that size, instead of converting files [int]") << std::endl ;
+	std::cout << ("-x/--transforms \t- time the node transform cache on a synthetic scene of that many nodes, instead of converting files [int]") << std::endl ;
+	std::cout << ("-d/--depth \t\t- depth of the --transforms node chains [int], default:50") << std::endl ;
+	std::cout << ("-c/--copy \t\t- copy all media to the target directory (cannot be combined with --embed)") << std::endl ;
+	std::cout << ("-e/--embed \t\t- embed all resources as Data URIs (cannot be combined with --copy)") << std::endl ;
+	std::cout << ("-h/--help \t\t- this message") << std::endl ;
+	std::cout << ("Directories are searched recursively for .fbx files, models is used if no input is given.") << std::endl ;
+}
+
+static struct option long_options [] ={
+	{ ("iterations"), ARG_REQ, 0, ('n') },
+	{ ("output"), ARG_REQ, 0, ('o') },
+	{ ("report"), ARG_REQ, 0, ('r') },
+	{ ("roundtrip"), ARG_NONE, 0, ('w') },
+	{ ("profile"), ARG_REQ, 0, ('p') },
+	{ ("layers"), ARG_REQ, 0, ('l') },
+	{ ("kernels"), ARG_REQ, 0, ('k') },
+	{ ("threads"), ARG_REQ, 0, ('t') },
+	{ ("transforms"), ARG_REQ, 0, ('x') },
+	{ ("depth"), ARG_REQ, 0, ('d') },
+	{ ("copy"), ARG_NONE, 0, ('c') },
+	{ ("embed"), ARG_NONE, 0, ('e') },
+	{ ("help"), ARG_NONE, 0, ('h') },
+
+	{ ARG_NULL, ARG_NULL, ARG_NULL, ARG_NULL }
+} ;
+
+//-----------------------------------------------------------------------------
+static uint64_t peakRSS () {
+#if defined(_WIN32) || defined(_WIN64)
+	PROCESS_MEMORY_COUNTERS counters ;
+	if ( !GetProcessMemoryInfo (GetCurrentProcess (), &counters, sizeof (counters)) )
+		return (0) ;
+	return ((uint64_t)counters.PeakWorkingSetSize) ;
+#else
+	struct rusage usage ;
+	if ( getrusage (RUSAGE_SELF, &usage) != 0 )
+		return (0) ;
+#if defined(__APPLE__)
+	return ((uint64_t)usage.ru_maxrss) ; // bytes
+#else
+	return ((uint64_t)usage.ru_maxrss * 1024) ; // kilobytes
+#endif
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Samples of one phase over all the iterations of a file
+struct samples {
+	std::vector<double> _values ;
+	// Heap bytes, worst iteration (only with the allocator hook)
+	bool _bMemory ;
+	int64_t _peakBytes ;
+	int64_t _retainedBytes ;
+
+	samples () : _bMemory (false), _peakBytes (0), _retainedBytes (0) {}
+
+	Json::Value json () const {
+		std::vector<double> sorted (_values) ;
+		std::sort (sorted.begin (), sorted.end ()) ;
+		Json::Value ret ;
+		double sum =0. ;
+		for ( double v : sorted )
+			sum +=v ;
+		size_t n =sorted.size () ;
+		ret ["min"] =n ? sorted.front () : 0. ;
+		ret ["mean"] =n ? sum / n : 0. ;
+		ret ["median"] =n == 0 ? 0. : (n & 1 ? sorted [n / 2] : (sorted [n / 2 - 1] + sorted [n / 2]) / 2.) ;
+		ret ["samples"] =(Json::UInt64)n ;
+		if ( _bMemory ) {
+			ret ["peakBytes"] =(Json::Int64)_peakBytes ;
+			ret ["retainedBytes"] =(Json::Int64)_retainedBytes ;
+		}
+		return (ret) ;
+	}
+	double median () const {
+		return (json () ["median"].asDouble ()) ;
+	}
+} ;
+
+typedef std::map<std::string, samples> phaseSamples ;
+
+static void addPhases (phaseSamples &phases, const Json::Value &stats, const std::string &prefix) {
+	const Json::Value &values =stats ["phases"] ;
+	for ( Json::Value::const_iterator iter =values.begin () ; iter != values.end () ; iter++ ) {
+		samples &phase =phases [prefix + iter.memberName ()] ;
+		phase._values.push_back ((*iter) ["seconds"].asDouble ()) ;
+		if ( iter->isMember ("peakBytes") ) {
+			phase._bMemory =true ;
+			phase._peakBytes =std::max (phase._peakBytes, (int64_t)(*iter) ["peakBytes"].asInt64 ()) ;
+			phase._retainedBytes =std::max (phase._retainedBytes, (int64_t)(*iter) ["retainedBytes"].asInt64 ()) ;
+		}
+	}
+}
+
+static void addGauges (std::map<std::string, uint64_t> &gauges, const Json::Value &stats) {
+	const Json::Value &values =stats ["memory"] ;
+	for ( Json::Value::const_iterator iter =values.begin () ; iter != values.end () ; iter++ )
+		gauges [iter.memberName ()] =std::max (gauges [iter.memberName ()], (uint64_t)iter->asUInt64 ()) ;
+}
+
+static Json::Value phasesJson (const phaseSamples &phases) {
+	Json::Value ret (Json::objectValue) ;
+	for ( const auto &iter : phases )
+		ret [iter.first] =iter.second.json () ;
+	return (ret) ;
+}
+
+//-----------------------------------------------------------------------------
+int main (int argc, char *argv []) {
+	bool bLoop =true ;
+	int iterations =3 ;
+	std::string outDir ("bench-out") ;
+	std::string reportFile ;
+	bool bRoundtrip =false ;
+	gltfPackage::EImportProfile importProfile =gltfPackage::eImportAuto ;
+	bool copyMedia =false ;
+	bool embedMedia =false ;
+	int layersGrid =0 ;
+	int kernelsGrid =0 ;
+	int threadsGrid =0 ;
+	int transformNodes =0 ;
+	int transformDepth =50 ;
+	while ( bLoop ) {
+		int option_index =0 ;
+		int c =getopt_long (argc, argv, ("n:o:r:wp:l:k:t:x:d:ceh"), long_options, &option_index) ;
+		// Check for end of operation or error
+		if ( c == -1 )
+			break ;
+
+		// Handle options
+		switch ( c ) {
+			case 0:
+				break ;
+			case ('?'):
+				// getopt_long already printed an error message.
+				break ;
+			case (':'): // missing option argument
+				std::cout << ("option \'") << optopt << ("\' requires an argument") << std::endl ;
+				break ;
+			default:
+				bLoop =false ;
+				break ;
+
+			case ('h'): // help message
+				usage () ;
+				return (0) ;
+			case ('n'): // number of conversions per input file [int]
+				iterations =std::max (1, atoi (optarg)) ;
+				break ;
+			case ('o'): // scratch directory [string]
+				outDir =optarg ;
+				break ;
+			case ('r'): // JSON report file [string]
+				reportFile =optarg ;
+				break ;
+			case ('w'): // import back the generated glTF file
+				bRoundtrip =true ;
+				break ;
+			case ('p'): // FBX import profile [string]
+				if ( !gltfPackage::importProfile (optarg, importProfile) )
+					std::cout << ("Warning: unknown import profile ") << optarg << (", using auto") << std::endl ;
+				break ;
+			case ('l'): // time the layer element readers [int]
+				layersGrid =std::max (1, atoi (optarg)) ;
+				break ;
+			case ('k'): // time the vertex index and weld kernels [int]
+				kernelsGrid =std::max (1, atoi (optarg)) ;
+				break ;
+			case ('t'): // time the parallel vertex indexing [int]
+				threadsGrid =std::max (1, atoi (optarg)) ;
+				break ;
+			case ('x'): // time the node transform cache [int]
+				transformNodes =std::max (1, atoi (optarg)) ;
+				break ;
+			case ('d'): // depth of the --transforms node chains [int]
+				transformDepth =std::max (1, atoi (optarg)) ;
+				break ;
+			case ('c'): // copy all media to the target directory (cannot be combined with --embed)
+				copyMedia =!embedMedia ;
+				break ;
+			case ('e'): // embed all resources as Data URIs (cannot be combined with --copy)
+				embedMedia =!copyMedia ;
+				break ;
+		}
+	}
+#if defined(_WIN32) || defined(_WIN64)
+	if ( outDir [outDir.length () - 1] != ('\\') )
+		outDir +=('\\') ;
+#else
+	if ( outDir [outDir.length () - 1] != ('/') )
+		outDir +=('/') ;
+#endif
+
+	if ( layersGrid || kernelsGrid || threadsGrid || transformNodes ) {
+		Json::Value report ;
+		report ["iterations"] =iterations ;
+		if ( layersGrid ) {
+			report ["grid"] =layersGrid ;
+			std::cout << ("Layer element readers, ") << layersGrid << ("x") << layersGrid << (" quads (per corner, specialized)") << std::endl ;
+			report ["layerReaders"] =layerReaderBench (layersGrid, iterations) ;
+		}
+		if ( kernelsGrid ) {
+			report ["kernelsGrid"] =std::min (kernelsGrid, 180) ;
+			std::cout << ("Vertex kernels, ") << std::min (kernelsGrid, 180) << ("x") << std::min (kernelsGrid, 180) << (" quads (generic, specialized, speedup)") << std::endl ;
+			report ["vertexKernels"] =vertexKernelBench (kernelsGrid, iterations) ;
+		}
+		if ( threadsGrid ) {
+			report ["threadsGrid"] =threadsGrid ;
+			std::cout << ("Parallel vertex indexing, ") << threadsGrid << ("x") << threadsGrid << (" quads (serial, parallel, speedup)") << std::endl ;
+			report ["parallelIndex"] =parallelIndexBench (threadsGrid, iterations) ;
+		}
+		if ( transformNodes ) {
+			std::cout << ("Node transforms, ") << transformNodes << (" nodes, depth ") << transformDepth << (" (per node, cached, speedup)") << std::endl ;
+			report ["transformCache"] =transformCacheBench (transformNodes, transformDepth, iterations) ;
+		}
+		if ( reportFile.length () ) {
+			std::ofstream out (reportFile, std::ios::out | std::ios::trunc) ;
+			Json::StyledWriter writer ;
+			out << writer.write (report) ;
+		}
+		return (0) ;
+	}
+
+	std::vector<std::string> inputs (argv + optind, argv + argc) ;
+	if ( inputs.size () == 0 )
+		inputs.push_back ("models") ;
+	gltfBatch batch ;
+	for ( const std::string &input : inputs )
+		batch.add (input) ;
+	std::vector<std::string> files ;
+	for ( const gltfBatch::input &in : batch.inputs () )
+		files.push_back (in._file) ;
+	if ( files.size () == 0 ) {
+		std::cout << ("No input file") << std::endl ;
+		return (-1) ;
+	}
+
+	// Loads the SDK and the plug-ins before anything is timed
+	gltfPackage ().ioSettings (nullptr, false, false, false, copyMedia, embedMedia) ;
+
+	Json::Value report ;
+	report ["iterations"] =iterations ;
+	report ["roundtrip"] =bRoundtrip ;
+	report ["importProfile"] =gltfPackage::importProfileName (importProfile) ;
+	report ["files"] =Json::Value (Json::arrayValue) ;
+	int nbFailures =0 ;
+	for ( const std::string &fn : files ) {
+		std::string name =gltfPackage::filename (fn) ;
+		std::string fileDir =outDir + name + (outDir [outDir.length () - 1]) ;
+		std::string statsFile =outDir + name + ".stats.json" ;
+		FbxPathUtils::Create (fileDir.c_str ()) ;
+
+		phaseSamples phases ;
+		std::map<std::string, uint64_t> outputBytes ;
+		std::map<std::string, uint64_t> gauges ;
+		uint64_t writtenBytes =0 ;
+		int failures =0 ;
+		std::cout << ("Converting ") << fn << (" ") << std::flush ;
+		for ( int i =0 ; i < iterations ; i++ ) {
+			Json::Value stats ;
+			{
+				gltfPackage asset ;
+				asset.ioSettings (name.c_str (), false, false, false, copyMedia, embedMedia) ;
+				asset.importProfile (importProfile) ;
+				asset.statsFile (statsFile.c_str ()) ;
+				auto start =std::chrono::steady_clock::now () ;
+				bool bRet =asset.load (fn) && asset.save (fileDir) ;
+				phases ["Total"]._values.push_back (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ()) ;
+				asset.statsFile () ;
+				if ( !bRet ) {
+					failures++ ;
+					std::cout << ("x") << std::flush ;
+					continue ;
+				}
+				addPhases (phases, asset.stats ().json (), "") ;
+			}
+			if ( _IOglTF_NS_::gltfStats::load (statsFile, stats) ) {
+				addPhases (phases, stats, "") ;
+				addGauges (gauges, stats) ;
+				writtenBytes =stats ["counters"] ["jsonBytes"].asUInt64 () + stats ["counters"] ["binBytes"].asUInt64 () ;
+			}
+
+			if ( bRoundtrip ) {
+				gltfPackage asset ;
+				asset.ioSettings (nullptr) ;
+				asset.statsFile (statsFile.c_str ()) ;
+				auto start =std::chrono::steady_clock::now () ;
+				bool bRet =asset.load (fileDir + name + ".gltf") ;
+				double seconds =std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count () ;
+				asset.statsFile () ;
+				if ( !bRet ) {
+					failures++ ;
+					std::cout << ("x") << std::flush ;
+					continue ;
+				}
+				phases ["roundtrip.Total"]._values.push_back (seconds) ;
+				addPhases (phases, asset.stats ().json (), "roundtrip.") ;
+				if ( _IOglTF_NS_::gltfStats::load (statsFile, stats) )
+					addPhases (phases, stats, "roundtrip.") ;
+			}
+			std::cout << (".") << std::flush ;
+		}
+		std::cout << std::endl ;
+		nbFailures +=failures ;
+
+		// Output sizes, from the last conversion
+		std::vector<std::string> outputs ;
+		gltfBatch::listFiles (fileDir.substr (0, fileDir.length () - 1), false, outputs) ;
+		uint64_t totalBytes =0 ;
+		for ( const std::string &output : outputs ) {
+			uint64_t size =gltfBatch::fileSize (output) ;
+			outputBytes [gltfBatch::extensionOf (output)] +=size ;
+			totalBytes +=size ;
+		}
+
+		Json::Value fileDef ;
+		fileDef ["file"] =fn ;
+		fileDef ["inputBytes"] =(Json::UInt64)gltfBatch::fileSize (fn) ;
+		fileDef ["failures"] =failures ;
+		fileDef ["phases"] =phasesJson (phases) ;
+		fileDef ["outputBytes"] =Json::Value (Json::objectValue) ;
+		for ( const auto &iter : outputBytes )
+			fileDef ["outputBytes"] [iter.first] =(Json::UInt64)iter.second ;
+		fileDef ["writtenBytes"] =(Json::UInt64)writtenBytes ;
+		fileDef ["memory"] =Json::Value (Json::objectValue) ;
+		for ( const auto &iter : gauges )
+			fileDef ["memory"] [iter.first] =(Json::UInt64)iter.second ;
+		if ( bRoundtrip && phases.count ("roundtrip.Total") ) {
+			double seconds =phases ["roundtrip.Total"].median () ;
+			fileDef ["roundtripMBps"] =seconds > 0. ? (double)totalBytes / (1024. * 1024.) / seconds : 0. ;
+		}
+		report ["files"].append (fileDef) ;
+
+		std::cout << std::fixed << std::setprecision (4) ;
+		for ( const auto &iter : phases ) {
+			std::cout << ("  ") << std::left << std::setw (32) << iter.first << std::right << std::setw (10) << iter.second.median () << (" s") ;
+			if ( iter.second._bMemory )
+				std::cout << std::setw (12) << iter.second._peakBytes / 1024 << (" KB peak") << std::setw (12) << iter.second._retainedBytes / 1024 << (" KB retained") ;
+			std::cout << std::endl ;
+		}
+		for ( const auto &iter : gauges )
+			std::cout << ("  ") << std::left << std::setw (32) << iter.first << std::right << std::setw (10) << iter.second << (" bytes") << std::endl ;
+		for ( const auto &iter : outputBytes )
+			std::cout << ("  ") << std::left << std::setw (32) << iter.first << std::right << std::setw (10) << iter.second << (" bytes") << std::endl ;
+	}
+
+	uint64_t rss =peakRSS () ;
+	report ["peakRSS"] =(Json::UInt64)rss ;
+	std::cout << ("Peak RSS: ") << rss / (1024 * 1024) << (" MB") << std::endl ;
+	if ( reportFile.length () ) {
+		std::ofstream out (reportFile, std::ios::out | std::ios::trunc) ;
+		Json::StyledWriter writer ;
+		out << writer.write (report) ;
+		if ( !out.good () ) {
+			std::cout << ("Cannot write ") << reportFile << std::endl ;
+			return (-1) ;
+		}
+	}
+	return (nbFailures ? 1 : 0) ;
+}
@@ -0,0 +1,183 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfTriangulator.h"
+#include "gltfLayerElementReader.h"
+#include "gltfLayerBench.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+static FbxMesh *gridMesh (FbxScene *pScene, int size) {
+	FbxMesh *pMesh =FbxMesh::Create (pScene, "grid") ;
+	pMesh->InitControlPoints ((size + 1) * (size + 1)) ;
+	for ( int y =0 ; y <= size ; y++ ) {
+		for ( int x =0 ; x <= size ; x++ )
+			pMesh->SetControlPointAt (FbxVector4 (x, y, 0.), y * (size + 1) + x) ;
+	}
+	for ( int y =0 ; y < size ; y++ ) {
+		for ( int x =0 ; x < size ; x++ ) {
+			int corner =y * (size + 1) + x ;
+			pMesh->BeginPolygon () ;
+			pMesh->AddPolygon (corner) ;
+			pMesh->AddPolygon (corner + 1) ;
+			pMesh->AddPolygon (corner + size + 2) ;
+			pMesh->AddPolygon (corner + size + 1) ;
+			pMesh->EndPolygon () ;
+		}
+	}
+	pMesh->BuildMeshEdgeArray () ;
+	return (pMesh) ;
+}
+
+// Two triangles per quad, like gltfTriangulator fans them
+static void gridTriangles (FbxMesh *pMesh, _IOglTF_NS_::gltfTriangulator::triangles &tris) {
+	for ( int polygon =0 ; polygon < pMesh->GetPolygonCount () ; polygon++ ) {
+		int start =pMesh->GetPolygonVertexIndex (polygon) ;
+		int corners [6] ={ start, start + 1, start + 2, start, start + 2, start + 3 } ;
+		tris._corners.insert (tris._corners.end (), corners, corners + 6) ;
+		tris._polygons.push_back (polygon) ;
+		tris._polygons.push_back (polygon) ;
+	}
+}
+
+static FbxGeometryElementNormal *gridNormals (FbxMesh *pMesh, FbxLayerElement::EMappingMode mapping, FbxLayerElement::EReferenceMode reference) {
+	FbxGeometryElementNormal *pElement =pMesh->CreateElementNormal () ;
+	pElement->SetMappingMode (mapping) ;
+	pElement->SetReferenceMode (reference) ;
+	int nb =0 ;
+	switch ( mapping ) {
+		case FbxLayerElement::eByControlPoint: nb =pMesh->GetControlPointsCount () ; break ;
+		case FbxLayerElement::eByPolygon: nb =pMesh->GetPolygonCount () ; break ;
+		case FbxLayerElement::eByEdge: nb =pMesh->GetMeshEdgeCount () ; break ;
+		case FbxLayerElement::eAllSame: nb =1 ; break ;
+		default: nb =pMesh->GetPolygonVertexCount () ; break ;
+	}
+	// Indexed elements share half as many values
+	int nbValues =reference == FbxLayerElement::eDirect ? nb : std::max (1, nb / 2) ;
+	for ( int i =0 ; i < nbValues ; i++ )
+		pElement->GetDirectArray ().Add (FbxVector4 (0., (double)(i % 7), 1., 0.)) ;
+	if ( reference != FbxLayerElement::eDirect ) {
+		for ( int i =0 ; i < nb ; i++ )
+			pElement->GetIndexArray ().Add (i % nbValues) ;
+	}
+	return (pElement) ;
+}
+
+// The per corner reading gltfwriterVBO did before gltfLayerElementReader, eByEdge elements remapped upfront
+static void perCornerGather (FbxMesh *pMesh, FbxGeometryElementNormal *pElement, const _IOglTF_NS_::gltfTriangulator::triangles &tris, std::vector<FbxDouble3> &out) {
+	for ( size_t i =0 ; i < tris._corners.size () ; i++ ) {
+		int corner =tris._corners [i] ;
+		int polygon =tris._polygons [i / 3] ;
+		int index ;
+		switch ( pElement->GetMappingMode () ) {
+			case FbxLayerElement::eByControlPoint: index =pMesh->GetPolygonVertices () [corner] ; break ;
+			case FbxLayerElement::eByPolygon: index =polygon ; break ;
+			case FbxLayerElement::eAllSame: index =0 ; break ;
+			default: index =corner ; break ;
+		}
+		int indexV =pElement->GetReferenceMode () == FbxLayerElement::eDirect ? index : pElement->GetIndexArray ().GetAt (index) ;
+		FbxVector4 V =pElement->GetDirectArray ().GetAt (indexV) ;
+		out.push_back (FbxDouble3 (V [0], V [1], V [2])) ;
+	}
+}
+
+static double median (std::vector<double> values) {
+	std::sort (values.begin (), values.end ()) ;
+	return (values.size () ? values [values.size () / 2] : 0.) ;
+}
+
+Json::Value layerReaderBench (int size, int iterations) {
+	static const struct { FbxLayerElement::EMappingMode _mode ; const char *_name ; } mappings [] ={
+		{ FbxLayerElement::eByControlPoint, "byControlPoint" },
+		{ FbxLayerElement::eByPolygonVertex, "byPolygonVertex" },
+		{ FbxLayerElement::eByPolygon, "byPolygon" },
+		{ FbxLayerElement::eByEdge, "byEdge" },
+		{ FbxLayerElement::eAllSame, "allSame" }
+	} ;
+	static const struct { FbxLayerElement::EReferenceMode _mode ; const char *_name ; } references [] ={
+		{ FbxLayerElement::eDirect, "direct" },
+		{ FbxLayerElement::eIndexToDirect, "indexToDirect" }
+	} ;
+
+	FbxManager *pMgr =fbxSdkMgr::Instance ()->fbxMgr () ;
+	FbxScene *pScene =FbxScene::Create (pMgr, "layerReaderBench") ;
+	Json::Value ret (Json::arrayValue) ;
+	std::cout << std::fixed << std::setprecision (4) ;
+	for ( const auto &mapping : mappings ) {
+		for ( const auto &reference : references ) {
+			FbxMesh *pMesh =gridMesh (pScene, size) ;
+			FbxGeometryElementNormal *pElement =gridNormals (pMesh, mapping._mode, reference._mode) ;
+			_IOglTF_NS_::gltfTriangulator::triangles tris ;
+			gridTriangles (pMesh, tris) ;
+
+			std::vector<double> perCorner, specialized ;
+			std::vector<FbxDouble3> expected, normals ;
+			for ( int i =0 ; i < iterations ; i++ ) {
+				// The former path had to remap eByEdge elements first, on a copy here to keep the mesh as is
+				FbxMesh *pCopy =nullptr ;
+				FbxGeometryElementNormal *pRead =pElement ;
+				if ( mapping._mode == FbxLayerElement::eByEdge ) {
+					pCopy =FbxMesh::Create (pScene, "copy") ;
+					pCopy->Copy (*pMesh) ;
+					pRead =pCopy->GetElementNormal (0) ;
+				}
+				auto start =std::chrono::steady_clock::now () ;
+				if ( pCopy )
+					pRead->RemapIndexTo (FbxLayerElement::eByPolygonVertex) ;
+				expected.clear () ;
+				perCornerGather (pCopy ? pCopy : pMesh, pRead, tris, expected) ;
+				perCorner.push_back (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ()) ;
+				if ( pCopy )
+					pCopy->Destroy () ;
+
+				start =std::chrono::steady_clock::now () ;
+				normals.clear () ;
+				_IOglTF_NS_::gltfLayerElementReader<FbxVector4> (pMesh, pElement).gather (tris, normals, [] (const FbxVector4 &V) {
+					return (FbxDouble3 (V [0], V [1], V [2])) ;
+				}) ;
+				specialized.push_back (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ()) ;
+			}
+			bool bSame =expected.size () == normals.size () ;
+			for ( size_t i =0 ; bSame && i < normals.size () ; i++ )
+				bSame =expected [i] == normals [i] ;
+
+			Json::Value def ;
+			def ["mapping"] =mapping._name ;
+			def ["reference"] =reference._name ;
+			def ["corners"] =(Json::UInt64)tris._corners.size () ;
+			def ["perCornerSeconds"] =median (perCorner) ;
+			def ["specializedSeconds"] =median (specialized) ;
+			def ["speedup"] =median (specialized) > 0. ? median (perCorner) / median (specialized) : 0. ;
+			def ["identical"] =bSame ;
+			ret.append (def) ;
+			std::cout << ("  ") << std::left << std::setw (16) << mapping._name << std::setw (16) << reference._name << std::right
+				<< std::setw (10) << median (perCorner) << (" s") << std::setw (10) << median (specialized) << (" s")
+				<< (bSame ? ("") : ("  values differ!")) << std::endl ;
+			pMesh->Destroy () ;
+		}
+	}
+	pScene->Destroy () ;
+	return (ret) ;
+}
@@ -0,0 +1,118 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfTransformCache.h"
+#include "gltfTransformBench.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Chains of depth nodes under the root, every node translated and rotated so the products are not trivial,
+// and one node in 10 scaled (non uniform scaling is what makes the parent inverse costly)
+static void chainNodes (FbxScene *pScene, int nodes, int depth, std::vector<FbxNode *> &out) {
+	out.reserve ((size_t)nodes) ;
+	char name [32] ;
+	for ( int chain =0 ; (int)out.size () < nodes ; chain++ ) {
+		FbxNode *pParent =pScene->GetRootNode () ;
+		for ( int level =0 ; level < depth && (int)out.size () < nodes ; level++ ) {
+			snprintf (name, sizeof (name), "node_%d_%d", chain, level) ;
+			FbxNode *pNode =FbxNode::Create (pScene, name) ;
+			pNode->LclTranslation.Set (FbxDouble3 (1., 0.1 * level, 0.01 * chain)) ;
+			pNode->LclRotation.Set (FbxDouble3 (5., 10. + level, 0.)) ;
+			if ( level % 10 == 9 )
+				pNode->LclScaling.Set (FbxDouble3 (1.01, 0.99, 1.)) ;
+			// Like gltfWriter::PreprocessNodeRecursive ()
+			pNode->SetPivotState (FbxNode::eSourcePivot, FbxNode::ePivotActive) ;
+			pNode->SetPivotState (FbxNode::eDestinationPivot, FbxNode::ePivotActive) ;
+			pParent->AddChild (pNode) ;
+			out.push_back (pNode) ;
+			pParent =pNode ;
+		}
+	}
+}
+
+// What gltfWriter::GetTransform () did before gltfTransformCache
+static FbxAMatrix perNodeLocal (FbxNode *pNode) {
+	FbxAMatrix thisGlobal =pNode->EvaluateGlobalTransform (FBXSDK_TIME_ZERO, FbxNode::eDestinationPivot) ;
+	FbxNode *pParentNode =pNode->GetParent () ;
+	if ( pParentNode == nullptr )
+		return (thisGlobal) ;
+	FbxAMatrix parentGlobal =pParentNode->EvaluateGlobalTransform (FBXSDK_TIME_ZERO, FbxNode::eDestinationPivot) ;
+	return (parentGlobal.Inverse () * thisGlobal) ;
+}
+
+static double median (std::vector<double> values) {
+	std::sort (values.begin (), values.end ()) ;
+	return (values.size () ? values [values.size () / 2] : 0.) ;
+}
+
+Json::Value transformCacheBench (int nodes, int depth, int iterations) {
+	FbxManager *pMgr =fbxSdkMgr::Instance ()->fbxMgr () ;
+	FbxScene *pScene =FbxScene::Create (pMgr, "transformCacheBench") ;
+	std::vector<FbxNode *> scene ;
+	chainNodes (pScene, nodes, depth, scene) ; // parents before their children
+
+	std::vector<double> perNode, cached ;
+	std::vector<FbxAMatrix> expected (scene.size ()) ;
+	_IOglTF_NS_::gltfTransformCache transforms ;
+	double maxError =0. ;
+	for ( int i =0 ; i < iterations ; i++ ) {
+		// The evaluator keeps what it computed, start both paths from a cold evaluator
+		pScene->GetAnimationEvaluator ()->Reset () ;
+		auto start =std::chrono::steady_clock::now () ;
+		for ( size_t j =0 ; j < scene.size () ; j++ )
+			expected [j] =perNodeLocal (scene [j]) ;
+		perNode.push_back (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ()) ;
+
+		pScene->GetAnimationEvaluator ()->Reset () ;
+		start =std::chrono::steady_clock::now () ;
+		transforms.clear () ;
+		for ( FbxNode *pNode : scene )
+			transforms.record (pNode) ;
+		for ( FbxNode *pNode : scene )
+			transforms.local (pNode) ;
+		cached.push_back (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ()) ;
+	}
+	for ( size_t j =0 ; j < scene.size () ; j++ ) {
+		const FbxAMatrix &local =transforms.local (scene [j]) ;
+		for ( int r =0 ; r < 4 ; r++ ) {
+			for ( int c =0 ; c < 4 ; c++ )
+				maxError =std::max (maxError, std::fabs (local [r] [c] - expected [j] [r] [c])) ;
+		}
+	}
+
+	Json::Value def ;
+	def ["nodes"] =(Json::UInt64)scene.size () ;
+	def ["depth"] =depth ;
+	def ["perNodeSeconds"] =median (perNode) ;
+	def ["cachedSeconds"] =median (cached) ;
+	def ["speedup"] =median (cached) > 0. ? median (perNode) / median (cached) : 0. ;
+	def ["maxError"] =maxError ;
+	std::cout << std::fixed << std::setprecision (4) << ("  ") << std::setw (10) << median (perNode) << (" s") << std::setw (10) << median (cached) << (" s")
+		<< std::setw (8) << (median (cached) > 0. ? median (perNode) / median (cached) : 0.) << ("x")
+		<< std::scientific << std::setprecision (2) << ("  max error ") << maxError << std::fixed << std::endl ;
+	pScene->Destroy () ;
+	return (def) ;
+}
@@ -0,0 +1,307 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfVertexKernel.h"
+#include "gltfVertexBench.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+using namespace _IOglTF_NS_ ;
+
+//-----------------------------------------------------------------------------
+// Two triangles per quad, the corners shared by neighbour quads have the same position. Normals are per
+// quad row, so they split the vertices of every other row boundary like hard edges do on CAD parts.
+static void gridCorners (int size, unsigned int attributes, gltfVertexStreams &in) {
+	static const int corners [6][2] ={ { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } } ;
+	for ( int y =0 ; y < size ; y++ ) {
+		for ( int x =0 ; x < size ; x++ ) {
+			for ( int i =0 ; i < 6 ; i++ ) {
+				double px =x + corners [i][0], py =y + corners [i][1] ;
+				in._positions.push_back (FbxDouble3 (px, py, 0.)) ;
+				if ( attributes & eVertexNormal )
+					in._normals.push_back (FbxDouble3 (0., (y / 2) % 2 ? 0.1 : 0., 1.)) ;
+				if ( attributes & eVertexUV )
+					in._uvs.push_back (FbxDouble2 (px / size, py / size)) ;
+				if ( attributes & eVertexTangent )
+					in._tangents.push_back (FbxDouble3 (1., 0., 0.)) ;
+				if ( attributes & eVertexBinormal )
+					in._binormals.push_back (FbxDouble3 (0., 1., 0.)) ;
+				if ( attributes & eVertexColor )
+					in._vcolors.push_back (FbxColor (px / size, py / size, 0.5, 1.)) ;
+			}
+		}
+	}
+}
+
+// Per control point normals, and the control point of every triangle corner
+static void gridPoints (int size, gltfVertexStreams &points, std::vector<int> &corners) {
+	static const int quad [6][2] ={ { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } } ;
+	for ( int y =0 ; y <= size ; y++ ) {
+		for ( int x =0 ; x <= size ; x++ ) {
+			points._positions.push_back (FbxDouble3 (x, y, 0.)) ;
+			points._normals.push_back (FbxDouble3 (0., (double)(x % 5) * 0.1, 1.)) ;
+		}
+	}
+	for ( int y =0 ; y < size ; y++ ) {
+		for ( int x =0 ; x < size ; x++ ) {
+			for ( int i =0 ; i < 6 ; i++ )
+				corners.push_back ((y + quad [i][1]) * (size + 1) + x + quad [i][0]) ;
+		}
+	}
+}
+
+// The gltfwriterVBO::indexVBO () before gltfVertexKernel
+struct PackedVertex {
+	FbxDouble3 _position ;
+	FbxDouble2 _uv ;
+	FbxDouble3 _normal ;
+	FbxDouble3 _tangent ;
+	FbxDouble3 _binormal ;
+	FbxColor _vcolor ;
+	bool operator<(const PackedVertex that) const {
+		return (memcmp ((void *)this, (void *)&that, sizeof (PackedVertex)) > 0) ;
+	} ;
+} ;
+
+static void genericIndex (const gltfVertexStreams &in, gltfVertexStreams &out) {
+	std::map<PackedVertex, unsigned short> VertexToOutIndex ;
+	for ( unsigned int i =0 ; i < in._positions.size () ; i++ ) {
+		FbxDouble2 in_uv =i < in._uvs.size () ? in._uvs [i] : FbxDouble2 () ;
+		FbxDouble3 in_normal =i < in._normals.size () ? in._normals [i] : FbxDouble3 () ;
+		FbxDouble3 in_tangent =i < in._tangents.size () ? in._tangents [i] : FbxDouble3 () ;
+		FbxDouble3 in_binormal =i < in._binormals.size () ? in._binormals [i] : FbxDouble3 () ;
+		FbxColor in_vcolor =i < in._vcolors.size () ? in._vcolors [i] : FbxColor () ;
+		PackedVertex packed ={ in._positions [i], in_uv, in_normal, in_tangent, in_binormal, in_vcolor } ;
+		std::map<PackedVertex, unsigned short>::iterator it =VertexToOutIndex.find (packed) ;
+		if ( it != VertexToOutIndex.end () ) {
+			out._indices.push_back (it->second) ;
+			continue ;
+		}
+		out._positions.push_back (in._positions [i]) ;
+		if ( in._uvs.size () )
+			out._uvs.push_back (in_uv) ;
+		if ( in._normals.size () )
+			out._normals.push_back (in_normal) ;
+		if ( in._tangents.size () )
+			out._tangents.push_back (in_tangent) ;
+		if ( in._binormals.size () )
+			out._binormals.push_back (in_binormal) ;
+		if ( in._vcolors.size () )
+			out._vcolors.push_back (in_vcolor) ;
+		unsigned short index =(unsigned short)out._positions.size () - 1 ;
+		VertexToOutIndex [packed] =index ;
+		out._indices.push_back (index) ;
+	}
+}
+
+// The gltfwriterVBO::weldVBO () before gltfVertexKernel, the all attributes kernel tests the sizes instead of the mask
+static bool genericWithin (const double *a, const double *b, int nb, double tolerance) {
+	for ( int i =0 ; i < nb ; i++ ) {
+		if ( std::fabs (a [i] - b [i]) > tolerance )
+			return (false) ;
+	}
+	return (true) ;
+}
+
+static bool genericWeldable (const gltfVertexStreams &in, size_t i, const gltfVertexStreams &out, int j, const gltfWeldTolerances &tolerances) {
+	if ( !genericWithin (in._positions [i].mData, out._positions [j].mData, 3, tolerances._position) )
+		return (false) ;
+	if ( in._normals.size () && !genericWithin (in._normals [i].mData, out._normals [j].mData, 3, tolerances._normal) )
+		return (false) ;
+	if ( in._uvs.size () && !genericWithin (in._uvs [i].mData, out._uvs [j].mData, 2, tolerances._uv) )
+		return (false) ;
+	if ( in._tangents.size () && !genericWithin (in._tangents [i].mData, out._tangents [j].mData, 3, tolerances._normal) )
+		return (false) ;
+	if ( in._binormals.size () && !genericWithin (in._binormals [i].mData, out._binormals [j].mData, 3, tolerances._normal) )
+		return (false) ;
+	if ( in._vcolors.size () ) {
+		const FbxColor &a =in._vcolors [i], &b =out._vcolors [j] ;
+		double ca [4] ={ a.mRed, a.mGreen, a.mBlue, a.mAlpha }, cb [4] ={ b.mRed, b.mGreen, b.mBlue, b.mAlpha } ;
+		if ( !genericWithin (ca, cb, 4, tolerances._color) )
+			return (false) ;
+	}
+	return (true) ;
+}
+
+static void genericWeld (const gltfVertexStreams &in, gltfVertexStreams &out, const gltfWeldTolerances &tolerances) {
+	const double cellSize =tolerances._position ;
+	std::unordered_map<uint64_t, int> cells ;
+	std::vector<int> next ;
+	cells.reserve (in._positions.size ()) ;
+	next.reserve (in._positions.size ()) ;
+	for ( size_t i =0 ; i < in._positions.size () ; i++ ) {
+		int64_t cell [3] ;
+		for ( int k =0 ; k < 3 ; k++ )
+			cell [k] =(int64_t)std::floor (in._positions [i] [k] / cellSize) ;
+		int found =-1 ;
+		for ( int dx =-1 ; dx <= 1 && found < 0 ; dx++ ) {
+			for ( int dy =-1 ; dy <= 1 && found < 0 ; dy++ ) {
+				for ( int dz =-1 ; dz <= 1 && found < 0 ; dz++ ) {
+					int64_t neighbour [3] ={ cell [0] + dx, cell [1] + dy, cell [2] + dz } ;
+					auto iter =cells.find (gltfHash64 (neighbour, sizeof (neighbour))) ;
+					if ( iter == cells.end () )
+						continue ;
+					for ( int j =iter->second ; j >= 0 && found < 0 ; j =next [j] ) {
+						if ( genericWeldable (in, i, out, j, tolerances) )
+							found =j ;
+					}
+				}
+			}
+		}
+		if ( found >= 0 ) {
+			out._indices.push_back ((unsigned short)found) ;
+			continue ;
+		}
+		out._positions.push_back (in._positions [i]) ;
+		if ( in._uvs.size () )
+			out._uvs.push_back (in._uvs [i]) ;
+		if ( in._normals.size () )
+			out._normals.push_back (in._normals [i]) ;
+		if ( in._tangents.size () )
+			out._tangents.push_back (in._tangents [i]) ;
+		if ( in._binormals.size () )
+			out._binormals.push_back (in._binormals [i]) ;
+		if ( in._vcolors.size () )
+			out._vcolors.push_back (in._vcolors [i]) ;
+		int index =(int)out._positions.size () - 1 ;
+		int &head =cells.insert (std::make_pair (gltfHash64 (cell, sizeof (cell)), -1)).first->second ;
+		next.push_back (head) ;
+		head =index ;
+		out._indices.push_back ((unsigned short)index) ;
+	}
+}
+
+static double median (std::vector<double> values) {
+	std::sort (values.begin (), values.end ()) ;
+	return (values.size () ? values [values.size () / 2] : 0.) ;
+}
+
+static bool sameStreams (const gltfVertexStreams &a, const gltfVertexStreams &b) {
+	return (a._indices == b._indices && a._positions.size () == b._positions.size ()
+		&& a._normals.size () == b._normals.size () && a._uvs.size () == b._uvs.size ()
+		&& a._vcolors.size () == b._vcolors.size ()) ;
+}
+
+template<class G, class S>
+static Json::Value timeKernels (const gltfVertexStreams &in, int iterations, G generic, S specialized) {
+	std::vector<double> genericSeconds, specializedSeconds ;
+	gltfVertexStreams expected, out ;
+	for ( int i =0 ; i < iterations ; i++ ) {
+		expected =gltfVertexStreams () ;
+		auto start =std::chrono::steady_clock::now () ;
+		generic (in, expected) ;
+		genericSeconds.push_back (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ()) ;
+
+		out =gltfVertexStreams () ;
+		start =std::chrono::steady_clock::now () ;
+		specialized (in, out) ;
+		specializedSeconds.push_back (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ()) ;
+	}
+	double g =median (genericSeconds), s =median (specializedSeconds) ;
+	Json::Value def ;
+	def ["vertices"] =(Json::UInt64)out._positions.size () ;
+	def ["genericSeconds"] =g ;
+	def ["specializedSeconds"] =s ;
+	def ["genericCornersPerSecond"] =g > 0. ? (double)in._positions.size () / g : 0. ;
+	def ["specializedCornersPerSecond"] =s > 0. ? (double)in._positions.size () / s : 0. ;
+	def ["speedup"] =s > 0. ? g / s : 0. ;
+	def ["identical"] =sameStreams (expected, out) ;
+	std::cout << std::setw (10) << g << (" s") << std::setw (10) << s << (" s") << std::setw (8) << (s > 0. ? g / s : 0.) << ("x")
+		<< (sameStreams (expected, out) ? ("") : ("  output differs!")) ;
+	return (def) ;
+}
+
+Json::Value parallelIndexBench (int size, int iterations) {
+	static const size_t threads [] ={ 1, 4, 16, 32 } ;
+	gltfVertexStreams in ;
+	gridCorners (size, eVertexNormal, in) ;
+
+	Json::Value ret (Json::arrayValue) ;
+	std::cout << std::fixed << std::setprecision (4) ;
+	for ( size_t nbThreads : threads ) {
+		threadPool pool (nbThreads) ;
+		Json::Value def ;
+		def ["threads"] =(Json::UInt64)nbThreads ;
+		// Speedups only mean something when the machine has that many cores
+		def ["hardwareThreads"] =(Json::UInt64)std::thread::hardware_concurrency () ;
+		def ["corners"] =(Json::UInt64)in._positions.size () ;
+		std::cout << ("  ") << std::setw (2) << nbThreads << (" thread(s) ") ;
+		// Past 65535 vertices too, the indices are 32 bits in both kernels
+		def ["index"] =timeKernels (in, iterations, gltfVertexKernels::index,
+			[&pool] (const gltfVertexStreams &in, gltfVertexStreams &out) { gltfVertexKernels::indexParallel (in, out, pool) ; }
+		) ;
+		std::cout << std::endl ;
+		ret.append (def) ;
+	}
+	return (ret) ;
+}
+
+Json::Value vertexKernelBench (int size, int iterations) {
+	static const struct { unsigned int _attributes ; const char *_name ; } inputs [] ={
+		{ eVertexNormal, "position+normal" },
+		{ eVertexNormal | eVertexUV, "position+normal+uv" },
+		{ eVertexAllAttributes, "all" }
+	} ;
+	// Stay below the unsigned short index range of the generic (former) kernels
+	size =std::min (size, 180) ;
+	gltfWeldTolerances tolerances ;
+	tolerances._position =1e-4 ;
+
+	Json::Value ret (Json::arrayValue) ;
+	std::cout << std::fixed << std::setprecision (4) ;
+	for ( const auto &input : inputs ) {
+		gltfVertexStreams in ;
+		gridCorners (size, input._attributes, in) ;
+		Json::Value def ;
+		def ["attributes"] =input._name ;
+		def ["corners"] =(Json::UInt64)in._positions.size () ;
+		std::cout << ("  ") << std::left << std::setw (20) << input._name << std::right << ("index") ;
+		def ["index"] =timeKernels (in, iterations, genericIndex, gltfVertexKernels::index) ;
+		std::cout << std::endl << ("  ") << std::setw (20) << ("") << ("weld ") ;
+		def ["weld"] =timeKernels (in, iterations,
+			[&tolerances] (const gltfVertexStreams &in, gltfVertexStreams &out) { genericWeld (in, out, tolerances) ; },
+			[&tolerances] (const gltfVertexStreams &in, gltfVertexStreams &out) { gltfVertexKernels::weld (in, out, tolerances) ; }
+		) ;
+		std::cout << std::endl ;
+		ret.append (def) ;
+	}
+
+	// Per control point attributes, corners hashed vs control points hashed
+	gltfVertexStreams points, in ;
+	std::vector<int> corners ;
+	gridPoints (size, points, corners) ;
+	gltfVertexKernels::expand (points, corners, in) ;
+	Json::Value def ;
+	def ["attributes"] ="position+normal by control point" ;
+	def ["corners"] =(Json::UInt64)in._positions.size () ;
+	std::cout << ("  ") << std::left << std::setw (20) << ("by control point") << std::right << ("index") ;
+	def ["index"] =timeKernels (in, iterations, gltfVertexKernels::index,
+		[&points, &corners] (const gltfVertexStreams &, gltfVertexStreams &out) { gltfVertexKernels::indexPoints (points, corners, out) ; }
+	) ;
+	std::cout << std::endl ;
+	ret.append (def) ;
+	return (ret) ;
+}
@@ -0,0 +1,34 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include "jsoncpp/json.h"
+
+// Times the attribute specialized gltfVertexKernel index () and weld () against the former generic ones (a full
+// PackedVertex key in a std::map, and a test of every attribute size for every vertex) on the triangle corners
+// of a synthetic size x size quad grid, for position+normal, position+normal+uv and all attributes inputs. Then
+// times indexPoints () against index () on a position+normal by control point grid. Returns one report entry
+// per input.
+Json::Value vertexKernelBench (int size, int iterations) ;
+
+// Times gltfVertexKernel indexParallel () at 1, 4, 16 and 32 threads against index () on the triangle corners of a
+// synthetic size x size quad grid with normals (1826 gives 20M corners). Returns one report entry per thread count.
+Json::Value parallelIndexBench (int size, int iterations) ;
@@ -0,0 +1,54 @@
+#!/bin/bash
+#
+# Compares cold glTF conversions (one process each, paying for the FBX SDK and plug-in
+# initialization) with requests to a warm conversion daemon (glTF --serve).
+#
+# usage: latency.sh <glTF executable> <input file> [iterations, default:10] [output directory]
+#
+# Needs GNU date (%N).
+
+exe=$1
+input=$2
+n=${3:-10}
+out=${4:-$(mktemp -d)}
+socket=$(mktemp -u /tmp/gltf-latency.XXXXXX)
+
+if [ -z "$exe" ] || [ -z "$input" ]; then
+	echo "usage: latency.sh <glTF executable> <input file> [iterations] [output directory]"
+	exit 1
+fi
+
+now () {
+	date +%s%N
+}
+
+# Runs "$@" n times, prints the mean and min latency in milliseconds
+measure () {
+	local total=0 min=0
+	for (( i=0 ; i < n ; i++ )); do
+		local start=$(now)
+		"$@" > /dev/null 2>&1 || echo "  run $i failed" >&2
+		local elapsed=$(( ($(now) - start) / 1000 ))
+		total=$(( total + elapsed ))
+		if [ $min -eq 0 ] || [ $elapsed -lt $min ]; then
+			min=$elapsed
+		fi
+	done
+	printf "%10.2f ms mean %10.2f ms min\n" $(echo "$total / $n / 1000" | bc -l) $(echo "$min / 1000" | bc -l)
+}
+
+echo "Cold CLI ($n runs):"
+measure "$exe" -f "$input" -o "$out"
+
+"$exe" --serve "$socket" -j 1 > /dev/null 2>&1 &
+daemon=$!
+for (( i=0 ; i < 100 ; i++ )); do
+	[ -S "$socket" ] && "$exe" --client "$socket" -f "$input" -o "$out" > /dev/null 2>&1 && break
+	sleep 0.1
+done
+
+echo "Warm daemon ($n requests):"
+measure "$exe" --client "$socket" -f "$input" -o "$out"
+
+"$exe" --client "$socket" --shutdown > /dev/null 2>&1 || kill $daemon
+wait $daemon 2> /dev/null
@@ -20,7 +20,12 @@
 //
 #include "StdAfx.h"
 #include "getopt.h"
+#include "gltfBatch.h"
+#include "gltfServer.h"
+#include "gltfProbe.h"
+#include "gltfWeld.h"
 #include <iostream>
+#include <cstdlib>
 #if defined(_WIN32) || defined(_WIN64)
 #include "tchar.h"
 #endif
@@ -32,6 +37,7 @@
 // -f $(ProjectDir)\..\models\wine\wine.fbx -o $(ProjectDir)\..\models\wine\out -n test -c
 // -f $(ProjectDir)\..\models\monster\monster.fbx -o $(ProjectDir)\..\models\monster\out -n test -c
 // -f $(ProjectDir)\..\models\Carnivorous_plant\Carnivorous_plant.fbx -o $(ProjectDir)\..\models\Carnivorous_plant\out -n test -c
+// -b $(ProjectDir)\..\models -o $(ProjectDir)\..\models\out -c
 
 	//{ ("n"), ("a"), required_argument, ("-a -> export animations, argument [bool], default:true") },
 	//{ ("n"), ("g"), required_argument, ("-g -> [experimental] GLSL version to output in generated shaders") },
@@ -41,8 +47,15 @@
 	//{ ("n"), ("n"), no_argument, ("-n -> don't combine animations with the same target") }
 
 void usage () {
-	std::cout << std::endl << ("glTF [-h] [-v] [-n] [-d] [-t] [-l] [-c] [-e] [-o <output path>] -f <input file>") << std::endl ;
+	std::cout << std::endl << ("glTF [-h] [-v] [-n] [-d] [-t] [-l] [-c] [-e] [-j <jobs>] [--job-timeout <seconds>] [--probe] [--serve <socket> | --client <socket> [--shutdown]] [-o <output path>] [--trace <trace file>] [--mem-report <report file>] [--cache <folder>] [--import-profile auto|static|full] [--root <glob>] [--include <glob>] [--exclude <glob>] [--types <types>] [--root-conversion] [--weld <tolerances>] -f <input file> | -b <batch> ...") << std::endl ;
 	std::cout << ("-f/--file \t\t- file to convert to glTF [string]") << std::endl ;
+	std::cout << ("-b/--batch \t\t- convert many files in one process: a directory (all .fbx files below), a wildcard pattern or a .txt/.lst list file, can be repeated [string]") << std::endl ;
+	std::cout << ("-j/--jobs \t\t- batch and serve modes, number of worker processes converting in parallel [int], default:1") << std::endl ;
+	std::cout << ("--job-timeout \t\t- batch mode, kill a worker stuck longer than that on one file, the file is retried alone once then reported as timed out [float], default:0 (no limit)") << std::endl ;
+	std::cout << ("--probe \t\t- print the statistics and estimated output size of the -f / -b files as JSON, without converting them") << std::endl ;
+	std::cout << ("--serve \t\t- run as a conversion daemon listening on a local socket [string]") << std::endl ;
+	std::cout << ("--client \t\t- send the -f conversion to the daemon listening on a local socket [string]") << std::endl ;
+	std::cout << ("--shutdown \t\t- with --client, stop the daemon") << std::endl ;
 	std::cout << ("-o/--output \t\t- path of output directory [string]") << std::endl ;
 	std::cout << ("-n/--name \t\t- override the scene name [string]") << std::endl ;
 	std::cout << ("-d/--degree \t\t- output angles in degrees vs radians (default to radians)") << std::endl ;
@@ -50,12 +63,29 @@ void usage () {
 	//std::cout << ("-l/--lighting \t- enable default lighting (if no lights in scene)") << std::endl ;
 	std::cout << ("-c/--copy \t\t- copy all media to the target directory (cannot be combined with --embed)") << std::endl ;
 	std::cout << ("-e/--embed \t\t- embed all resources as Data URIs (cannot be combined with --copy)") << std::endl ;
+	std::cout << ("--trace \t\t- write a Chrome trace of the conversion (chrome://tracing), one file per input in batch mode (trace.json -> trace.<input>.json) [string]") << std::endl ;
+	std::cout << ("--mem-report \t\t- write the time and heap usage of every conversion phase, one file per input in batch mode [string]") << std::endl ;
+	std::cout << ("--cache \t\t- reuse the mesh buffers of unchanged meshes from previous exports stored in that folder [string]") << std::endl ;
+	std::cout << ("--import-profile \t- what the FBX importer loads, static skips animation, constraints, shapes and skins (animated nodes keep their default transforms, not their frame 0 pose), auto skips constraints, characters, shapes and gobos, full loads everything [auto|static|full], default:auto") << std::endl ;
+	std::cout << ("--root \t\t- export only the subtrees whose root node name matches, can be repeated [glob]") << std::endl ;
+	std::cout << ("--include \t\t- export only the nodes (and their subtrees) whose name matches, can be repeated [glob]") << std::endl ;
+	std::cout << ("--exclude \t\t- do not export the nodes (and their subtrees) whose name matches, can be repeated [glob]") << std::endl ;
+	std::cout << ("--types \t\t- export only these node types, other nodes are kept as transforms [mesh,camera,light,null,...]") << std::endl ;
+	std::cout << ("--root-conversion \t- keep the FBX axis system and unit, and convert them on the glTF top nodes only (faster on large scenes)") << std::endl ;
+	std::cout << ("--weld \t\t- merge the vertices whose attributes differ by less than the tolerances, hard edges and uv seams beyond them are kept [position[,normal[,uv[,color]]]], default:0,1e-3,1e-5,1e-3") << std::endl ;
 	std::cout << ("-h/--help \t\t- this message") << std::endl ;
 	std::cout << ("-v/--version \t\t- version") << std::endl ;
 }
 
 static struct option long_options [] ={
 	{ ("file"), ARG_REQ, 0, ('f') },
+	{ ("batch"), ARG_REQ, 0, ('b') },
+	{ ("jobs"), ARG_REQ, 0, ('j') },
+	{ ("job-timeout"), ARG_REQ, 0, ('O') },
+	{ ("probe"), ARG_NONE, 0, ('Q') },
+	{ ("serve"), ARG_REQ, 0, ('S') },
+	{ ("client"), ARG_REQ, 0, ('C') },
+	{ ("shutdown"), ARG_NONE, 0, ('X') },
 	{ ("output"), ARG_REQ, 0, ('o') },
 	{ ("name"), ARG_REQ, 0, ('n') },
 	{ ("degree"), ARG_NONE, 0, ('d') },
@@ -63,6 +93,16 @@ static struct option long_options [] ={
 	{ ("lighting"), ARG_NONE, 0, ('l') },
 	{ ("copy"), ARG_NONE, 0, ('c') },
 	{ ("embed"), ARG_NONE, 0, ('e') },
+	{ ("trace"), ARG_REQ, 0, ('T') },
+	{ ("mem-report"), ARG_REQ, 0, ('M') },
+	{ ("cache"), ARG_REQ, 0, ('K') },
+	{ ("import-profile"), ARG_REQ, 0, ('P') },
+	{ ("root"), ARG_REQ, 0, ('R') },
+	{ ("include"), ARG_REQ, 0, ('I') },
+	{ ("exclude"), ARG_REQ, 0, ('E') },
+	{ ("types"), ARG_REQ, 0, ('Y') },
+	{ ("root-conversion"), ARG_NONE, 0, ('U') },
+	{ ("weld"), ARG_REQ, 0, ('W') },
 	{ ("help"), ARG_NONE, 0, ('h') },
 	{ ("version"), ARG_NONE, 0, ('v') },
 
@@ -83,12 +123,26 @@ int main (int argc, char *argv []) {
 	bool defaultLighting =false ;
 	bool copyMedia =false ;
 	bool embedMedia =false ;
+	std::string traceFile ;
+	std::string memReport ;
+	std::string meshCache ;
+	gltfPackage::EImportProfile importProfile =gltfPackage::eImportAuto ;
+	_IOglTF_NS_::gltfNodeFilter filter ;
+	bool bRootConversion =false ;
+	std::string weld ;
+	std::vector<std::string> batch ;
+	int nbJobs =1 ;
+	double jobTimeout =0. ;
+	bool bProbe =false ;
+	std::string serveSocket ;
+	std::string clientSocket ;
+	bool bShutdown =false ;
 	while ( bLoop ) {
 		int option_index =0 ;
 		// http://www.gnu.org/software/libc/manual/html_node/Argument-Syntax.html
 		// http://www.gnu.org/software/libc/manual/html_node/Argp-Examples.html#Argp-Examples
 		// http://stackoverflow.com/questions/13251732/c-how-to-specify-an-optstring-in-the-getopt-function
-		int c =getopt_long (argc, argv, ("f:o:n:tlcehv"), long_options, &option_index) ;
+		int c =getopt_long (argc, argv, ("f:b:j:o:n:tlcehv"), long_options, &option_index) ;
 		// Check for end of operation or error
 		if ( c == -1 )
 			break ;
@@ -113,6 +167,27 @@ int main (int argc, char *argv []) {
 			case ('f'): // file to convert to glTF [string]
 				inFile =optarg ;
 				break ;
+			case ('b'): // convert many files in one process [string]
+				batch.push_back (optarg) ;
+				break ;
+			case ('j'): // number of worker processes converting in parallel [int]
+				nbJobs =atoi (optarg) ;
+				break ;
+			case ('O'): // seconds a batch worker gets for one file [float]
+				jobTimeout =atof (optarg) ;
+				break ;
+			case ('Q'): // print the statistics of the files without converting them
+				bProbe =true ;
+				break ;
+			case ('S'): // run as a conversion daemon [string]
+				serveSocket =optarg ;
+				break ;
+			case ('C'): // send the conversion to the daemon [string]
+				clientSocket =optarg ;
+				break ;
+			case ('X'): // stop the daemon
+				bShutdown =true ;
+				break ;
 			case ('o'): // path of output directory argument [string]
 				outDir =optarg ;
 				break ;
@@ -134,7 +209,99 @@ int main (int argc, char *argv []) {
 			case ('e'): // embed all resources as Data URIs (cannot be combined with --copy)
 				embedMedia =!copyMedia ;
 				break ;
+			case ('T'): // write a Chrome trace of the conversion [string]
+				traceFile =optarg ;
+				break ;
+			case ('M'): // write the time and heap usage of every conversion phase, one file per input in batch mode [string]
+				memReport =optarg ;
+				break ;
+			case ('K'): // reuse the mesh buffers from previous exports [string]
+				meshCache =optarg ;
+				break ;
+			case ('P'): // what the FBX importer loads [string]
+				if ( !gltfPackage::importProfile (optarg, importProfile) )
+					std::cout << ("Warning: unknown import profile ") << optarg << (", using auto") << std::endl ;
+				break ;
+			case ('R'): // export only the subtrees whose root node name matches [glob]
+				filter.root (optarg) ;
+				break ;
+			case ('I'): // export only the nodes whose name matches [glob]
+				filter.include (optarg) ;
+				break ;
+			case ('E'): // do not export the nodes whose name matches [glob]
+				filter.exclude (optarg) ;
+				break ;
+			case ('Y'): // export only these node types [string]
+				if ( !filter.types (optarg) )
+					std::cout << ("Warning: unknown node type in ") << optarg << std::endl ;
+				break ;
+			case ('U'): // convert the axis system and unit on the top nodes only
+				bRootConversion =true ;
+				break ;
+			case ('W'): // merge the vertices within the tolerances [string]
+				if ( !_IOglTF_NS_::gltfWeldTolerances ().parse (optarg) )
+					std::cout << ("Warning: invalid weld tolerances ") << optarg << (", welding disabled") << std::endl ;
+				else
+					weld =optarg ;
+				break ;
+		}
+	}
+	if ( serveSocket.length () )
+		return (gltfServer (serveSocket, nbJobs).serve ()) ;
+	if ( clientSocket.length () ) {
+		Json::Value req ;
+		if ( bShutdown )
+			req ["command"] ="shutdown" ;
+		else
+			req =gltfServer::conversionRequest (
+				inFile, outDir, name, angleInDegree, reverseTransparency, defaultLighting, copyMedia, embedMedia,
+				meshCache, importProfile, filter, bRootConversion, weld, traceFile, memReport
+			) ;
+		return (gltfServer::request (clientSocket, req, std::cout)) ;
+	}
+	if ( bProbe ) {
+		gltfBatch files ;
+		for ( const std::string &spec : batch ) {
+			if ( !files.add (spec) )
+				std::cerr << ("Warning: nothing to probe in ") << spec << std::endl ;
+		}
+		if ( inFile.length () )
+			files.add (inFile) ;
+		Json::Value report (Json::arrayValue) ;
+		size_t nbFailures =0 ;
+		for ( const gltfBatch::input &in : files.inputs () ) {
+			Json::Value stats =gltfProbe::probe (in._file, importProfile, filter) ;
+			if ( stats [("status")].asString () != ("ok") )
+				nbFailures++ ;
+			report.append (stats) ;
+		}
+		// A single -f file gives an object, batches an array
+		Json::StyledWriter writer ;
+		std::cout << writer.write (batch.size () == 0 && report.size () == 1 ? report [0] : report) ;
+		return (nbFailures ? 1 : 0) ;
+	}
+	if ( batch.size () ) {
+		gltfBatch files ;
+		files.ioSettings (angleInDegree, reverseTransparency, defaultLighting, copyMedia, embedMedia) ;
+		files.meshCache (meshCache) ;
+		files.importProfile (importProfile) ;
+		files.nodeFilter (filter) ;
+		files.rootConversion (bRootConversion) ;
+		files.weld (weld) ;
+		files.traceFile (traceFile) ;
+		files.memoryReport (memReport) ;
+		files.jobTimeout (jobTimeout) ;
+		for ( const std::string &spec : batch ) {
+			if ( !files.add (spec) )
+				std::cout << ("Warning: nothing to convert in ") << spec << std::endl ;
 		}
+		if ( inFile.length () )
+			files.add (inFile) ;
+		if ( name.length () )
+			std::cout << ("Warning: --name is ignored in batch mode") << std::endl ;
+		size_t nbFailures =files.runParallel (outDir, nbJobs) ;
+		files.summary (std::cout) ;
+		return (nbFailures ? 1 : 0) ;
 	}
 #if defined(_WIN32) || defined(_WIN64)
 	if ( inFile.length () == 0  || _taccess_s (inFile.c_str (), 0) == ENOENT )
@@ -155,6 +322,17 @@ int main (int argc, char *argv []) {
 	
 	std::shared_ptr <gltfPackage> asset (new gltfPackage ()) ;
 	asset->ioSettings (name.c_str (), angleInDegree, reverseTransparency, defaultLighting, copyMedia, embedMedia) ;
+	if ( traceFile.length () )
+		asset->traceFile (traceFile.c_str ()) ;
+	if ( memReport.length () )
+		asset->memoryReport (memReport.c_str ()) ;
+	if ( meshCache.length () )
+		asset->meshCache (meshCache.c_str ()) ;
+	asset->importProfile (importProfile) ;
+	asset->nodeFilter (filter) ;
+	asset->rootConversion (bRootConversion) ;
+	if ( weld.length () )
+		asset->weld (weld.c_str ()) ;
 
 	std::cout << ("Loading file: ") << inFile << ("...") << std::endl ;
 	bool bRet =asset->load (inFile) ;
@@ -0,0 +1,563 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "glTF.h"
+#include "gltfBatch.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sys/stat.h>
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <glob.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+static const char sSeparator ='\\' ;
+#else
+static const char sSeparator ='/' ;
+#endif
+
+//-----------------------------------------------------------------------------
+gltfBatch::gltfBatch () : _wallSeconds (0.), _ioSettings ({ false, false, false, false, false }), _importProfile (gltfPackage::eImportAuto), _bRootConversion (false), _jobTimeout (0.) {
+}
+
+gltfBatch::~gltfBatch () {
+}
+
+void gltfBatch::ioSettings (
+	bool angleInDegree /*=false*/,
+	bool reverseTransparency /*=false*/,
+	bool defaultLighting /*=false*/,
+	bool copyMedia /*=false*/,
+	bool embedMedia /*=false*/
+) {
+	_ioSettings ={ angleInDegree, reverseTransparency, defaultLighting, copyMedia, embedMedia } ;
+}
+
+bool gltfBatch::add (const std::string &spec, const char *extension /*=".fbx"*/) {
+	size_t nb =_inputs.size () ;
+	if ( spec.find_first_of (("*?")) != std::string::npos ) {
+		std::vector<std::string> files ;
+		glob (spec, files) ;
+		for ( const std::string &fn : files ) {
+			if ( !isDirectory (fn) )
+				_inputs.push_back ({ fn, (""), fileSize (fn) }) ;
+		}
+	} else if ( isDirectory (spec) ) {
+		std::string root (spec) ;
+		if ( root [root.length () - 1] == ('/') || root [root.length () - 1] == ('\\') )
+			root.resize (root.length () - 1) ;
+		std::vector<std::string> files ;
+		listFiles (root, true, files) ;
+		for ( const std::string &fn : files ) {
+			if ( extension != nullptr && extensionOf (fn) != extension )
+				continue ;
+			std::string subdir =gltfPackage::pathname (fn).substr (root.length () + 1) ;
+			_inputs.push_back ({ fn, subdir, fileSize (fn) }) ;
+		}
+	} else if ( extensionOf (spec) == (".txt") || extensionOf (spec) == (".lst") ) {
+		std::ifstream list (spec, std::ios::in) ;
+		if ( !list.is_open () )
+			return (false) ;
+		std::string base =gltfPackage::pathname (spec) ;
+		std::string line ;
+		while ( std::getline (list, line) ) {
+			line.erase (0, line.find_first_not_of ((" \t"))) ;
+			line.erase (line.find_last_not_of ((" \t\r")) + 1) ;
+			if ( line.length () == 0 || line [0] == ('#') )
+				continue ;
+			bool bAbsolute =line [0] == ('/') || line [0] == ('\\') || (line.length () > 1 && line [1] == (':')) ;
+			std::string fn =bAbsolute ? line : base + line ;
+			_inputs.push_back ({ fn, (""), fileSize (fn) }) ;
+		}
+	} else {
+		_inputs.push_back ({ spec, (""), fileSize (spec) }) ;
+	}
+	return (_inputs.size () > nb) ;
+}
+
+size_t gltfBatch::run (const std::string &outdir, bool bVerbose /*=true*/) {
+	auto start =std::chrono::steady_clock::now () ;
+	size_t nbFailures =0 ;
+	_results.clear () ;
+	_results.reserve (_inputs.size ()) ;
+	for ( size_t i =0 ; i < _inputs.size () ; i++ ) {
+		if ( bVerbose )
+			std::cout << ("[") << (i + 1) << ("/") << _inputs.size () << ("] ") << _inputs [i]._file << std::endl ;
+		result ret =convert (_inputs [i], outdir) ;
+		if ( !ret._bSuccess )
+			nbFailures++ ;
+		_results.push_back (ret) ;
+	}
+	_wallSeconds =std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count () ;
+	return (nbFailures) ;
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+// Worker to parent message, the processes run the same executable
+struct gltfBatchMessage {
+	uint32_t _index ;
+	uint32_t _bSuccess ;
+	double _loadSeconds ;
+	double _saveSeconds ;
+} ;
+
+struct gltfBatchWorker {
+	pid_t _pid ;
+	int _jobs ; // parent -> worker: input indices
+	int _results ; // worker -> parent: gltfBatchMessage
+	int64_t _index ; // input being converted, -1 if none
+	std::chrono::steady_clock::time_point _deadline ; // of the input being converted, with a job timeout
+} ;
+
+static bool readAll (int fd, void *p, size_t size) {
+	for ( char *pt =(char *)p ; size ; ) {
+		ssize_t nb =read (fd, pt, size) ;
+		if ( nb < 0 && errno == EINTR )
+			continue ;
+		if ( nb <= 0 )
+			return (false) ;
+		pt +=nb ;
+		size -=(size_t)nb ;
+	}
+	return (true) ;
+}
+
+static bool writeAll (int fd, const void *p, size_t size) {
+	for ( const char *pt =(const char *)p ; size ; ) {
+		ssize_t nb =write (fd, pt, size) ;
+		if ( nb < 0 && errno == EINTR )
+			continue ;
+		if ( nb <= 0 )
+			return (false) ;
+		pt +=nb ;
+		size -=(size_t)nb ;
+	}
+	return (true) ;
+}
+
+static void stopWorker (gltfBatchWorker &worker) {
+	if ( worker._jobs >= 0 )
+		close (worker._jobs) ;
+	if ( worker._results >= 0 )
+		close (worker._results) ;
+	worker._jobs =worker._results =-1 ;
+	worker._index =-1 ;
+	if ( worker._pid > 0 ) {
+		int status =0 ;
+		while ( waitpid (worker._pid, &status, 0) < 0 && errno == EINTR )
+			;
+	}
+	worker._pid =-1 ;
+}
+
+// Waits for the worker result, and kills the worker when it has not answered within timeout seconds (0 to wait
+// forever)
+static bool waitResult (gltfBatchWorker &worker, gltfBatchMessage &msg, double timeout, bool &bTimedOut) {
+	bTimedOut =false ;
+	auto deadline =std::chrono::steady_clock::now () + std::chrono::duration_cast<std::chrono::steady_clock::duration> (std::chrono::duration<double> (timeout)) ;
+	while ( timeout > 0. ) {
+		int64_t left =std::chrono::duration_cast<std::chrono::milliseconds> (deadline - std::chrono::steady_clock::now ()).count () ;
+		if ( left <= 0 ) {
+			kill (worker._pid, SIGKILL) ;
+			bTimedOut =true ;
+			return (false) ;
+		}
+		struct pollfd fd ={ worker._results, POLLIN, 0 } ;
+		int nb =poll (&fd, 1, (int)std::min (left, (int64_t)INT_MAX)) ;
+		if ( nb < 0 && errno != EINTR )
+			return (false) ;
+		if ( nb > 0 )
+			break ;
+	}
+	return (readAll (worker._results, &msg, sizeof (msg))) ;
+}
+
+// The child must not keep the pipes of its siblings open, or they would never see their end of file
+static bool startWorker (gltfBatch &batch, const std::string &outdir, gltfBatchWorker &worker, const std::vector<gltfBatchWorker> &workers) {
+	int jobs [2], results [2] ;
+	if ( pipe (jobs) != 0 )
+		return (false) ;
+	if ( pipe (results) != 0 ) {
+		close (jobs [0]) ;
+		close (jobs [1]) ;
+		return (false) ;
+	}
+	std::cout.flush () ;
+	pid_t pid =fork () ;
+	if ( pid < 0 ) {
+		close (jobs [0]) ; close (jobs [1]) ;
+		close (results [0]) ; close (results [1]) ;
+		return (false) ;
+	}
+	if ( pid == 0 ) {
+		for ( const gltfBatchWorker &other : workers ) {
+			if ( other._jobs >= 0 )
+				close (other._jobs) ;
+			if ( other._results >= 0 )
+				close (other._results) ;
+		}
+		close (jobs [1]) ;
+		close (results [0]) ;
+		uint32_t index =0 ;
+		while ( readAll (jobs [0], &index, sizeof (index)) ) {
+			gltfBatchMessage msg ={ index, 0, 0., 0. } ;
+			if ( index < batch.inputs ().size () ) {
+				gltfBatch::result ret =batch.convert (batch.inputs () [index], outdir) ;
+				msg ={ index, ret._bSuccess ? 1u : 0u, ret._loadSeconds, ret._saveSeconds } ;
+			}
+			std::cout.flush () ;
+			if ( !writeAll (results [1], &msg, sizeof (msg)) )
+				break ;
+		}
+		_exit (0) ;
+	}
+	close (jobs [0]) ;
+	close (results [1]) ;
+	worker ={ pid, jobs [1], results [0], -1 } ;
+	return (true) ;
+}
+#endif
+
+size_t gltfBatch::runParallel (const std::string &outdir, int nbJobs, bool bVerbose /*=true*/) {
+#if defined(_WIN32) || defined(_WIN64)
+	if ( nbJobs > 1 )
+		std::cout << ("Warning: --jobs is not supported on Windows, converting serially") << std::endl ;
+	if ( _jobTimeout > 0. )
+		std::cout << ("Warning: --job-timeout is not supported on Windows, ignored") << std::endl ;
+	return (run (outdir, bVerbose)) ;
+#else
+	// A hung conversion can only be killed in a worker process
+	if ( (nbJobs <= 1 || _inputs.size () <= 1) && _jobTimeout <= 0. )
+		return (run (outdir, bVerbose)) ;
+	nbJobs =std::max (nbJobs, 1) ;
+	auto timeout =std::chrono::duration_cast<std::chrono::steady_clock::duration> (std::chrono::duration<double> (_jobTimeout)) ;
+	auto start =std::chrono::steady_clock::now () ;
+	signal (SIGPIPE, SIG_IGN) ; // a dead worker must not kill the parent
+
+	_results.clear () ;
+	for ( const input &in : _inputs )
+		_results.push_back ({ in._file, false, false, false, 0., 0. }) ;
+	// Largest first, so the long conversions do not end up last on a single core
+	std::vector<size_t> queue (_inputs.size ()) ;
+	for ( size_t i =0 ; i < queue.size () ; i++ )
+		queue [i] =i ;
+	std::stable_sort (queue.begin (), queue.end (), [this] (size_t a, size_t b) { return (_inputs [a]._bytes > _inputs [b]._bytes) ; }) ;
+	size_t next =0, done =0 ;
+	std::vector<size_t> crashed ;
+
+	auto report =[&] (size_t index, const char *pszStatus) {
+		done++ ;
+		if ( bVerbose )
+			std::cout << ("[") << done << ("/") << _inputs.size () << ("] ") << _inputs [index]._file << (" ") << pszStatus << std::endl ;
+	} ;
+	// Hands the next file to a worker, or stops it when there is nothing left (or it is gone)
+	auto dispatch =[&] (gltfBatchWorker &worker) {
+		if ( next < queue.size () ) {
+			uint32_t index =(uint32_t)queue [next] ;
+			if ( writeAll (worker._jobs, &index, sizeof (index)) ) {
+				worker._index =index ;
+				worker._deadline =std::chrono::steady_clock::now () + timeout ;
+				next++ ;
+				return ;
+			}
+		}
+		stopWorker (worker) ;
+	} ;
+
+	std::vector<gltfBatchWorker> workers ;
+	for ( int i =0 ; i < nbJobs && (size_t)i < _inputs.size () ; i++ ) {
+		gltfBatchWorker worker ={ -1, -1, -1, -1 } ;
+		if ( !startWorker (*this, outdir, worker, workers) )
+			break ;
+		workers.push_back (worker) ;
+	}
+	if ( workers.size () == 0 )
+		return (run (outdir, bVerbose)) ;
+	for ( gltfBatchWorker &worker : workers )
+		dispatch (worker) ;
+
+	for ( ;; ) {
+		std::vector<struct pollfd> fds ;
+		std::vector<size_t> owners ;
+		int wait =-1 ; // ms until the first job deadline
+		auto now =std::chrono::steady_clock::now () ;
+		for ( size_t i =0 ; i < workers.size () ; i++ ) {
+			if ( workers [i]._pid > 0 && workers [i]._index >= 0 ) {
+				fds.push_back ({ workers [i]._results, POLLIN, 0 }) ;
+				owners.push_back (i) ;
+				if ( _jobTimeout > 0. ) {
+					int64_t left =std::chrono::duration_cast<std::chrono::milliseconds> (workers [i]._deadline - now).count () + 1 ;
+					left =std::min (std::max (left, (int64_t)0), (int64_t)INT_MAX) ;
+					wait =wait < 0 ? (int)left : std::min (wait, (int)left) ;
+				}
+			}
+		}
+		if ( fds.size () == 0 )
+			break ;
+		if ( poll (fds.data (), (nfds_t)fds.size (), wait) < 0 ) {
+			if ( errno == EINTR )
+				continue ;
+			break ;
+		}
+		now =std::chrono::steady_clock::now () ;
+		for ( size_t i =0 ; i < fds.size () ; i++ ) {
+			gltfBatchWorker &worker =workers [owners [i]] ;
+			bool bTimedOut =fds [i].revents == 0 && _jobTimeout > 0. && now >= worker._deadline ;
+			if ( fds [i].revents == 0 && !bTimedOut )
+				continue ;
+			size_t index =(size_t)worker._index ;
+			gltfBatchMessage msg ;
+			if ( !bTimedOut && readAll (worker._results, &msg, sizeof (msg)) && msg._index == index ) {
+				result &ret =_results [index] ;
+				ret._bSuccess =msg._bSuccess != 0 ;
+				ret._loadSeconds =msg._loadSeconds ;
+				ret._saveSeconds =msg._saveSeconds ;
+				report (index, ret._bSuccess ? ("ok") : ("failed")) ;
+				worker._index =-1 ;
+				dispatch (worker) ;
+				continue ;
+			}
+			// The worker died (or hung) with this file, replace it
+			if ( bTimedOut )
+				kill (worker._pid, SIGKILL) ;
+			stopWorker (worker) ;
+			crashed.push_back (index) ;
+			if ( bVerbose )
+				std::cout << (bTimedOut ? ("Worker timed out on ") : ("Worker crashed on ")) << _inputs [index]._file << (", will retry it alone") << std::endl ;
+			if ( next < queue.size () && startWorker (*this, outdir, worker, workers) )
+				dispatch (worker) ;
+		}
+	}
+	for ( gltfBatchWorker &worker : workers )
+		stopWorker (worker) ;
+	// Files picked by a worker which could not be replaced
+	for ( ; next < queue.size () ; next++ )
+		crashed.push_back (queue [next]) ;
+
+	// Retry the crashed inputs in isolation, so a bad file cannot take other ones down with it
+	for ( size_t index : crashed ) {
+		std::vector<gltfBatchWorker> none ;
+		gltfBatchWorker worker ={ -1, -1, -1, -1 } ;
+		gltfBatchMessage msg ;
+		uint32_t job =(uint32_t)index ;
+		bool bTimedOut =false ;
+		bool bRet =startWorker (*this, outdir, worker, none)
+			&& writeAll (worker._jobs, &job, sizeof (job))
+			&& waitResult (worker, msg, _jobTimeout, bTimedOut)
+			&& msg._index == job ;
+		stopWorker (worker) ;
+		result &ret =_results [index] ;
+		ret._bSuccess =bRet && msg._bSuccess != 0 ;
+		ret._bCrashed =!bRet && !bTimedOut ;
+		ret._bTimedOut =bTimedOut ;
+		if ( bRet ) {
+			ret._loadSeconds =msg._loadSeconds ;
+			ret._saveSeconds =msg._saveSeconds ;
+		}
+		report (index, bRet ? (ret._bSuccess ? ("ok") : ("failed")) : bTimedOut ? ("timed out") : ("crashed")) ;
+	}
+
+	_wallSeconds =std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count () ;
+	size_t nbFailures =0 ;
+	for ( const result &ret : _results ) {
+		if ( !ret._bSuccess )
+			nbFailures++ ;
+	}
+	return (nbFailures) ;
+#endif
+}
+
+// Every conversion would overwrite the same trace / report file, so the input name (and its
+// sub-directory, as inputs of different folders may share a name) goes before the extension
+std::string gltfBatch::perInputFile (const std::string &fn, const input &in) {
+	size_t slash =fn.find_last_of ("/\\") ;
+	size_t dot =fn.rfind ('.') ;
+	if ( dot == std::string::npos || (slash != std::string::npos && dot < slash) )
+		dot =fn.length () ;
+	std::string name =in._subdir ;
+	if ( name.length () )
+		name +='_' ;
+	size_t start =in._file.find_last_of ("/\\") ;
+	name +=in._file.substr (start == std::string::npos ? 0 : start + 1) ;
+	std::replace (name.begin (), name.end (), '/', '_') ;
+	std::replace (name.begin (), name.end (), '\\', '_') ;
+	return (fn.substr (0, dot) + '.' + name + fn.substr (dot)) ;
+}
+
+// Every conversion gets a new scene and exporter (hence writer), only the SDK manager is shared
+gltfBatch::result gltfBatch::convert (const input &in, const std::string &outdir) {
+	result ret ={ in._file, false, false, false, 0., 0. } ;
+	std::string dir =outputDirectory (in, outdir) ;
+	FbxPathUtils::Create (dir.c_str ()) ;
+
+	gltfPackage asset ;
+	asset.ioSettings (nullptr, _ioSettings._angleInDegree, _ioSettings._reverseTransparency, _ioSettings._defaultLighting, _ioSettings._copyMedia, _ioSettings._embedMedia) ;
+	asset.meshCache (_meshCache.c_str ()) ;
+	asset.importProfile (_importProfile) ;
+	asset.nodeFilter (_filter) ;
+	asset.rootConversion (_bRootConversion) ;
+	asset.weld (_weld.c_str ()) ;
+	if ( _traceFile.length () )
+		asset.traceFile (perInputFile (_traceFile, in).c_str ()) ;
+	if ( _memoryReport.length () )
+		asset.memoryReport (perInputFile (_memoryReport, in).c_str ()) ;
+	auto start =std::chrono::steady_clock::now () ;
+	bool bRet =asset.load (in._file) ;
+	auto loaded =std::chrono::steady_clock::now () ;
+	ret._loadSeconds =std::chrono::duration<double> (loaded - start).count () ;
+	if ( bRet ) {
+		bRet =asset.save (dir) ;
+		ret._saveSeconds =std::chrono::duration<double> (std::chrono::steady_clock::now () - loaded).count () ;
+	}
+	ret._bSuccess =bRet ;
+	return (ret) ;
+}
+
+void gltfBatch::summary (std::ostream &out) const {
+	double loadSeconds =0., saveSeconds =0. ;
+	size_t nbFailures =0 ;
+	size_t width =4 ;
+	for ( const result &ret : _results )
+		width =std::max (width, ret._file.length ()) ;
+	out << std::fixed << std::setprecision (3) ;
+	out << std::left << std::setw (width) << ("file") << std::right
+		<< std::setw (8) << ("status") << std::setw (10) << ("load") << std::setw (10) << ("save") << std::setw (10) << ("total") << std::endl ;
+	for ( const result &ret : _results ) {
+		out << std::left << std::setw (width) << ret._file << std::right
+			<< std::setw (8) << (ret._bSuccess ? ("ok") : ret._bCrashed ? ("crashed") : ret._bTimedOut ? ("timeout") : ("failed"))
+			<< std::setw (10) << ret._loadSeconds << std::setw (10) << ret._saveSeconds
+			<< std::setw (10) << ret._loadSeconds + ret._saveSeconds << std::endl ;
+		loadSeconds +=ret._loadSeconds ;
+		saveSeconds +=ret._saveSeconds ;
+		if ( !ret._bSuccess )
+			nbFailures++ ;
+	}
+	double total =loadSeconds + saveSeconds ;
+	out << _results.size () << (" file(s), ") << nbFailures << (" failure(s), ")
+		<< loadSeconds << ("s loading, ") << saveSeconds << ("s writing, ")
+		<< (_results.size () ? total / _results.size () : 0.) << ("s per file, ")
+		<< _wallSeconds << ("s wall") << std::endl ;
+}
+
+//-----------------------------------------------------------------------------
+/*static*/ bool gltfBatch::isDirectory (const std::string &path) {
+	struct stat st ;
+	return (stat (path.c_str (), &st) == 0 && (st.st_mode & S_IFMT) == S_IFDIR) ;
+}
+
+/*static*/ uint64_t gltfBatch::fileSize (const std::string &path) {
+	struct stat st ;
+	return (stat (path.c_str (), &st) == 0 ? (uint64_t)st.st_size : 0) ;
+}
+
+/*static*/ std::string gltfBatch::extensionOf (const std::string &path) {
+	size_t pos =path.find_last_of (("./\\")) ;
+	if ( pos == std::string::npos || path [pos] != ('.') )
+		return (std::string ()) ;
+	std::string ext =path.substr (pos) ;
+	std::transform (ext.begin (), ext.end (), ext.begin (), ::tolower) ;
+	return (ext) ;
+}
+
+// Files directly in, or below (bRecursive) a directory, sorted so runs are comparable
+/*static*/ void gltfBatch::listFiles (const std::string &dir, bool bRecursive, std::vector<std::string> &files) {
+	std::vector<std::string> entries ;
+#if defined(_WIN32) || defined(_WIN64)
+	WIN32_FIND_DATAA data ;
+	HANDLE hFind =FindFirstFileA ((dir + "\\*").c_str (), &data) ;
+	if ( hFind == INVALID_HANDLE_VALUE )
+		return ;
+	do {
+		if ( strcmp (data.cFileName, ".") && strcmp (data.cFileName, "..") )
+			entries.push_back (dir + sSeparator + data.cFileName) ;
+	} while ( FindNextFileA (hFind, &data) ) ;
+	FindClose (hFind) ;
+#else
+	DIR *pDir =opendir (dir.c_str ()) ;
+	if ( pDir == nullptr )
+		return ;
+	for ( struct dirent *pEntry =readdir (pDir) ; pEntry != nullptr ; pEntry =readdir (pDir) ) {
+		if ( strcmp (pEntry->d_name, ".") && strcmp (pEntry->d_name, "..") )
+			entries.push_back (dir + sSeparator + pEntry->d_name) ;
+	}
+	closedir (pDir) ;
+#endif
+	std::sort (entries.begin (), entries.end ()) ;
+	for ( const std::string &entry : entries ) {
+		if ( isDirectory (entry) ) {
+			if ( bRecursive )
+				listFiles (entry, bRecursive, files) ;
+		} else {
+			files.push_back (entry) ;
+		}
+	}
+}
+
+// Windows only expands wildcards in the last path component
+/*static*/ bool gltfBatch::glob (const std::string &pattern, std::vector<std::string> &files) {
+	size_t nb =files.size () ;
+#if defined(_WIN32) || defined(_WIN64)
+	std::string dir =gltfPackage::pathname (pattern) ;
+	std::vector<std::string> entries ;
+	WIN32_FIND_DATAA data ;
+	HANDLE hFind =FindFirstFileA (pattern.c_str (), &data) ;
+	if ( hFind == INVALID_HANDLE_VALUE )
+		return (false) ;
+	do {
+		if ( strcmp (data.cFileName, ".") && strcmp (data.cFileName, "..") )
+			entries.push_back (dir + data.cFileName) ;
+	} while ( FindNextFileA (hFind, &data) ) ;
+	FindClose (hFind) ;
+	std::sort (entries.begin (), entries.end ()) ;
+	files.insert (files.end (), entries.begin (), entries.end ()) ;
+#else
+	glob_t matches ;
+	if ( ::glob (pattern.c_str (), 0, nullptr, &matches) == 0 ) {
+		for ( size_t i =0 ; i < matches.gl_pathc ; i++ )
+			files.push_back (matches.gl_pathv [i]) ;
+	}
+	globfree (&matches) ;
+#endif
+	return (files.size () > nb) ;
+}
+
+/*static*/ std::string gltfBatch::outputDirectory (const input &in, const std::string &outdir) {
+	std::string dir =outdir.length () ? outdir : gltfPackage::pathname (in._file) ;
+	if ( dir.length () == 0 )
+		dir =std::string (".") + sSeparator ;
+	if ( dir [dir.length () - 1] != ('/') && dir [dir.length () - 1] != ('\\') )
+		dir +=sSeparator ;
+	if ( outdir.length () && in._subdir.length () )
+		dir +=in._subdir ;
+	return (dir) ;
+}
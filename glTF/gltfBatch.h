@@ -0,0 +1,119 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Converts many files in one process: the fbxSdkMgr singleton (FbxManager, plug-ins and IOSettings)
+// is initialized once, every file gets its own scene (gltfPackage) and writer.
+// The FBX SDK cannot convert several scenes concurrently in one process, so runParallel () forks
+// worker processes instead (POSIX only), each with its own fbxSdkMgr. The parent never initializes
+// the SDK itself.
+class gltfBatch {
+public:
+	struct input {
+		std::string _file ;
+		std::string _subdir ; // output sub-directory, to keep a directory tree layout
+		uint64_t _bytes ;
+	} ;
+	struct result {
+		std::string _file ;
+		bool _bSuccess ;
+		bool _bCrashed ; // the worker process died on this file, even when retried alone
+		bool _bTimedOut ; // the worker process was killed after the job timeout, even when retried alone
+		double _loadSeconds ;
+		double _saveSeconds ;
+	} ;
+
+protected:
+	std::vector<input> _inputs ;
+	std::vector<result> _results ;
+	double _wallSeconds ;
+	struct IOSettings {
+		bool _angleInDegree ;
+		bool _reverseTransparency ;
+		bool _defaultLighting ;
+		bool _copyMedia ;
+		bool _embedMedia ;
+	} _ioSettings ;
+	std::string _meshCache ;
+	gltfPackage::EImportProfile _importProfile ;
+	_IOglTF_NS_::gltfNodeFilter _filter ;
+	bool _bRootConversion ;
+	std::string _weld ;
+	std::string _traceFile ;
+	std::string _memoryReport ;
+	double _jobTimeout ;
+
+public:
+	gltfBatch () ;
+	virtual ~gltfBatch () ;
+
+	void ioSettings (
+		bool angleInDegree =false,
+		bool reverseTransparency =false,
+		bool defaultLighting =false,
+		bool copyMedia =false,
+		bool embedMedia =false
+	) ;
+
+	// Mesh cache folder shared by all conversions, empty to disable
+	void meshCache (const std::string &folder) { _meshCache =folder ; }
+	void importProfile (gltfPackage::EImportProfile profile) { _importProfile =profile ; }
+	void nodeFilter (const _IOglTF_NS_::gltfNodeFilter &filter) { _filter =filter ; }
+	void rootConversion (bool bRootConversion) { _bRootConversion =bRootConversion ; }
+	// Welding tolerances, empty to merge bitwise identical vertices only
+	void weld (const std::string &tolerances) { _weld =tolerances ; }
+	// Chrome trace / memory report of every conversion, the input name is inserted before the
+	// extension of fn (trace.json -> trace.<input>.json), empty to disable
+	void traceFile (const std::string &fn) { _traceFile =fn ; }
+	void memoryReport (const std::string &fn) { _memoryReport =fn ; }
+	// Seconds a worker gets for one input before it is killed, 0 for no limit (POSIX only)
+	void jobTimeout (double seconds) { _jobTimeout =seconds ; }
+
+	// A directory (searched recursively for extension files), a wildcard pattern, a list file
+	// (.txt or .lst, one path per line, # for comments) or a single file
+	bool add (const std::string &spec, const char *extension =".fbx") ;
+	const std::vector<input> &inputs () const { return (_inputs) ; }
+	const std::vector<result> &results () const { return (_results) ; }
+
+	// Empty outdir means next to every input file. Returns the number of failures.
+	size_t run (const std::string &outdir, bool bVerbose =true) ;
+	// Files are handed out one at a time to nbJobs workers, largest first. An input which kills its
+	// worker, or hangs it past the job timeout, is retried at the end in a worker of its own. With a job
+	// timeout, a single job still runs in a worker so it can be killed. Results are in the inputs order.
+	size_t runParallel (const std::string &outdir, int nbJobs, bool bVerbose =true) ;
+	result convert (const input &in, const std::string &outdir) ;
+	void summary (std::ostream &out) const ;
+
+	static bool isDirectory (const std::string &path) ;
+	static uint64_t fileSize (const std::string &path) ;
+	static std::string extensionOf (const std::string &path) ;
+	static void listFiles (const std::string &dir, bool bRecursive, std::vector<std::string> &files) ;
+	static bool glob (const std::string &pattern, std::vector<std::string> &files) ;
+	static std::string outputDirectory (const input &in, const std::string &outdir) ;
+	static std::string perInputFile (const std::string &fn, const input &in) ;
+
+} ;
@@ -0,0 +1,157 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "gltfMemory.h"
+#include <new>
+#include <cstdlib>
+#if defined(_WIN32) || defined(_WIN64)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+// Heap accounting for gltfMemory / gltfStats: replaces the global operator new / delete of the
+// application, and the FBX SDK allocation handlers so the scene memory is counted as well.
+// Block sizes are asked to the C runtime rather than stored in a header, so a block released by
+// a routine which was not hooked only makes the counters a bit off.
+
+static gltfMemoryCounters sCounters ; // zero initialized before any dynamic initialization
+
+extern "C" gltfMemoryCounters *gltfMemoryCountersHook () {
+	return (&sCounters) ;
+}
+
+static size_t blockSize (void *p) {
+#if defined(_WIN32) || defined(_WIN64)
+	return (_msize (p)) ;
+#elif defined(__APPLE__)
+	return (malloc_size (p)) ;
+#else
+	return (malloc_usable_size (p)) ;
+#endif
+}
+
+static void *track (void *p) {
+	if ( p == nullptr )
+		return (nullptr) ;
+	int64_t size =(int64_t)blockSize (p) ;
+	int64_t live =sCounters._live.fetch_add (size) + size ;
+	sCounters._allocations++ ;
+	sCounters._allocated +=(uint64_t)size ;
+	int64_t peak =sCounters._peak.load () ;
+	while ( live > peak && !sCounters._peak.compare_exchange_weak (peak, live) )
+		;
+	return (p) ;
+}
+
+static void untrack (void *p) {
+	if ( p != nullptr )
+		sCounters._live -=(int64_t)blockSize (p) ;
+}
+
+//-----------------------------------------------------------------------------
+static void *hookMalloc (size_t size) {
+	return (track (malloc (size))) ;
+}
+
+static void *hookCalloc (size_t count, size_t size) {
+	return (track (calloc (count, size))) ;
+}
+
+static void *hookRealloc (void *p, size_t size) {
+	untrack (p) ;
+	void *pNew =realloc (p, size) ;
+	if ( pNew == nullptr && size != 0 ) { // p is still valid
+		track (p) ;
+		return (nullptr) ;
+	}
+	return (track (pNew)) ;
+}
+
+static void hookFree (void *p) {
+	untrack (p) ;
+	free (p) ;
+}
+
+// Must be in place before the first FBX allocation, i.e. before fbxSdkMgr creates the FbxManager
+static struct fbxAllocationHandlers {
+	fbxAllocationHandlers () {
+		FbxSetMallocHandler (hookMalloc) ;
+		FbxSetCallocHandler (hookCalloc) ;
+		FbxSetReallocHandler (hookRealloc) ;
+		FbxSetFreeHandler (hookFree) ;
+	}
+} sFbxAllocationHandlers ;
+
+//-----------------------------------------------------------------------------
+static void *allocate (size_t size) {
+	for ( ;; ) {
+		void *p =hookMalloc (size ? size : 1) ;
+		if ( p != nullptr )
+			return (p) ;
+		std::new_handler handler =std::get_new_handler () ;
+		if ( handler == nullptr )
+			throw std::bad_alloc () ;
+		handler () ;
+	}
+}
+
+void *operator new (size_t size) {
+	return (allocate (size)) ;
+}
+
+void *operator new [] (size_t size) {
+	return (allocate (size)) ;
+}
+
+void *operator new (size_t size, const std::nothrow_t &) noexcept {
+	try {
+		return (allocate (size)) ;
+	} catch ( ... ) {
+		return (nullptr) ;
+	}
+}
+
+void *operator new [] (size_t size, const std::nothrow_t &) noexcept {
+	try {
+		return (allocate (size)) ;
+	} catch ( ... ) {
+		return (nullptr) ;
+	}
+}
+
+void operator delete (void *p) noexcept {
+	hookFree (p) ;
+}
+
+void operator delete [] (void *p) noexcept {
+	hookFree (p) ;
+}
+
+void operator delete (void *p, const std::nothrow_t &) noexcept {
+	hookFree (p) ;
+}
+
+void operator delete [] (void *p, const std::nothrow_t &) noexcept {
+	hookFree (p) ;
+}
@@ -22,6 +22,9 @@
 #include "glTF.h"
 #include "gltfPackage.h"
 #include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <unordered_set>
 
 //-----------------------------------------------------------------------------
 /*static*/ FbxAutoPtr<fbxSdkMgr> fbxSdkMgr::_singleton ;
@@ -29,15 +32,7 @@
 fbxSdkMgr::fbxSdkMgr () : _sdkManager(FbxManager::Create ()) {
 	assert( _sdkManager ) ;
 	FbxIOSettings *pIOSettings =FbxIOSettings::Create (_sdkManager, IOSROOT) ;
-	//pIOSettings->SetBoolProp (IMP_FBX_CONSTRAINT, true) ;
-	//pIOSettings->SetBoolProp (IMP_FBX_CONSTRAINT_COUNT, true) ;
-	//pIOSettings->SetBoolProp (IMP_FBX_MATERIAL, true) ;
-	//pIOSettings->SetBoolProp (IMP_FBX_TEXTURE, true) ;
-	//pIOSettings->SetBoolProp (IMP_FBX_LINK, true) ;
-	//pIOSettings->SetBoolProp (IMP_FBX_SHAPE, true) ;
-	//pIOSettings->SetBoolProp (IMP_FBX_GOBO, false) ;
-	//pIOSettings->SetBoolProp (IMP_FBX_ANIMATION, true) ;
-	//pIOSettings->SetBoolProp (IMP_FBX_GLOBAL_SETTINGS, true) ;
+	// The IMP_FBX_* options are set before every import from the package import profile
 	pIOSettings->SetBoolProp (EXP_FBX_EMBEDDED, false) ;
 	_sdkManager->SetIOSettings (pIOSettings) ;
 
@@ -70,7 +65,7 @@ FbxSharedDestroyPtr<FbxManager> &fbxSdkMgr::fbxMgr () {
 }
 
 //-----------------------------------------------------------------------------
-gltfPackage::gltfPackage () : _scene(nullptr), _ioSettings ({ ("") }) {
+gltfPackage::gltfPackage () : _scene(nullptr), _ioSettings ({ (""), (""), (""), eImportAuto }), _stats (true) {
 }
 
 gltfPackage::~gltfPackage () {
@@ -94,6 +89,96 @@ void gltfPackage::ioSettings (
 	//fbxSdkMgr::Instance ()->fbxMgr ()->SetIOSettings (pIOSettings) ;
 }
 
+void gltfPackage::statsFile (const char *fn /*=nullptr*/) {
+	FbxIOSettings *pIOSettings =fbxSdkMgr::Instance ()->fbxMgr ()->GetIOSettings () ;
+	pIOSettings->SetStringProp (IOSN_FBX_GLTF_STATSFILE, FbxString (fn == nullptr ? "" : fn)) ;
+}
+
+void gltfPackage::traceFile (const char *fn /*=nullptr*/) {
+	FbxIOSettings *pIOSettings =fbxSdkMgr::Instance ()->fbxMgr ()->GetIOSettings () ;
+	_ioSettings._traceFile =fn == nullptr ? ("") : fn ;
+	pIOSettings->SetStringProp (IOSN_FBX_GLTF_TRACEFILE, FbxString ((_ioSettings._traceFile).c_str ())) ;
+	_stats.reset (true, _ioSettings._traceFile.length () != 0) ;
+	// The reader / writer append their own events to the file, start from an empty trace
+	if ( _ioSettings._traceFile.length () )
+		std::remove ((_ioSettings._traceFile).c_str ()) ;
+}
+
+void gltfPackage::memoryReport (const char *fn /*=nullptr*/) {
+	_ioSettings._memReport =fn == nullptr ? ("") : fn ;
+	// The writer reports its own phases in the same file
+	statsFile (fn) ;
+}
+
+void gltfPackage::meshCache (const char *folder /*=nullptr*/) {
+	FbxIOSettings *pIOSettings =fbxSdkMgr::Instance ()->fbxMgr ()->GetIOSettings () ;
+	pIOSettings->SetStringProp (IOSN_FBX_GLTF_MESHCACHE, FbxString (folder == nullptr ? "" : folder)) ;
+}
+
+void gltfPackage::nodeFilter (const _IOglTF_NS_::gltfNodeFilter &filter) {
+	FbxIOSettings *pIOSettings =fbxSdkMgr::Instance ()->fbxMgr ()->GetIOSettings () ;
+	_filter =filter ;
+	pIOSettings->SetStringProp (IOSN_FBX_GLTF_NODEFILTER, FbxString (_filter.spec ().c_str ())) ;
+}
+
+void gltfPackage::weld (const char *tolerances /*=nullptr*/) {
+	FbxIOSettings *pIOSettings =fbxSdkMgr::Instance ()->fbxMgr ()->GetIOSettings () ;
+	pIOSettings->SetStringProp (IOSN_FBX_GLTF_WELD, FbxString (tolerances == nullptr ? "" : tolerances)) ;
+}
+
+void gltfPackage::rootConversion (bool bRootConversion /*=true*/) {
+	FbxIOSettings *pIOSettings =fbxSdkMgr::Instance ()->fbxMgr ()->GetIOSettings () ;
+	pIOSettings->SetBoolProp (IOSN_FBX_GLTF_ROOTCONVERSION, bRootConversion) ;
+}
+
+void gltfPackage::importProfile (EImportProfile profile /*=eImportAuto*/) {
+	_ioSettings._importProfile =profile ;
+}
+
+/*static*/ bool gltfPackage::importProfile (const std::string &name, EImportProfile &profile) {
+	if ( name == "auto" )
+		profile =eImportAuto ;
+	else if ( name == "static" )
+		profile =eImportStaticGeometry ;
+	else if ( name == "full" )
+		profile =eImportFull ;
+	else
+		return (false) ;
+	return (true) ;
+}
+
+/*static*/ const char *gltfPackage::importProfileName (EImportProfile profile) {
+	switch ( profile ) {
+		case eImportStaticGeometry: return ("static") ;
+		case eImportFull: return ("full") ;
+		default: return ("auto") ;
+	}
+}
+
+// The writer evaluates the node transforms at FBXSDK_TIME_ZERO, and without the animation curves an
+// animated node evaluates to its default properties instead of its frame 0 pose. 'auto' keeps the
+// animation and the links (skins) for that reason, and skips what the writer never reads: shapes,
+// gobos, characters and constraints. 'static' also drops the animation and links, it is the caller's
+// promise the scene is not animated.
+gltfPackage::EImportProfile gltfPackage::ApplyImportProfile (FbxIOSettings *pIOSettings) {
+	EImportProfile profile =_ioSettings._importProfile ;
+	bool bFull =profile == eImportFull ;
+	bool bAnimation =profile != eImportStaticGeometry ;
+	pIOSettings->SetBoolProp (IMP_FBX_MODEL, true) ;
+	pIOSettings->SetBoolProp (IMP_FBX_MATERIAL, true) ;
+	pIOSettings->SetBoolProp (IMP_FBX_TEXTURE, true) ;
+	pIOSettings->SetBoolProp (IMP_FBX_GLOBAL_SETTINGS, true) ;
+	pIOSettings->SetBoolProp (IMP_FBX_ANIMATION, bAnimation) ;
+	pIOSettings->SetBoolProp (IMP_FBX_LINK, bAnimation) ;
+	pIOSettings->SetBoolProp (IMP_FBX_CONSTRAINT, bFull) ;
+	pIOSettings->SetBoolProp (IMP_FBX_CONSTRAINT_COUNT, bFull) ;
+	pIOSettings->SetBoolProp (IMP_FBX_CHARACTER, bFull) ;
+	pIOSettings->SetBoolProp (IMP_FBX_CHARACTER_COUNT, bFull) ;
+	pIOSettings->SetBoolProp (IMP_FBX_SHAPE, bFull) ;
+	pIOSettings->SetBoolProp (IMP_FBX_GOBO, bFull) ;
+	return (profile) ;
+}
+
 bool gltfPackage::load (const std::string &fn) {
 	assert( !_scene ) ;
 	auto pMgr =fbxSdkMgr::Instance ()->fbxMgr () ;
@@ -112,9 +197,23 @@ bool gltfPackage::import (const std::string &fn) {
 	return (bRet) ;
 }
 
+// Imports the file as is, i.e. without the axis / unit conversions and the mesh preparation load () does
+bool gltfPackage::importOnly (const std::string &fn) {
+	assert( !_scene ) ;
+	auto pMgr =fbxSdkMgr::Instance ()->fbxMgr () ;
+	_scene.Reset (FbxScene::Create (pMgr, (gltfPackage::filename (fn)).c_str ())) ;
+	assert( !!_scene ) ;
+	bool bStatus =false ;
+	return (ImportScene (fn, bStatus) && bStatus) ;
+}
+
 bool gltfPackage::save (const std::string &outdir) {
 	assert( !!_scene ) ;
 	bool bRet =WriteScene (outdir) ;
+	if ( _stats.tracing () && !_stats.saveTrace (_ioSettings._traceFile, true) )
+		std::cout << "Warning: cannot write the trace file " << _ioSettings._traceFile << std::endl ;
+	if ( _ioSettings._memReport.length () && !SaveMemoryReport () )
+		std::cout << "Warning: cannot write the memory report " << _ioSettings._memReport << std::endl ;
 	return (bRet) ;
 }
 
@@ -143,28 +242,39 @@ bool gltfPackage::save (const std::string &outdir) {
 	return (path) ;
 }
 
-bool gltfPackage::LoadScene (const std::string &fn) {
+bool gltfPackage::ImportScene (const std::string &fn, bool &bStatus) {
 	auto pMgr =fbxSdkMgr::Instance ()->fbxMgr () ;
 	FbxAutoDestroyPtr<FbxImporter> pImporter (FbxImporter::Create (pMgr, "")) ;
 
-	if ( !pImporter->Initialize ((fn).c_str (), -1, pMgr->GetIOSettings ()) )
-		return (false) ;
-	if ( pImporter->IsFBX () ) {
-		// From this point, it is possible to access animation stack information without
-		// the expense of loading the entire file.
+	bStatus =false ;
+	{
+		_IOglTF_NS_::gltfStats::scope phase (_stats, "Import") ;
+		phase.arg ("profile", importProfileName (ApplyImportProfile (pMgr->GetIOSettings ()))) ;
+		if ( !pImporter->Initialize ((fn).c_str (), -1, pMgr->GetIOSettings ()) )
+			return (false) ;
+		if ( pImporter->IsFBX () ) {
+			// From this point, it is possible to access animation stack information without
+			// the expense of loading the entire file.
 
-		// Set the import states. By default, the import states are always set to true.
-	}
+			// Set the import states. By default, the import states are always set to true.
+		}
 
-	bool bStatus =pImporter->Import (_scene) ;
+		bStatus =pImporter->Import (_scene) ;
+	}
+	//if ( bStatus == false && pImporter->GetStatus ().GetCode () == FbxStatus::ePasswordError ) {
+	//}
 	if ( _ioSettings._name.length () )
 		_scene->SetName ((_ioSettings._name).c_str ()) ;
 	else if ( _scene->GetName () == FbxString ("") )
 		//_scene->SetName ("untitled") ;
 		_scene->SetName ((gltfPackage::filename (fn)).c_str ()) ;
+	return (true) ;
+}
 
-	//if ( bStatus == false && pImporter->GetStatus ().GetCode () == FbxStatus::ePasswordError ) {
-	//}
+bool gltfPackage::LoadScene (const std::string &fn) {
+	bool bStatus =false ;
+	if ( !ImportScene (fn, bStatus) )
+		return (false) ;
 
 	// Get current UpAxis of the FBX file.
 	// This have to be done before ConvertiAxisSystem(), cause the function will always change SceneAxisSystem to Y-up.
@@ -184,10 +294,15 @@ bool gltfPackage::LoadScene (const std::string &fn) {
 	//int lSign =0 ;
 	//FbxAxisSystem::EUpVector upVectorFromFile =sceneAxisSystem.GetUpVector (lSign) ;
 
-	FbxAxisSystem::MayaYUp.ConvertScene (_scene) ; // We want the Y up axis for glTF
+	// With rootConversion, the writer puts the axis and unit conversions on the top nodes matrix instead
+	bool bRootConversion =fbxSdkMgr::Instance ()->fbxMgr ()->GetIOSettings ()->GetBoolProp (IOSN_FBX_GLTF_ROOTCONVERSION, false) ;
+	if ( !bRootConversion ) {
+		_IOglTF_NS_::gltfStats::scope phase (_stats, "AxisConversion") ;
+		FbxAxisSystem::MayaYUp.ConvertScene (_scene) ; // We want the Y up axis for glTF
+	}
 
 	FbxSystemUnit sceneSystemUnit =_scene->GetGlobalSettings ().GetSystemUnit () ; // We want meter as default unit for gltTF
-	if ( sceneSystemUnit != FbxSystemUnit::m ) {
+	if ( !bRootConversion && sceneSystemUnit != FbxSystemUnit::m ) {
 		//const FbxSystemUnit::ConversionOptions conversionOptions ={
 		//	false, // mConvertRrsNodes
 		//	true, // mConvertAllLimits
@@ -197,12 +312,39 @@ bool gltfPackage::LoadScene (const std::string &fn) {
 		//	false  // mConvertCameraClipPlanes
 		//} ;
 		//FbxSystemUnit::m.ConvertScene (_scene, conversionOptions) ;
+		_IOglTF_NS_::gltfStats::scope phase (_stats, "UnitConversion") ;
 		FbxSystemUnit::m.ConvertScene (_scene) ;
 	}
 
 	FbxGeometryConverter converter (fbxSdkMgr::Instance ()->fbxMgr ()) ;
-	converter.Triangulate (_scene, true) ; // glTF supports triangles only
-	converter.SplitMeshesPerMaterial (_scene, true) ; // Split meshes per material, so we only have one material per mesh (VBO support)
+	std::vector<FbxMesh *> meshes ;
+	{
+		_IOglTF_NS_::gltfStats::scope phase (_stats, "Triangulate") ;
+		// glTF supports triangles only, but the writer triangulates meshes itself (in parallel, and without
+		// rebuilding their layer elements). Only NURBS and patches need to be converted to meshes here.
+		// With a node filter, only the exported nodes are converted.
+		if ( _filter.active () ) {
+			_filter.select (_scene->GetRootNode ()) ;
+			for ( FbxNode *pNode : _filter.roots () )
+				ConvertToMeshes (pNode, converter, &meshes) ;
+		} else {
+			ConvertToMeshes (_scene->GetRootNode (), converter) ;
+		}
+	}
+	{
+		_IOglTF_NS_::gltfStats::scope phase (_stats, "SplitMeshesPerMaterial") ;
+		// Split meshes per material, so we only have one material per mesh (VBO support)
+		if ( _filter.active () ) {
+			// Instanced meshes are listed once per node, but only split once
+			std::unordered_set<FbxMesh *> split ;
+			for ( FbxMesh *pMesh : meshes ) {
+				if ( split.insert (pMesh).second )
+					converter.SplitMeshPerMaterial (pMesh, true) ;
+			}
+		} else {
+			converter.SplitMeshesPerMaterial (_scene, true) ;
+		}
+	}
 	
 	// Set the current peripheral to be the NULL so FBX geometries that have been imported can be flushed
     _scene->SetPeripheral (NULL_PERIPHERAL) ;
@@ -217,6 +359,24 @@ bool gltfPackage::LoadScene (const std::string &fn) {
 	return (true) ;
 }
 
+void gltfPackage::ConvertToMeshes (FbxNode *pNode, FbxGeometryConverter &converter, std::vector<FbxMesh *> *pMeshes /*=nullptr*/) {
+	if ( _filter.active () && !_filter.kept (pNode) )
+		return ;
+	FbxNodeAttribute *pAttribute =pNode->GetNodeAttribute () ;
+	if ( pAttribute && (!_filter.active () || _filter.exported (pNode)) ) {
+		FbxNodeAttribute::EType attributeType =pAttribute->GetAttributeType () ;
+		if (   attributeType == FbxNodeAttribute::eNurbs
+			|| attributeType == FbxNodeAttribute::eNurbsSurface
+			|| attributeType == FbxNodeAttribute::ePatch
+		)
+			converter.Triangulate (pAttribute, true) ;
+		if ( pMeshes && pNode->GetMesh () )
+			pMeshes->push_back (pNode->GetMesh ()) ;
+	}
+	for ( int i =0 ; i < pNode->GetChildCount () ; i++ )
+		ConvertToMeshes (pNode->GetChild (i), converter, pMeshes) ;
+}
+
 //FbxArray<FbxNode *> RemoveBadPolygonsFromMeshes (FbxScene *pScene) {
 //	FbxArray<FbxNode *> pAffectedNodes ;
 //	FbxNode *pNode =pScene->GetRootNode () ;
@@ -251,7 +411,28 @@ bool gltfPackage::WriteScene (const std::string &outdir) {
 		return (false) ;
 
 	// The next line will call the exporter
+	_IOglTF_NS_::gltfStats::scope phase (_stats, "Export") ;
 	bRet =pExporter->Export (_scene) ;
 
 	return (bRet) ;
 }
+
+bool gltfPackage::SaveMemoryReport () {
+	Json::Value report ;
+	if ( !_IOglTF_NS_::gltfStats::load (_ioSettings._memReport, report) || !report.isObject () )
+		report =Json::Value (Json::objectValue) ;
+	const Json::Value stats =_stats.json () ;
+	for ( Json::Value::const_iterator iter =stats ["phases"].begin () ; iter != stats ["phases"].end () ; iter++ )
+		report ["phases"] [iter.memberName ()] =*iter ;
+	gltfMemoryCounters *pCounters =_IOglTF_NS_::gltfMemory::counters () ;
+	if ( pCounters ) {
+		report ["heap"] ["peakBytes"] =(Json::Int64)pCounters->_peak.load () ;
+		report ["heap"] ["liveBytes"] =(Json::Int64)pCounters->_live.load () ;
+		report ["heap"] ["allocations"] =(Json::UInt64)pCounters->_allocations.load () ;
+		report ["heap"] ["allocatedBytes"] =(Json::UInt64)pCounters->_allocated.load () ;
+	}
+	std::ofstream out (_ioSettings._memReport, std::ios::out | std::ios::trunc) ;
+	Json::StyledWriter writer ;
+	out << writer.write (report) ;
+	return (out.good ()) ;
+}
@@ -22,6 +22,9 @@
 
 #include <fbxsdk.h>
 #include <string>
+#include "ns_exports.h"
+#include "gltfStats.h"
+#include "gltfNodeFilter.h"
 //#include "webgl-idl.h"
 
 //-----------------------------------------------------------------------------
@@ -43,13 +46,31 @@ public:
 
 //-----------------------------------------------------------------------------
 class gltfPackage {
+public:
+	// What the FBX importer loads: 'auto' skips the data the writer never reads (constraints,
+	// characters, shapes and gobos), 'static geometry' also skips animation and links (skins), 'full'
+	// loads everything. Animated nodes come out of 'static geometry' with their default transforms,
+	// not their frame 0 pose.
+	enum EImportProfile {
+		eImportAuto,
+		eImportStaticGeometry,
+		eImportFull
+	} ;
+
 protected:
 	struct IOSettings {
 		std::string _name ;
+		std::string _traceFile ;
+		std::string _memReport ;
+		EImportProfile _importProfile ;
 	} _ioSettings ;
 
 protected:
 	FbxAutoDestroyPtr<FbxScene> _scene ;
+	// Wall time of the load / conversion / export steps, always collected (and traced on demand)
+	_IOglTF_NS_::gltfStats _stats ;
+	// Only the filtered nodes are converted, and exported
+	_IOglTF_NS_::gltfNodeFilter _filter ;
 
 public:
 	gltfPackage () ;
@@ -63,17 +84,48 @@ public:
 		bool copyMedia =false,
 		bool embedMedia =false
 	) ;
+	// Ask the glTF reader / writer to save their own phase timings in a JSON file (nullptr to stop)
+	void statsFile (const char *fn =nullptr) ;
+	// Record a Chrome trace (chrome://tracing) of the load / conversion / export steps and of the glTF
+	// reader / writer phases in fn (nullptr to stop)
+	void traceFile (const char *fn =nullptr) ;
+	// Save the time, peak and retained heap bytes of every phase, and the size of the main writer
+	// containers in fn (nullptr to stop). Heap figures need the gltfMemoryHook.cpp allocator hook.
+	void memoryReport (const char *fn =nullptr) ;
+	// Keep the processed mesh buffers in the folder, and reuse them for unchanged meshes on the next
+	// exports (nullptr to stop)
+	void meshCache (const char *folder =nullptr) ;
+	// Merge the vertices within 'position[,normal[,uv[,color]]]' tolerances, vs bitwise identical (nullptr)
+	void weld (const char *tolerances =nullptr) ;
+	// Leave the scene axis system and unit as they are, and convert them with the glTF top nodes matrix
+	void rootConversion (bool bRootConversion =true) ;
+	void importProfile (EImportProfile profile =eImportAuto) ;
+	// Exports only part of the scene, an empty filter exports everything
+	void nodeFilter (const _IOglTF_NS_::gltfNodeFilter &filter) ;
+	// "auto", "static" or "full"
+	static bool importProfile (const std::string &name, EImportProfile &profile) ;
+	static const char *importProfileName (EImportProfile profile) ;
 
 	bool load (const std::string &fn) ;
 	bool import (const std::string &fn) ;
+	// FBX import only, no axis / unit conversion, triangulation or split per material (gltfProbe)
+	bool importOnly (const std::string &fn) ;
 
 	bool save (const std::string &outdir) ;
 
+	const _IOglTF_NS_::gltfStats &stats () const { return (_stats) ; }
+	FbxScene *scene () const { return (_scene.Get ()) ; }
+	const _IOglTF_NS_::gltfNodeFilter &nodeFilter () const { return (_filter) ; }
+
 	static std::string filename (const std::string &path) ;
 	static std::string pathname (const std::string &filename) ;
 	
 protected:
+	bool ImportScene (const std::string &fn, bool &bStatus) ;
 	bool LoadScene (const std::string &fn) ;
 	bool WriteScene (const std::string &outdir) ;
+	bool SaveMemoryReport () ;
+	EImportProfile ApplyImportProfile (FbxIOSettings *pIOSettings) ;
+	void ConvertToMeshes (FbxNode *pNode, FbxGeometryConverter &converter, std::vector<FbxMesh *> *pMeshes =nullptr) ;
 
 } ;
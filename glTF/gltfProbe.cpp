@@ -0,0 +1,219 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "glTF.h"
+#include "gltfBatch.h"
+#include "gltfProbe.h"
+#include "gltfVertexKernel.h"
+#include <algorithm>
+#include <chrono>
+
+// Rough glTF JSON sizes of the objects the writer creates (node, mesh with its accessors and buffer
+// views, material with its technique / program / shaders, texture with its image and sampler)
+static const uint64_t sNodeJsonBytes =250 ;
+static const uint64_t sMeshJsonBytes =1500 ;
+static const uint64_t sMaterialJsonBytes =2500 ;
+static const uint64_t sTextureJsonBytes =300 ;
+
+//-----------------------------------------------------------------------------
+gltfProbe::gltfProbe () {
+	reset () ;
+}
+
+gltfProbe::~gltfProbe () {
+}
+
+void gltfProbe::reset () {
+	_meshes.clear () ;
+	_materials.clear () ;
+	_largestMesh =Json::Value (Json::nullValue) ;
+	_nodes =_maxDepth =_meshInstances =_cameras =_lights =_surfaces =0 ;
+	_controlPoints =_polygons =_polygonVertices =_triangles =0 ;
+	_vertices =_binBytes =0 ;
+}
+
+/*static*/ Json::Value gltfProbe::probe (const std::string &fn, gltfPackage::EImportProfile importProfile, const _IOglTF_NS_::gltfNodeFilter &filter) {
+	gltfPackage asset ;
+	asset.importProfile (importProfile) ;
+	asset.nodeFilter (filter) ;
+	auto start =std::chrono::steady_clock::now () ;
+	bool bRet =asset.importOnly (fn) ;
+	double importSeconds =std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count () ;
+
+	Json::Value ret (Json::objectValue) ;
+	if ( bRet && asset.scene () ) {
+		gltfProbe probe ;
+		ret =probe.scene (asset.scene (), filter) ;
+	}
+	ret [("file")] =fn ;
+	ret [("status")] =bRet ? ("ok") : ("failed") ;
+	ret [("fileBytes")] =(Json::UInt64)gltfBatch::fileSize (fn) ;
+	ret [("importSeconds")] =importSeconds ;
+	ret [("importProfile")] =gltfPackage::importProfileName (importProfile) ;
+	return (ret) ;
+}
+
+Json::Value gltfProbe::scene (FbxScene *pScene, const _IOglTF_NS_::gltfNodeFilter &filter) {
+	reset () ;
+	_filter =filter ;
+	_filter.select (pScene->GetRootNode ()) ;
+	for ( FbxNode *pNode : _filter.roots () )
+		ProbeNodeRecursive (pNode, 1) ;
+
+	// Textures are not filtered, the writer exports the textures of the exported materials only
+	// but finding them means walking every material property
+	uint64_t nbTextures =(uint64_t)pScene->GetSrcObjectCount<FbxFileTexture> () ;
+	uint64_t imageBytes =0 ;
+	for ( int i =0 ; i < pScene->GetSrcObjectCount<FbxFileTexture> () ; i++ ) {
+		FbxFileTexture *pTexture =pScene->GetSrcObject<FbxFileTexture> (i) ;
+		imageBytes +=gltfBatch::fileSize (pTexture->GetFileName ()) ;
+	}
+
+	uint64_t jsonBytes =_nodes * sNodeJsonBytes + _meshes.size () * sMeshJsonBytes
+		+ _materials.size () * sMaterialJsonBytes + nbTextures * sTextureJsonBytes ;
+	Json::Value ret (Json::objectValue) ;
+	ret [("nodes")] =(Json::UInt64)_nodes ;
+	ret [("maxDepth")] =(Json::UInt64)_maxDepth ;
+	ret [("meshes")] =(Json::UInt64)_meshes.size () ;
+	ret [("meshInstances")] =(Json::UInt64)_meshInstances ;
+	ret [("unconvertedSurfaces")] =(Json::UInt64)_surfaces ;
+	ret [("cameras")] =(Json::UInt64)_cameras ;
+	ret [("lights")] =(Json::UInt64)_lights ;
+	ret [("materials")] =(Json::UInt64)_materials.size () ;
+	ret [("textures")] =(Json::UInt64)nbTextures ;
+	ret [("controlPoints")] =(Json::UInt64)_controlPoints ;
+	ret [("polygons")] =(Json::UInt64)_polygons ;
+	ret [("polygonVertices")] =(Json::UInt64)_polygonVertices ;
+	ret [("triangles")] =(Json::UInt64)_triangles ;
+	ret [("estimatedVertices")] =(Json::UInt64)_vertices ;
+	ret [("estimatedBinBytes")] =(Json::UInt64)_binBytes ;
+	ret [("estimatedJsonBytes")] =(Json::UInt64)jsonBytes ;
+	ret [("imageBytes")] =(Json::UInt64)imageBytes ;
+	ret [("estimatedBytes")] =(Json::UInt64)(_binBytes + jsonBytes + imageBytes) ;
+	if ( !_largestMesh.isNull () )
+		ret [("largestMesh")] =_largestMesh ;
+	return (ret) ;
+}
+
+void gltfProbe::ProbeNodeRecursive (FbxNode *pNode, uint64_t depth) {
+	if ( !_filter.kept (pNode) )
+		return ;
+	_nodes++ ;
+	_maxDepth =std::max (_maxDepth, depth) ;
+	FbxNodeAttribute *pNodeAttribute =pNode->GetNodeAttribute () ;
+	if ( pNodeAttribute && _filter.exported (pNode) ) {
+		switch ( pNodeAttribute->GetAttributeType () ) {
+			case FbxNodeAttribute::eMesh:
+				_meshInstances++ ;
+				if ( _meshes.insert (pNode->GetMesh ()).second )
+					ProbeMesh (pNode) ;
+				for ( int i =0 ; i < pNode->GetMaterialCount () ; i++ )
+					_materials.insert (pNode->GetMaterial (i)) ;
+				break ;
+			// The conversion to meshes is skipped, like the triangulation
+			case FbxNodeAttribute::eNurbs:
+			case FbxNodeAttribute::eNurbsSurface:
+			case FbxNodeAttribute::ePatch:
+				_surfaces++ ;
+				break ;
+			case FbxNodeAttribute::eCamera:
+				_cameras++ ;
+				break ;
+			case FbxNodeAttribute::eLight:
+				_lights++ ;
+				break ;
+			default:
+				break ;
+		}
+	}
+	for ( int i =0 ; i < pNode->GetChildCount () ; i++ )
+		ProbeNodeRecursive (pNode->GetChild (i), depth + 1) ;
+}
+
+// Like the writer mesh cache key, the attributes come from the first node instancing the mesh
+void gltfProbe::ProbeMesh (FbxNode *pNode) {
+	FbxMesh *pMesh =pNode->GetMesh () ;
+	unsigned int attributes =_IOglTF_NS_::gltfVertexAttributesOf (pNode) ;
+	uint64_t nbTriangles =0 ;
+	for ( int i =0 ; i < pMesh->GetPolygonCount () ; i++ )
+		nbTriangles +=(uint64_t)std::max (pMesh->GetPolygonSize (i) - 2, 0) ;
+	uint64_t nbVertices =estimatedVertices (pMesh, attributes) ;
+	uint64_t indexBytes =nbVertices > 0xffff ? sizeof (unsigned int) : sizeof (unsigned short) ;
+	uint64_t binBytes =nbVertices * vertexBytes (pMesh, attributes) + nbTriangles * 3 * indexBytes ;
+
+	_controlPoints +=(uint64_t)pMesh->GetControlPointsCount () ;
+	_polygons +=(uint64_t)pMesh->GetPolygonCount () ;
+	_polygonVertices +=(uint64_t)pMesh->GetPolygonVertexCount () ;
+	_triangles +=nbTriangles ;
+	_vertices +=nbVertices ;
+	_binBytes +=binBytes ;
+	if ( _largestMesh.isNull () || binBytes > _largestMesh [("estimatedBinBytes")].asUInt64 () ) {
+		_largestMesh =Json::Value (Json::objectValue) ;
+		_largestMesh [("name")] =pMesh->GetNode () ? pMesh->GetNode ()->GetName () : pMesh->GetName () ;
+		_largestMesh [("triangles")] =(Json::UInt64)nbTriangles ;
+		_largestMesh [("estimatedVertices")] =(Json::UInt64)nbVertices ;
+		_largestMesh [("estimatedBinBytes")] =(Json::UInt64)binBytes ;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Control points are split in as many vertices as there are distinct attribute values around
+// them. Per polygon vertex (or polygon) elements in direct mode are counted as all distinct, in
+// index mode as distinct as the direct array. Combined splits are not accounted for.
+/*static*/ uint64_t gltfProbe::elementVertices (const FbxLayerElement *pElement, int directCount, uint64_t controlPoints, uint64_t polygonVertices) {
+	if ( pElement == nullptr )
+		return (controlPoints) ;
+	switch ( pElement->GetMappingMode () ) {
+		case FbxLayerElement::eByControlPoint:
+		case FbxLayerElement::eAllSame:
+		case FbxLayerElement::eNone:
+			return (controlPoints) ;
+		default:
+			if ( pElement->GetReferenceMode () == FbxLayerElement::eDirect )
+				return (polygonVertices) ;
+			return (std::max (controlPoints, (uint64_t)directCount)) ;
+	}
+}
+
+/*static*/ uint64_t gltfProbe::estimatedVertices (FbxMesh *pMesh, unsigned int attributes) {
+	uint64_t controlPoints =(uint64_t)pMesh->GetControlPointsCount () ;
+	uint64_t polygonVertices =(uint64_t)pMesh->GetPolygonVertexCount () ;
+	uint64_t nb =controlPoints ;
+	if ( (attributes & _IOglTF_NS_::eVertexNormal) && pMesh->GetElementNormalCount () ) {
+		FbxGeometryElementNormal *pElement =pMesh->GetElementNormal (0) ;
+		nb =std::max (nb, elementVertices (pElement, pElement->GetDirectArray ().GetCount (), controlPoints, polygonVertices)) ;
+	}
+	if ( (attributes & _IOglTF_NS_::eVertexUV) && pMesh->GetElementUVCount () ) {
+		FbxGeometryElementUV *pElement =pMesh->GetElementUV (0) ;
+		nb =std::max (nb, elementVertices (pElement, pElement->GetDirectArray ().GetCount (), controlPoints, polygonVertices)) ;
+	}
+	// Unreferenced control points are not exported
+	return (std::min (nb, polygonVertices)) ;
+}
+
+/*static*/ uint64_t gltfProbe::vertexBytes (FbxMesh *pMesh, unsigned int attributes) {
+	uint64_t nb =3 * sizeof (float) ;
+	if ( (attributes & _IOglTF_NS_::eVertexNormal) && pMesh->GetElementNormalCount () )
+		nb +=3 * sizeof (float) ;
+	if ( (attributes & _IOglTF_NS_::eVertexUV) && pMesh->GetElementUVCount () )
+		nb +=2 * sizeof (float) ;
+	return (nb) ;
+}
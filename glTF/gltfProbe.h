@@ -0,0 +1,68 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <string>
+#include <set>
+#include <stdint.h>
+#include "jsoncpp/json.h"
+
+//-----------------------------------------------------------------------------
+// Scene statistics without a conversion: the file is imported (using the import profile and the
+// node filter of the conversion), and the scene walked. There is no triangulation, no vertex
+// welding and nothing written, so a scheduler can size (and bin-pack) the conversion jobs upfront.
+// Unique vertices are estimated from the layer element mapping / reference modes, the output
+// sizes from the glTF writer vertex layout (float positions and normals, one float uv set for
+// nodes with materials, see gltfVertexAttributesOf (), and unsigned short indices, unsigned int
+// above 65535 vertices).
+class gltfProbe {
+protected:
+	_IOglTF_NS_::gltfNodeFilter _filter ;
+	std::set<FbxMesh *> _meshes ;
+	std::set<FbxSurfaceMaterial *> _materials ;
+	Json::Value _largestMesh ;
+	uint64_t _nodes, _maxDepth, _meshInstances, _cameras, _lights, _surfaces ;
+	uint64_t _controlPoints, _polygons, _polygonVertices, _triangles ;
+	uint64_t _vertices, _binBytes ;
+
+public:
+	gltfProbe () ;
+	virtual ~gltfProbe () ;
+
+	// Imports fn and returns its statistics, { "file": fn, "status": "failed" } if it cannot be read
+	static Json::Value probe (const std::string &fn, gltfPackage::EImportProfile importProfile, const _IOglTF_NS_::gltfNodeFilter &filter) ;
+
+	Json::Value scene (FbxScene *pScene, const _IOglTF_NS_::gltfNodeFilter &filter) ;
+
+	// Vertices the writer would output for pMesh with these gltfVertexAttributes, between the control
+	// point and polygon vertex counts
+	static uint64_t estimatedVertices (FbxMesh *pMesh, unsigned int attributes) ;
+	// Bytes per output vertex
+	static uint64_t vertexBytes (FbxMesh *pMesh, unsigned int attributes) ;
+
+protected:
+	void reset () ;
+	void ProbeNodeRecursive (FbxNode *pNode, uint64_t depth) ;
+	void ProbeMesh (FbxNode *pNode) ;
+
+	static uint64_t elementVertices (const FbxLayerElement *pElement, int directCount, uint64_t controlPoints, uint64_t polygonVertices) ;
+
+} ;
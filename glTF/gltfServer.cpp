@@ -0,0 +1,383 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#include "StdAfx.h"
+#include "glTF.h"
+#include "gltfServer.h"
+#include "gltfWeld.h"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#endif
+
+#if !defined(_WIN32) && !defined(_WIN64)
+static volatile sig_atomic_t sStop =0 ;
+
+static void onStop (int) {
+	sStop =1 ;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+gltfServer::gltfServer (const std::string &socketPath, int nbWorkers /*=1*/)
+	: _socketPath (socketPath), _nbWorkers (nbWorkers < 1 ? 1 : nbWorkers), _listen (-1)
+{
+}
+
+gltfServer::~gltfServer () {
+}
+
+int gltfServer::serve () {
+#if defined(_WIN32) || defined(_WIN64)
+	std::cout << ("--serve is not supported on Windows") << std::endl ;
+	return (-1) ;
+#else
+	struct sockaddr_un addr ;
+	memset (&addr, 0, sizeof (addr)) ;
+	addr.sun_family =AF_UNIX ;
+	if ( _socketPath.length () >= sizeof (addr.sun_path) ) {
+		std::cout << ("Socket path too long: ") << _socketPath << std::endl ;
+		return (-1) ;
+	}
+	strcpy (addr.sun_path, _socketPath.c_str ()) ;
+	// Only replace a stale socket, never a file which happens to sit at that path
+	struct stat st ;
+	if ( lstat (_socketPath.c_str (), &st) == 0 ) {
+		if ( !S_ISSOCK (st.st_mode) ) {
+			std::cout << ("Not a socket, refusing to replace ") << _socketPath << std::endl ;
+			return (-1) ;
+		}
+		unlink (_socketPath.c_str ()) ;
+	}
+	_listen =socket (AF_UNIX, SOCK_STREAM, 0) ;
+	if ( _listen < 0 || bind (_listen, (struct sockaddr *)&addr, sizeof (addr)) != 0 || listen (_listen, 64) != 0 ) {
+		std::cout << ("Cannot listen on ") << _socketPath << (": ") << strerror (errno) << std::endl ;
+		if ( _listen >= 0 )
+			close (_listen) ;
+		return (-1) ;
+	}
+
+	struct sigaction action ;
+	memset (&action, 0, sizeof (action)) ;
+	action.sa_handler =onStop ; // no SA_RESTART, so wait () returns
+	sigaction (SIGINT, &action, nullptr) ;
+	sigaction (SIGTERM, &action, nullptr) ;
+	signal (SIGPIPE, SIG_IGN) ; // clients can go away at any time
+
+	for ( int i =0 ; i < _nbWorkers ; i++ )
+		spawnWorker () ;
+	std::cout << ("Serving on ") << _socketPath << (" with ") << _workers.size () << (" worker(s)") << std::endl ;
+
+	while ( !sStop && _workers.size () ) {
+		int status =0 ;
+		pid_t pid =wait (&status) ;
+		if ( pid < 0 )
+			continue ; // EINTR
+		for ( size_t i =0 ; i < _workers.size () ; i++ ) {
+			if ( _workers [i] != pid )
+				continue ;
+			_workers.erase (_workers.begin () + i) ;
+			if ( !sStop ) {
+				std::cout << ("Worker ") << pid << (" died, respawning") << std::endl ;
+				spawnWorker () ;
+			}
+			break ;
+		}
+	}
+
+	for ( int pid : _workers )
+		kill (pid, SIGTERM) ;
+	for ( int pid : _workers )
+		waitpid (pid, nullptr, 0) ;
+	_workers.clear () ;
+	close (_listen) ;
+	unlink (_socketPath.c_str ()) ;
+	return (0) ;
+#endif
+}
+
+bool gltfServer::spawnWorker () {
+#if defined(_WIN32) || defined(_WIN64)
+	return (false) ;
+#else
+	std::cout.flush () ;
+	pid_t pid =fork () ;
+	if ( pid < 0 )
+		return (false) ;
+	if ( pid == 0 ) {
+		worker () ;
+		_exit (0) ;
+	}
+	_workers.push_back (pid) ;
+	return (true) ;
+#endif
+}
+
+void gltfServer::worker () {
+#if !defined(_WIN32) && !defined(_WIN64)
+	signal (SIGINT, SIG_IGN) ; // the parent stops the workers
+	signal (SIGTERM, SIG_DFL) ;
+	// Warm up: FbxManager, plug-ins and IOSettings are loaded once per worker
+	fbxSdkMgr::Instance () ;
+	for ( ;; ) {
+		int fd =accept (_listen, nullptr, nullptr) ;
+		if ( fd < 0 ) {
+			if ( errno == EINTR || errno == ECONNABORTED )
+				continue ;
+			break ;
+		}
+		handle (fd) ;
+		close (fd) ;
+	}
+#endif
+}
+
+void gltfServer::handle (int fd) {
+#if !defined(_WIN32) && !defined(_WIN64)
+	std::string buffer ;
+	Json::Value req ;
+	while ( receive (fd, buffer, req) ) {
+		std::string command =req.get ("command", "convert").asString () ;
+		Json::Value ret ;
+		if ( command == "ping" ) {
+			ret ["status"] ="ok" ;
+			ret ["pid"] =(int)getpid () ;
+		} else if ( command == "shutdown" ) {
+			ret ["status"] ="ok" ;
+			send (fd, ret) ;
+			kill (getppid (), SIGTERM) ;
+			return ;
+		} else if ( command == "convert" && req ["file"].isString () ) {
+			ret =convert (fd, req) ;
+		} else {
+			ret ["status"] ="error" ;
+			ret ["message"] ="invalid request" ;
+		}
+		if ( !send (fd, ret) )
+			return ;
+	}
+#endif
+}
+
+Json::Value gltfServer::convert (int fd, const Json::Value &req) {
+	Json::Value ret ;
+	std::string file =req ["file"].asString () ;
+	std::string outdir =req.get ("output", "").asString () ;
+	if ( outdir.length () == 0 )
+		outdir =gltfPackage::pathname (file) ;
+	if ( outdir.length () && outdir [outdir.length () - 1] != ('/') )
+		outdir +=('/') ;
+	FbxPathUtils::Create (outdir.c_str ()) ;
+
+	gltfPackage asset ;
+	std::string name =req.get ("name", "").asString () ;
+	asset.ioSettings (
+		name.length () ? name.c_str () : nullptr,
+		req.get ("angleInDegree", false).asBool (),
+		req.get ("invertTransparency", false).asBool (),
+		req.get ("defaultLighting", false).asBool (),
+		req.get ("copyMedia", false).asBool (),
+		req.get ("embedMedia", false).asBool ()
+	) ;
+	gltfPackage::EImportProfile importProfile =gltfPackage::eImportAuto ;
+	_IOglTF_NS_::gltfNodeFilter filter ;
+	std::string weld =req.get ("weld", "").asString () ;
+	if (   !gltfPackage::importProfile (req.get ("importProfile", "auto").asString (), importProfile)
+		|| !filter.parse (req.get ("filter", "").asString ())
+		|| (weld.length () && !_IOglTF_NS_::gltfWeldTolerances ().parse (weld))
+	) {
+		ret ["status"] ="error" ;
+		ret ["message"] ="invalid importProfile, filter or weld" ;
+		return (ret) ;
+	}
+	std::string meshCache =req.get ("meshCache", "").asString () ;
+	if ( meshCache.length () )
+		asset.meshCache (meshCache.c_str ()) ;
+	asset.importProfile (importProfile) ;
+	asset.nodeFilter (filter) ;
+	asset.rootConversion (req.get ("rootConversion", false).asBool ()) ;
+	if ( weld.length () )
+		asset.weld (weld.c_str ()) ;
+	std::string traceFile =req.get ("trace", "").asString () ;
+	if ( traceFile.length () )
+		asset.traceFile (traceFile.c_str ()) ;
+	std::string memReport =req.get ("memReport", "").asString () ;
+	if ( memReport.length () )
+		asset.memoryReport (memReport.c_str ()) ;
+
+	Json::Value progress ;
+	progress ["status"] ="loading" ;
+	send (fd, progress) ;
+	auto start =std::chrono::steady_clock::now () ;
+	bool bRet =asset.load (file) ;
+	auto loaded =std::chrono::steady_clock::now () ;
+	ret ["load"] =std::chrono::duration<double> (loaded - start).count () ;
+	if ( bRet ) {
+		progress ["status"] ="writing" ;
+		progress ["load"] =ret ["load"] ;
+		send (fd, progress) ;
+		bRet =asset.save (outdir) ;
+		ret ["save"] =std::chrono::duration<double> (std::chrono::steady_clock::now () - loaded).count () ;
+	} else {
+		ret ["message"] ="cannot load " + file ;
+	}
+	ret ["status"] =bRet ? "ok" : "failed" ;
+	return (ret) ;
+}
+
+//-----------------------------------------------------------------------------
+/*static*/ bool gltfServer::send (int fd, const Json::Value &msg) {
+#if defined(_WIN32) || defined(_WIN64)
+	return (false) ;
+#else
+	Json::FastWriter writer ; // one line, '\n' terminated
+	std::string line =writer.write (msg) ;
+	for ( const char *p =line.c_str (), *pEnd =p + line.length () ; p < pEnd ; ) {
+		ssize_t nb =write (fd, p, pEnd - p) ;
+		if ( nb < 0 && errno == EINTR )
+			continue ;
+		if ( nb <= 0 )
+			return (false) ;
+		p +=nb ;
+	}
+	return (true) ;
+#endif
+}
+
+/*static*/ bool gltfServer::receive (int fd, std::string &buffer, Json::Value &msg) {
+#if defined(_WIN32) || defined(_WIN64)
+	return (false) ;
+#else
+	for ( ;; ) {
+		size_t pos =buffer.find ('\n') ;
+		if ( pos != std::string::npos ) {
+			std::string line =buffer.substr (0, pos) ;
+			buffer.erase (0, pos + 1) ;
+			Json::Reader reader ;
+			if ( !reader.parse (line, msg, false) || !msg.isObject () )
+				msg =Json::Value (Json::objectValue) ;
+			return (true) ;
+		}
+		char chunk [4096] ;
+		ssize_t nb =read (fd, chunk, sizeof (chunk)) ;
+		if ( nb < 0 && errno == EINTR )
+			continue ;
+		if ( nb <= 0 )
+			return (false) ;
+		buffer.append (chunk, (size_t)nb) ;
+	}
+#endif
+}
+
+/*static*/ int gltfServer::request (const std::string &socketPath, const Json::Value &req, std::ostream &out) {
+#if defined(_WIN32) || defined(_WIN64)
+	out << ("--client is not supported on Windows") << std::endl ;
+	return (-1) ;
+#else
+	struct sockaddr_un addr ;
+	memset (&addr, 0, sizeof (addr)) ;
+	addr.sun_family =AF_UNIX ;
+	if ( socketPath.length () >= sizeof (addr.sun_path) )
+		return (-1) ;
+	strcpy (addr.sun_path, socketPath.c_str ()) ;
+	int fd =socket (AF_UNIX, SOCK_STREAM, 0) ;
+	if ( fd < 0 || connect (fd, (struct sockaddr *)&addr, sizeof (addr)) != 0 ) {
+		out << ("Cannot connect to ") << socketPath << (": ") << strerror (errno) << std::endl ;
+		if ( fd >= 0 )
+			close (fd) ;
+		return (-1) ;
+	}
+	signal (SIGPIPE, SIG_IGN) ;
+	int ret =-1 ;
+	std::string buffer ;
+	Json::Value msg ;
+	Json::FastWriter writer ;
+	if ( send (fd, req) ) {
+		while ( receive (fd, buffer, msg) ) {
+			out << writer.write (msg) << std::flush ;
+			std::string status =msg ["status"].asString () ;
+			if ( status == "ok" || status == "failed" || status == "error" ) {
+				ret =status == "ok" ? 0 : 1 ;
+				break ;
+			}
+		}
+	}
+	if ( ret == -1 )
+		out << ("{\"status\":\"crashed\"}") << std::endl ;
+	close (fd) ;
+	return (ret) ;
+#endif
+}
+
+/*static*/ Json::Value gltfServer::conversionRequest (
+	const std::string &file,
+	const std::string &output,
+	const std::string &name,
+	bool angleInDegree,
+	bool reverseTransparency,
+	bool defaultLighting,
+	bool copyMedia,
+	bool embedMedia,
+	const std::string &meshCache,
+	gltfPackage::EImportProfile importProfile,
+	const _IOglTF_NS_::gltfNodeFilter &filter,
+	bool bRootConversion,
+	const std::string &weld,
+	const std::string &traceFile,
+	const std::string &memReport
+) {
+	// The daemon does not run in the client working directory
+	auto absolute =[] (const std::string &path) {
+#if defined(_WIN32) || defined(_WIN64)
+		return (path) ;
+#else
+		if ( path.length () == 0 || path [0] == ('/') )
+			return (path) ;
+		char cwd [4096] ;
+		return (getcwd (cwd, sizeof (cwd)) ? std::string (cwd) + ('/') + path : path) ;
+#endif
+	} ;
+	Json::Value req ;
+	req ["command"] ="convert" ;
+	req ["file"] =absolute (file) ;
+	req ["output"] =absolute (output) ;
+	req ["name"] =name ;
+	req ["angleInDegree"] =angleInDegree ;
+	req ["invertTransparency"] =reverseTransparency ;
+	req ["defaultLighting"] =defaultLighting ;
+	req ["copyMedia"] =copyMedia ;
+	req ["embedMedia"] =embedMedia ;
+	req ["meshCache"] =absolute (meshCache) ;
+	req ["importProfile"] =gltfPackage::importProfileName (importProfile) ;
+	req ["filter"] =filter.spec () ;
+	req ["rootConversion"] =bRootConversion ;
+	req ["weld"] =weld ;
+	req ["trace"] =absolute (traceFile) ;
+	req ["memReport"] =absolute (memReport) ;
+	return (req) ;
+}
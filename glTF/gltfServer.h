@@ -0,0 +1,86 @@
+//
+// Copyright (c) Autodesk, Inc. All rights reserved 
+//
+// C++ glTF FBX converter
+// by Cyrille Fauvel - Autodesk Developer Network (ADN)
+// January 2015
+//
+// Permission to use, copy, modify, and distribute this software in
+// object code form for any purpose and without fee is hereby granted, 
+// provided that the above copyright notice appears in all copies and 
+// that both that copyright notice and the limited warranty and
+// restricted rights notice below appear in all supporting 
+// documentation.
+//
+// AUTODESK PROVIDES THIS PROGRAM "AS IS" AND WITH ALL FAULTS. 
+// AUTODESK SPECIFICALLY DISCLAIMS ANY IMPLIED WARRANTY OF
+// MERCHANTABILITY OR FITNESS FOR A PARTICULAR USE.  AUTODESK, INC. 
+// DOES NOT WARRANT THAT THE OPERATION OF THE PROGRAM WILL BE
+// UNINTERRUPTED OR ERROR FREE.
+//
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include "jsoncpp/json.h"
+
+//-----------------------------------------------------------------------------
+// Conversion daemon on a local UNIX socket (POSIX only). Pre-forked worker processes initialize
+// their fbxSdkMgr once and then accept connections on the shared listening socket, so a request
+// only pays for the conversion itself. The parent process respawns dead workers.
+//
+// Protocol: one JSON object per line.
+// request  : { "file": "<absolute path>", "output": "<absolute directory>", "name": "", "angleInDegree": false,
+//              "invertTransparency": false, "defaultLighting": false, "copyMedia": false, "embedMedia": false,
+//              "meshCache": "", "importProfile": "auto", "filter": "<gltfNodeFilter::spec ()>", "rootConversion": false,
+//              "weld": "", "trace": "", "memReport": "" }
+//            or { "command": "ping" | "shutdown" }
+// responses: { "status": "loading" }, { "status": "writing", "load": s },
+//            then { "status": "ok" | "failed" | "error", "load": s, "save": s [, "message": "..."] }
+// A connection can carry several requests, one after the other.
+class gltfServer {
+protected:
+	std::string _socketPath ;
+	int _nbWorkers ;
+	int _listen ;
+	std::vector<int> _workers ; // pids
+
+public:
+	gltfServer (const std::string &socketPath, int nbWorkers =1) ;
+	virtual ~gltfServer () ;
+
+	// Runs until SIGINT / SIGTERM or a shutdown request, returns the process exit code
+	int serve () ;
+
+	// Client side: sends one request, prints every response line to out. Returns 0 on success,
+	// 1 on failure and -1 if the daemon cannot be reached or died on the request.
+	static int request (const std::string &socketPath, const Json::Value &req, std::ostream &out) ;
+	static Json::Value conversionRequest (
+		const std::string &file,
+		const std::string &output,
+		const std::string &name,
+		bool angleInDegree,
+		bool reverseTransparency,
+		bool defaultLighting,
+		bool copyMedia,
+		bool embedMedia,
+		const std::string &meshCache,
+		gltfPackage::EImportProfile importProfile,
+		const _IOglTF_NS_::gltfNodeFilter &filter,
+		bool bRootConversion,
+		const std::string &weld,
+		const std::string &traceFile,
+		const std::string &memReport
+	) ;
+
+protected:
+	bool spawnWorker () ;
+	void worker () ;
+	void handle (int fd) ;
+	Json::Value convert (int fd, const Json::Value &req) ;
+
+	static bool send (int fd, const Json::Value &msg) ;
+	static bool receive (int fd, std::string &buffer, Json::Value &msg) ;
+
+} ;